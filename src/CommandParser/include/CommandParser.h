@@ -8,6 +8,46 @@
 #include <iostream>
 #include <algorithm>
 
+// Pruning options shared by tree-walking commands
+struct WalkArgs {
+    std::vector<std::string> excludes; // --exclude, gitignore syntax, repeatable
+    bool gitignore = false;            // --gitignore
+    bool oneFileSystem = false;        // -x, --one-file-system
+};
+
+// Raw arguments of the search command
+struct SearchArgs {
+    std::string keyword; // case-insensitive substring
+    std::string glob;    // -g
+    std::string regex;   // -r
+    std::string type;    // --type f|d|l
+    std::string minSize; // --min-size, e.g. 100M
+    std::string maxSize; // --max-size
+    std::string olderThan; // --older-than, e.g. 30d
+    std::string newerThan; // --newer-than
+    std::string output;    // --output table|jsonl|nul|tsv
+    WalkArgs walk;
+};
+
+// Raw arguments of the view command
+struct ViewArgs {
+    std::string path;    // empty: next page of the previous view
+    size_t lines = 0;    // -n, lines per page (0 = default)
+    uintmax_t line = 0;  // --line, start at this line (1-based, 0 = not given)
+    std::string offset;  // --offset, start at this byte offset, e.g. 10G
+    double percent = -1; // --percent, start at this position of the file (0-100)
+};
+
+// Raw arguments of the throttle command; empty strings leave a limit unchanged
+struct ThrottleArgs {
+    std::string rate;     // --rate, bytes per second, e.g. 20M (0 = unlimited)
+    std::string iops;     // --iops, operations per second
+    std::string inFlight; // --inflight, concurrent operations
+    bool idle = false;    // --idle, idle-class I/O priority
+    bool normal = false;  // --normal, back to best-effort priority
+    bool off = false;     // --off, remove all limits
+};
+
 class CommandParser {
 public:
     // Hooks for commands
@@ -16,7 +56,7 @@ public:
     std::function<void(const std::string &targetDirectory)> onChangeDirectory;
     
     // ls
-    std::function<void(bool sortSize, bool sortTime)> onListFiles;
+    std::function<void(bool sortSize, bool sortTime, const std::string &output, const std::string &columns)> onListFiles;
     
     // cp
     std::function<void(const std::string &sourcePath, const std::string &targetPath)> onCopy;
@@ -36,14 +76,70 @@ public:
     // rmdir
     std::function<void(const std::string &path)> onRemoveDirectory;
 
+    // rename
+    std::function<void(const std::string &pattern, const std::string &replacement, const std::string &dir,
+                       bool regex, bool dryRun)> onRename;
+
+    // undo / trash list / trash restore / trash empty
+    std::function<void()> onUndo;
+    std::function<void()> onTrashList;
+    std::function<void(const std::string &item)> onTrashRestore;
+    std::function<void()> onTrashEmpty;
+
     // stat
-    std::function<void(const std::string &path)> onStat;
+    std::function<void(const std::string &path, const std::string &output)> onStat;
 
     // search
-    std::function<void(const std::string &keyword)> onSearch;
+    std::function<void(const SearchArgs &args)> onSearch;
 
     // du
-    std::function<void(const std::string &path)> onDiskUsage;
+    std::function<void(const std::string &path, bool tree, bool rescan, const WalkArgs &walk)> onDiskUsage;
+
+    // dupes
+    std::function<void(const std::string &path)> onDuplicates;
+
+    // analyze
+    std::function<void(const std::string &path, const WalkArgs &walk)> onAnalyze;
+
+    // top
+    std::function<void(const std::string &path, size_t count, const std::string &by,
+                       const std::string &output, const WalkArgs &walk)> onTop;
+
+    // grep
+    std::function<void(const std::string &pattern, const std::string &path)> onGrep;
+
+    // wc
+    std::function<void(const std::string &path)> onWordCount;
+
+    // cmp
+    std::function<void(const std::string &first, const std::string &second)> onCompare;
+
+    // head / tail / view
+    std::function<void(const std::string &path, size_t lines)> onHead;
+    std::function<void(const std::string &path, size_t lines, bool follow)> onTail;
+    std::function<void(const ViewArgs &args)> onView;
+
+    // cache status / cache warm / cache drop
+    std::function<void(const std::string &path, const WalkArgs &walk)> onCacheStatus;
+    std::function<void(const std::string &path, bool drop, const WalkArgs &walk)> onCacheAdvise;
+
+    // snapshot save / snapshot diff
+    std::function<void(const std::string &file, const std::string &path)> onSnapshotSave;
+    std::function<void(const std::string &before, const std::string &after)> onSnapshotDiff;
+
+    // sync
+    std::function<void(const std::string &sourcePath, const std::string &targetPath,
+                       bool checksum, bool deleteExtras, bool dryRun)> onSync;
+
+    // pack / unpack
+    std::function<void(const std::string &dirPath, const std::string &archivePath)> onPack;
+    std::function<void(const std::string &archivePath, const std::string &dirPath)> onUnpack;
+
+    // throttle
+    std::function<void(const ThrottleArgs &args)> onThrottle;
+
+    // memstats
+    std::function<void()> onMemStats;
 
     // exit
     std::function<void()> onExit;
@@ -53,6 +149,11 @@ public:
         setupCLI();
     }
 
+    // Redirect help and error messages (default: std::cout)
+    void setOutput(std::ostream& stream) {
+        output = &stream;
+    }
+
     // Process single line command
     void process(const std::string& inputLine) {
         if (inputLine.empty()) return;
@@ -60,8 +161,24 @@ public:
         // Reset temporary variables before parsing
         temp_path_src.clear();
         temp_path_dst.clear();
+        temp_pattern.clear();
+        temp_output.clear();
+        temp_columns.clear();
+        temp_by = "size";
+        temp_search = SearchArgs();
+        temp_walk = WalkArgs();
+        temp_view = ViewArgs();
+        temp_throttle = ThrottleArgs();
+        temp_lines = 10;
         temp_flag_size = false;
         temp_flag_time = false;
+        temp_flag_tree = false;
+        temp_flag_rescan = false;
+        temp_flag_checksum = false;
+        temp_flag_delete = false;
+        temp_flag_dry_run = false;
+        temp_flag_follow = false;
+        temp_flag_regex = false;
 
         std::vector<std::string> args = CLI::detail::split_up(inputLine);
         
@@ -72,9 +189,9 @@ public:
         try {
             app.parse(args);
         } catch (const CLI::CallForHelp& e) {
-            std::cout << app.help() << std::endl;
+            *output << app.help() << std::endl;
         } catch (const CLI::ParseError& e) {
-            app.exit(e);
+            app.exit(e, *output, *output);
         }
         
         app.clear();
@@ -82,11 +199,41 @@ public:
 
 private:
     CLI::App app;
+    std::ostream* output = &std::cout;
 
     std::string temp_path_src;
     std::string temp_path_dst;
+    std::string temp_pattern;
+    std::string temp_output;
+    std::string temp_columns;
+    std::string temp_by = "size";
+    SearchArgs temp_search;
+    WalkArgs temp_walk;
+    ViewArgs temp_view;
+    ThrottleArgs temp_throttle;
+    size_t temp_lines = 10;
     bool temp_flag_size = false;
     bool temp_flag_time = false;
+    bool temp_flag_tree = false;
+    bool temp_flag_rescan = false;
+    bool temp_flag_checksum = false;
+    bool temp_flag_delete = false;
+    bool temp_flag_dry_run = false;
+    bool temp_flag_follow = false;
+    bool temp_flag_regex = false;
+
+    // --output for commands that can emit machine-readable records
+    static void addOutputOption(CLI::App* cmd, std::string& target) {
+        cmd->add_option("-o,--output", target, "Output format: table (default), jsonl, nul, tsv")
+           ->check(CLI::IsMember({"table", "jsonl", "nul", "tsv"}));
+    }
+
+    // --exclude / --gitignore / --one-file-system for commands that walk a tree
+    static void addWalkOptions(CLI::App* cmd, WalkArgs& target) {
+        cmd->add_option("--exclude", target.excludes, "Skip entries matching a gitignore-style pattern (repeatable)");
+        cmd->add_flag("--gitignore", target.gitignore, "Honor .gitignore files and skip .git");
+        cmd->add_flag("-x,--one-file-system", target.oneFileSystem, "Do not descend into other file systems");
+    }
 
     void setupCLI() {
         app.failure_message(CLI::FailureMessage::help);
@@ -102,8 +249,12 @@ private:
         auto cmd_ls = app.add_subcommand("ls", "List files");
         cmd_ls->add_flag("-s", temp_flag_size, "Sort by size");
         cmd_ls->add_flag("-t", temp_flag_time, "Sort by time");
+        addOutputOption(cmd_ls, temp_output);
+        cmd_ls->add_option("-c,--columns", temp_columns,
+                           "Comma-separated columns: name, type, size, mtime, owner, group, mode, inode, blocks "
+                           "(default: name,type,size,mtime)");
         cmd_ls->callback([this]() {
-            if (onListFiles) onListFiles(temp_flag_size, temp_flag_time);
+            if (onListFiles) onListFiles(temp_flag_size, temp_flag_time, temp_output, temp_columns);
         });
 
         // cp
@@ -137,8 +288,8 @@ private:
         });
 
         // rm
-        auto cmd_rm = app.add_subcommand("rm", "Remove file");
-        cmd_rm->add_option("path", temp_path_src, "File path")->required();
+        auto cmd_rm = app.add_subcommand("rm", "Move a file or directory to the trash");
+        cmd_rm->add_option("path", temp_path_src, "Path")->required();
         cmd_rm->callback([this]() {
             if (onRemove) onRemove(temp_path_src);
         });
@@ -150,34 +301,257 @@ private:
             if (onRemoveDirectory) onRemoveDirectory(temp_path_src);
         });
 
+        // rename
+        auto cmd_rename = app.add_subcommand("rename", "Rename many entries of a directory by pattern");
+        cmd_rename->add_option("pattern", temp_pattern, "Glob whose * ? [..] become #1 #2 ..., e.g. 'IMG_*.jpg'")->required();
+        cmd_rename->add_option("replacement", temp_path_dst, "New name using #N, e.g. 'photo-#1.jpg'")->required();
+        cmd_rename->add_option("dir", temp_path_src, "Directory (default: current)");
+        cmd_rename->add_flag("-r,--regex", temp_flag_regex, "Pattern is a regular expression matching the whole name");
+        cmd_rename->add_flag("-n,--dry-run", temp_flag_dry_run, "Only show what would be renamed");
+        cmd_rename->callback([this]() {
+            if (onRename) onRename(temp_pattern, temp_path_dst, temp_path_src, temp_flag_regex, temp_flag_dry_run);
+        });
+
+        // undo
+        auto cmd_undo = app.add_subcommand("undo", "Restore the last item removed with rm");
+        cmd_undo->callback([this]() {
+            if (onUndo) onUndo();
+        });
+
+        // trash
+        auto cmd_trash = app.add_subcommand("trash", "List, restore or empty the trash");
+        cmd_trash->require_subcommand(1);
+        auto cmd_trash_list = cmd_trash->add_subcommand("list", "List items in the trash");
+        cmd_trash_list->callback([this]() {
+            if (onTrashList) onTrashList();
+        });
+        auto cmd_trash_restore = cmd_trash->add_subcommand("restore", "Restore an item to its original path");
+        cmd_trash_restore->add_option("item", temp_path_src, "Trash id or original path (default: last removed)");
+        cmd_trash_restore->callback([this]() {
+            if (onTrashRestore) onTrashRestore(temp_path_src);
+        });
+        auto cmd_trash_empty = cmd_trash->add_subcommand("empty", "Permanently delete everything in the trash");
+        cmd_trash_empty->callback([this]() {
+            if (onTrashEmpty) onTrashEmpty();
+        });
+
         // stat
         auto cmd_stat = app.add_subcommand("stat", "Show file status");
         cmd_stat->add_option("path", temp_path_src, "Path");
+        addOutputOption(cmd_stat, temp_output);
         cmd_stat->callback([this]() {
             if (temp_path_src.empty()) {
-                fmt::print(fg(fmt::color::red), "Missing target: Please enter 'stat [name]'\n");
+                *output << fmt::format(fg(fmt::color::red), "Missing target: Please enter 'stat [name]'\n");
                 return;
             }
-            if (onStat) onStat(temp_path_src);
+            if (onStat) onStat(temp_path_src, temp_output);
         });
 
         // search
         auto cmd_search = app.add_subcommand("search", "Search files");
-        cmd_search->add_option("keyword", temp_path_src, "Keyword")->required();
+        cmd_search->add_option("keyword", temp_search.keyword, "Keyword");
+        cmd_search->add_option("-g,--glob", temp_search.glob, "Glob pattern, e.g. '*.log'");
+        cmd_search->add_option("-r,--regex", temp_search.regex, "Regular expression, e.g. 'core\\.[0-9]+'");
+        cmd_search->add_option("--type", temp_search.type, "Entry type: f (file), d (dir), l (symlink)")
+                  ->check(CLI::IsMember({"f", "d", "l"}));
+        cmd_search->add_option("--min-size", temp_search.minSize, "Minimum size, e.g. 100M");
+        cmd_search->add_option("--max-size", temp_search.maxSize, "Maximum size, e.g. 1G");
+        cmd_search->add_option("--older-than", temp_search.olderThan, "Modified before age, e.g. 30d");
+        cmd_search->add_option("--newer-than", temp_search.newerThan, "Modified within age, e.g. 12h");
+        addOutputOption(cmd_search, temp_search.output);
+        addWalkOptions(cmd_search, temp_search.walk);
         cmd_search->callback([this]() {
-            if (onSearch) onSearch(temp_path_src);
+            int given = !temp_search.keyword.empty() + !temp_search.glob.empty() + !temp_search.regex.empty();
+            bool filtered = !temp_search.type.empty() || !temp_search.minSize.empty() || !temp_search.maxSize.empty() ||
+                            !temp_search.olderThan.empty() || !temp_search.newerThan.empty();
+            if (given > 1 || (given == 0 && !filtered)) {
+                *output << fmt::format(fg(fmt::color::red), "Please enter exactly one of 'search [keyword]', 'search -g <glob>' or 'search -r <regex>'\n");
+                return;
+            }
+            if (onSearch) onSearch(temp_search);
         });
 
         // du
         auto cmd_du = app.add_subcommand("du", "Disk usage");
-        cmd_du->add_option("path", temp_path_src, "Path")->required();
+        cmd_du->add_option("path", temp_path_src, "Path (default: current)");
+        cmd_du->add_flag("--tree", temp_flag_tree, "Build and browse an in-memory usage tree");
+        cmd_du->add_flag("--rescan", temp_flag_rescan, "Rebuild the usage tree");
+        addWalkOptions(cmd_du, temp_walk);
         cmd_du->callback([this]() {
-            if (onDiskUsage) onDiskUsage(temp_path_src);
+            if (onDiskUsage) onDiskUsage(temp_path_src, temp_flag_tree || temp_flag_rescan, temp_flag_rescan, temp_walk);
+        });
+
+        // dupes
+        auto cmd_dupes = app.add_subcommand("dupes", "Find duplicate files");
+        cmd_dupes->add_option("dir", temp_path_src, "Directory (default: current)");
+        cmd_dupes->callback([this]() {
+            if (onDuplicates) onDuplicates(temp_path_src);
+        });
+
+        // analyze
+        auto cmd_analyze = app.add_subcommand("analyze", "Break down a directory tree by extension, size and age");
+        cmd_analyze->add_option("dir", temp_path_src, "Directory (default: current)");
+        addWalkOptions(cmd_analyze, temp_walk);
+        cmd_analyze->callback([this]() {
+            if (onAnalyze) onAnalyze(temp_path_src, temp_walk);
+        });
+
+        // top
+        auto cmd_top = app.add_subcommand("top", "Largest or oldest files anywhere under a directory");
+        cmd_top->add_option("dir", temp_path_src, "Directory (default: current)");
+        cmd_top->add_option("-n,--count", temp_lines, "Number of files (default: 10)");
+        cmd_top->add_option("--by", temp_by, "Rank by size (largest first) or mtime (oldest first)")
+               ->check(CLI::IsMember({"size", "mtime"}));
+        addOutputOption(cmd_top, temp_output);
+        addWalkOptions(cmd_top, temp_walk);
+        cmd_top->callback([this]() {
+            if (onTop) onTop(temp_path_src, temp_lines, temp_by, temp_output, temp_walk);
+        });
+
+        // grep
+        auto cmd_grep = app.add_subcommand("grep", "Search file contents");
+        cmd_grep->add_option("pattern", temp_pattern, "Text to find")->required();
+        cmd_grep->add_option("path", temp_path_src, "Directory or file (default: current)");
+        cmd_grep->callback([this]() {
+            if (onGrep) onGrep(temp_pattern, temp_path_src);
+        });
+
+        // wc
+        auto cmd_wc = app.add_subcommand("wc", "Count lines, words and bytes");
+        cmd_wc->add_option("path", temp_path_src, "File or directory (default: current)");
+        cmd_wc->callback([this]() {
+            if (onWordCount) onWordCount(temp_path_src);
+        });
+
+        // cmp
+        auto cmd_cmp = app.add_subcommand("cmp", "Compare two files or directory trees");
+        cmd_cmp->add_option("first", temp_path_src, "First file or directory")->required();
+        cmd_cmp->add_option("second", temp_path_dst, "Second file or directory")->required();
+        cmd_cmp->callback([this]() {
+            if (onCompare) onCompare(temp_path_src, temp_path_dst);
+        });
+
+        // head
+        auto cmd_head = app.add_subcommand("head", "Show the first lines of a file");
+        cmd_head->add_option("path", temp_path_src, "File")->required();
+        cmd_head->add_option("-n,--lines", temp_lines, "Number of lines (default: 10)");
+        cmd_head->callback([this]() {
+            if (onHead) onHead(temp_path_src, temp_lines);
+        });
+
+        // tail
+        auto cmd_tail = app.add_subcommand("tail", "Show the last lines of a file");
+        cmd_tail->add_option("path", temp_path_src, "File")->required();
+        cmd_tail->add_option("-n,--lines", temp_lines, "Number of lines (default: 10)");
+        cmd_tail->add_flag("-f,--follow", temp_flag_follow, "Keep printing appended data until Ctrl-C");
+        cmd_tail->callback([this]() {
+            if (onTail) onTail(temp_path_src, temp_lines, temp_flag_follow);
+        });
+
+        // view
+        auto cmd_view = app.add_subcommand("view", "Page through a file; without a file, show the next page");
+        cmd_view->add_option("path", temp_view.path, "File");
+        cmd_view->add_option("-n,--lines", temp_view.lines, "Lines per page (default: 40)");
+        auto opt_line = cmd_view->add_option("--line", temp_view.line, "Start at this line (scans from the start)");
+        auto opt_offset = cmd_view->add_option("--offset", temp_view.offset, "Start at this byte offset, e.g. 10G");
+        auto opt_percent = cmd_view->add_option("--percent", temp_view.percent, "Start at this position, 0-100")
+                                   ->check(CLI::Range(0.0, 100.0));
+        opt_line->excludes(opt_offset)->excludes(opt_percent);
+        opt_offset->excludes(opt_percent);
+        cmd_view->callback([this]() {
+            if (onView) onView(temp_view);
+        });
+
+        // snapshot
+        auto cmd_snapshot = app.add_subcommand("snapshot", "Save or compare tree snapshots");
+        cmd_snapshot->require_subcommand(1);
+        auto cmd_snapshot_save = cmd_snapshot->add_subcommand("save", "Save a snapshot of a directory tree");
+        cmd_snapshot_save->add_option("file", temp_path_dst, "Snapshot file")->required();
+        cmd_snapshot_save->add_option("dir", temp_path_src, "Directory (default: current)");
+        cmd_snapshot_save->callback([this]() {
+            if (onSnapshotSave) onSnapshotSave(temp_path_dst, temp_path_src);
+        });
+        auto cmd_snapshot_diff = cmd_snapshot->add_subcommand("diff", "Compare two snapshots");
+        cmd_snapshot_diff->add_option("before", temp_path_src, "Older snapshot")->required();
+        cmd_snapshot_diff->add_option("after", temp_path_dst, "Newer snapshot")->required();
+        cmd_snapshot_diff->callback([this]() {
+            if (onSnapshotDiff) onSnapshotDiff(temp_path_src, temp_path_dst);
+        });
+
+        // cache
+        auto cmd_cache = app.add_subcommand("cache", "Inspect, warm or drop the page cache of a file or tree");
+        cmd_cache->require_subcommand(1);
+        auto cmd_cache_status = cmd_cache->add_subcommand("status", "Show how much of each file is in the page cache");
+        cmd_cache_status->add_option("path", temp_path_src, "File or directory (default: current)");
+        addWalkOptions(cmd_cache_status, temp_walk);
+        cmd_cache_status->callback([this]() {
+            if (onCacheStatus) onCacheStatus(temp_path_src, temp_walk);
+        });
+        auto cmd_cache_warm = cmd_cache->add_subcommand("warm", "Read files into the page cache");
+        cmd_cache_warm->add_option("path", temp_path_src, "File or directory (default: current)");
+        addWalkOptions(cmd_cache_warm, temp_walk);
+        cmd_cache_warm->callback([this]() {
+            if (onCacheAdvise) onCacheAdvise(temp_path_src, false, temp_walk);
+        });
+        auto cmd_cache_drop = cmd_cache->add_subcommand("drop", "Evict clean pages of files from the page cache");
+        cmd_cache_drop->add_option("path", temp_path_src, "File or directory (default: current)");
+        addWalkOptions(cmd_cache_drop, temp_walk);
+        cmd_cache_drop->callback([this]() {
+            if (onCacheAdvise) onCacheAdvise(temp_path_src, true, temp_walk);
+        });
+
+        // sync
+        auto cmd_sync = app.add_subcommand("sync", "Incrementally copy a directory tree");
+        cmd_sync->add_option("src", temp_path_src, "Source directory")->required();
+        cmd_sync->add_option("dst", temp_path_dst, "Target directory")->required();
+        cmd_sync->add_flag("--checksum", temp_flag_checksum, "Compare contents when size and mtime match");
+        cmd_sync->add_flag("--delete", temp_flag_delete, "Delete entries missing from the source");
+        cmd_sync->add_flag("-n,--dry-run", temp_flag_dry_run, "Only show what would be done");
+        cmd_sync->callback([this]() {
+            if (onSync) onSync(temp_path_src, temp_path_dst, temp_flag_checksum, temp_flag_delete, temp_flag_dry_run);
+        });
+
+        // throttle
+        auto cmd_throttle = app.add_subcommand("throttle", "Show or limit the I/O of walks and copies (applies immediately)");
+        cmd_throttle->add_option("--rate", temp_throttle.rate, "Bytes per second, e.g. 20M (0 = unlimited)");
+        cmd_throttle->add_option("--iops", temp_throttle.iops, "I/O operations per second (0 = unlimited)");
+        cmd_throttle->add_option("--inflight", temp_throttle.inFlight, "Concurrent I/O operations (0 = unlimited)");
+        cmd_throttle->add_flag("--idle", temp_throttle.idle, "Use idle-class I/O priority");
+        cmd_throttle->add_flag("--normal", temp_throttle.normal, "Use normal I/O priority");
+        cmd_throttle->add_flag("--off", temp_throttle.off, "Remove all limits");
+        cmd_throttle->callback([this]() {
+            if (temp_throttle.idle && temp_throttle.normal) {
+                *output << fmt::format(fg(fmt::color::red), "Please use only one of '--idle' and '--normal'\n");
+                return;
+            }
+            if (onThrottle) onThrottle(temp_throttle);
+        });
+
+        // memstats
+        auto cmd_memstats = app.add_subcommand("memstats", "Show heap allocations of recent commands");
+        cmd_memstats->callback([this]() {
+            if (onMemStats) onMemStats();
+        });
+
+        // pack
+        auto cmd_pack = app.add_subcommand("pack", "Pack a directory into a tar archive");
+        cmd_pack->add_option("dir", temp_path_src, "Directory to pack")->required();
+        cmd_pack->add_option("archive", temp_path_dst, "Output tar file")->required();
+        cmd_pack->callback([this]() {
+            if (onPack) onPack(temp_path_src, temp_path_dst);
+        });
+
+        // unpack
+        auto cmd_unpack = app.add_subcommand("unpack", "Extract a tar archive");
+        cmd_unpack->add_option("archive", temp_path_src, "Tar file")->required();
+        cmd_unpack->add_option("dir", temp_path_dst, "Target directory (default: current)");
+        cmd_unpack->callback([this]() {
+            if (onUnpack) onUnpack(temp_path_src, temp_path_dst);
         });
 
         // help
         app.add_subcommand("help", "Show help")->callback([this](){
-            std::cout << app.help() << std::endl;
+            *output << app.help() << std::endl;
         });
 
         // exit
@@ -1,19 +1,50 @@
 #pragma once
+#include <chrono>
+#include <cstdio>
+#include <deque>
 #include <functional>
+#include <sstream>
 #include "FileManager.h"
 #include "CommandParser.h"
+#include "AllocTracker.h"
 
 class Controller {
 public:
     std::shared_ptr<FileManager> fileManager;
     std::shared_ptr<CommandParser> commandParser;
 
+    // 命令输出的目标，交互模式为 stdout，服务模式为会话的连接
+    std::FILE* out = stdout;
+
 public:
     Controller(const std::string& initPath = "");
+    // 服务模式的会话：使用给定的 FileManager，输出写入 output
+    Controller(std::shared_ptr<FileManager> sessionFileManager, std::FILE* output);
     ~Controller();
 
     void setupBindings();
     std::string fileTimeToString(const std::filesystem::file_time_type& ftime);
     std::string formatSize(uintmax_t bytes);
+    bool parseSize(const std::string& text, uintmax_t& outBytes);
+    bool parseAge(const std::string& text, std::chrono::seconds& outAge);
     void parse(const std::string& inputLine);
+
+private:
+    std::ostringstream parserOutput;
+
+    // 上一次 view 的文件和下一页的起始位置，不带参数的 view 从这里继续
+    Path viewPath;
+    uintmax_t viewOffset = 0;
+
+    // 最近命令的堆分配统计 (memstats)，只在以 MFE_ALLOC_TRACKING 构建时记录
+    struct CommandAllocStats {
+        std::string command;
+        AllocSnapshot allocated; // 命令期间的分配量 (两次快照之差)
+        int64_t peak = 0;        // 命令期间存活字节数的峰值，相对命令开始时
+        int64_t retained = 0;    // 命令结束时仍存活的字节数，相对命令开始时
+    };
+    std::deque<CommandAllocStats> allocHistory;
+    static constexpr size_t kAllocHistorySize = 20;
+
+    void recordAllocStats(const std::string& inputLine, const AllocSnapshot& before);
 };
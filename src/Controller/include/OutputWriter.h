@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// ls / search / stat 的输出格式 (--output)
+enum class OutputFormat {
+    Table,      // 默认：给人看的表格
+    JsonLines,  // 每条记录一个 JSON 对象，一行一个
+    Nul,        // 每条记录只输出首个字段 (名称或路径)，以 '\0' 结尾，可直接交给 xargs -0
+    Tsv         // 制表符分隔，首行为列名，值中的 \t \n \\ 转义
+};
+
+// 将 --output 的取值转换为 OutputFormat，无法识别时返回 false
+bool parseOutputFormat(std::string_view text, OutputFormat& outFormat);
+
+// 面向机器读取的记录输出
+// 字段直接序列化进一块大缓冲区，满了才整块写出，不为每个值构造字符串
+// 用法：beginRecord() -> field(...) * N -> endRecord()，析构或 flush() 时写出剩余数据
+class OutputWriter {
+public:
+    // [In] out: 输出目标
+    // [In] format: 输出格式，不能是 Table
+    OutputWriter(std::FILE* out, OutputFormat format);
+    ~OutputWriter();
+
+    OutputWriter(const OutputWriter&) = delete;
+    OutputWriter& operator=(const OutputWriter&) = delete;
+
+    // TSV 的列名行，其他格式忽略
+    void header(std::initializer_list<std::string_view> names);
+    void header(const std::vector<std::string_view>& names);
+
+    void beginRecord();
+    void field(std::string_view name, std::string_view value);
+    void field(std::string_view name, uint64_t value);
+    void field(std::string_view name, int64_t value);
+    void endRecord();
+
+    void flush();
+
+private:
+    void put(char c) {
+        if (used == kBufferSize) flush();
+        buffer[used++] = c;
+    }
+    void append(std::string_view text);
+    void appendEscaped(std::string_view text);
+    void appendNumber(uint64_t value);
+    void appendNumber(int64_t value);
+    bool beginField(std::string_view name); // 写分隔符和键名，返回该字段是否需要输出
+
+    static constexpr size_t kBufferSize = size_t(1) << 20;
+
+    std::FILE* out;
+    OutputFormat format;
+    std::unique_ptr<char[]> buffer;
+    size_t used = 0;
+    unsigned fieldIndex = 0; // 当前记录中已写出的字段数
+};
@@ -1,9 +1,20 @@
 #include "Controller.h"
 #include "FileManager.h"
 #include "CommandParser.h"
+#include "OutputWriter.h"
+#include "TrashManager.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <charconv>
+#include <limits>
+#include <unordered_map>
+#include <grp.h>
+#include <pwd.h>
+#include <sys/stat.h>
 #include <tabulate/table.hpp>
 #include <fmt/core.h>
 #include <fmt/chrono.h>
@@ -11,12 +22,128 @@
 
 using Path = std::filesystem::path;
 
+namespace {
+
+const char* typeName(FileType type) {
+    switch (type) {
+        case FileType::File: return "file";
+        case FileType::Directory: return "dir";
+        case FileType::Symlink: return "symlink";
+        default: return "unknown";
+    }
+}
+
+WalkOptions toWalkOptions(const WalkArgs& args) {
+    WalkOptions options;
+    options.excludes = args.excludes;
+    options.gitignore = args.gitignore;
+    options.oneFileSystem = args.oneFileSystem;
+    return options;
+}
+
+int64_t toUnixTime(const std::filesystem::file_time_type& ftime) {
+    auto sysTime = std::chrono::file_clock::to_sys(ftime);
+    return std::chrono::duration_cast<std::chrono::seconds>(sysTime.time_since_epoch()).count();
+}
+
+// 机器可读格式的一条文件记录，首个字段为名称 (ls) 或绝对路径 (search / stat)
+void writeFileRecord(OutputWriter& writer, const FileInfo& info, bool withPath) {
+    writer.beginRecord();
+    if (withPath) writer.field("path", info.path.native());
+    else writer.field("name", info.name);
+    writer.field("type", typeName(info.type));
+    writer.field("size", static_cast<uint64_t>(info.type == FileType::Directory ? 0 : info.size));
+    writer.field("mtime", toUnixTime(info.modifyTime));
+    writer.endRecord();
+}
+
+// ls 的一列 (--columns)
+struct ListColumn {
+    const char* key;   // --columns 中的名称，也是机器可读输出的字段名
+    const char* title; // 表头
+    uint32_t fields;   // 需要的元数据
+};
+
+constexpr ListColumn kListColumns[] = {
+    {"name", "Name", 0},
+    {"type", "Type", FieldType},
+    {"size", "Size(B)", FieldSize},
+    {"mtime", "Modify Time", FieldModifyTime},
+    {"owner", "Owner", FieldOwner},
+    {"group", "Group", FieldOwner},
+    {"mode", "Mode", FieldMode},
+    {"inode", "Inode", FieldInode},
+    {"blocks", "Blocks", FieldBlocks},
+};
+
+// 解析逗号分隔的列名，未知列名时返回 false 并传出该列名
+bool parseColumns(const std::string& text, std::vector<const ListColumn*>& outColumns, std::string& outUnknown) {
+    outColumns.clear();
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find(',', start);
+        if (end == std::string::npos) end = text.size();
+        std::string_view key(text.data() + start, end - start);
+        if (!key.empty()) {
+            auto it = std::find_if(std::begin(kListColumns), std::end(kListColumns),
+                                   [&](const ListColumn& column) { return key == column.key; });
+            if (it == std::end(kListColumns)) {
+                outUnknown = key;
+                return false;
+            }
+            outColumns.push_back(&*it);
+        }
+        start = end + 1;
+    }
+    return !outColumns.empty();
+}
+
+// ls -l 风格的权限字符串，如 drwxr-xr-x
+std::string modeString(uint32_t mode) {
+    std::string text = "?rwxrwxrwx";
+    if (S_ISDIR(mode)) text[0] = 'd';
+    else if (S_ISLNK(mode)) text[0] = 'l';
+    else if (S_ISREG(mode)) text[0] = '-';
+    for (int bit = 0; bit < 9; ++bit) {
+        if (!(mode & (1u << (8 - bit)))) text[1 + bit] = '-';
+    }
+    return text;
+}
+
+// uid / gid 转为名称，同一次列出中查询过的结果缓存起来
+std::string ownerName(uint32_t id, bool group, std::unordered_map<uint32_t, std::string>& cache) {
+    auto it = cache.find(id);
+    if (it != cache.end()) return it->second;
+    std::string name = std::to_string(id);
+    char buffer[4096];
+    if (group) {
+        struct group entry;
+        struct group* result = nullptr;
+        if (getgrgid_r(id, &entry, buffer, sizeof(buffer), &result) == 0 && result) name = result->gr_name;
+    } else {
+        struct passwd entry;
+        struct passwd* result = nullptr;
+        if (getpwuid_r(id, &entry, buffer, sizeof(buffer), &result) == 0 && result) name = result->pw_name;
+    }
+    cache.emplace(id, name);
+    return name;
+}
+
+} // namespace
+
 Controller::Controller(const std::string& initPath) {
     fileManager = std::make_shared<FileManager>(initPath);
     commandParser = std::make_shared<CommandParser>();
     setupBindings();
 }
 
+Controller::Controller(std::shared_ptr<FileManager> sessionFileManager, std::FILE* output) : out(output) {
+    fileManager = std::move(sessionFileManager);
+    commandParser = std::make_shared<CommandParser>();
+    commandParser->setOutput(parserOutput);
+    setupBindings();
+}
+
 Controller::~Controller() = default;
 
 void Controller::setupBindings()
@@ -24,115 +151,274 @@ void Controller::setupBindings()
     commandParser->onChangeDirectory = [this](const std::string& targetDirectory) {
         Status status = fileManager->changeDirectory(targetDirectory);
         if (status.ok()) {
-            fmt::print(fg(fmt::color::green), "Success: Directory changed.\n");
+            fmt::print(out, fg(fmt::color::green), "Success: Directory changed.\n");
         } else {
-            fmt::print(fg(fmt::color::red), "{}\n", status.message);
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
         }
     };
 
-    commandParser->onListFiles = [this](bool sortSize, bool sortTime) {
+    commandParser->onListFiles = [this](bool sortSize, bool sortTime, const std::string& output, const std::string& columnList) {
         SortMode sortMode = SortMode::Default;
         if (sortSize) sortMode = SortMode::BySize;
         else if (sortTime) sortMode = SortMode::ByTime;
 
+        OutputFormat format;
+        parseOutputFormat(output, format);
+
+        std::vector<const ListColumn*> columns;
+        std::string unknown;
+        if (!parseColumns(columnList.empty() ? "name,type,size,mtime" : columnList, columns, unknown)) {
+            fmt::print(out, fg(fmt::color::red), "Unknown column: {}\n", unknown);
+            return;
+        }
+        // 只获取显示的列需要的元数据
+        uint32_t fields = 0;
+        for (const auto* column : columns) fields |= column->fields;
+
         std::vector<FileInfo> files;
-        Status status = fileManager->listFiles(sortMode, files);
-        if (status.ok()) {
-            tabulate::Table fileTable;
-            fileTable.add_row({"Name", "Type", "Size(B)", "Modify Time"});
+        Status status = fileManager->listFiles(sortMode, fields, files);
+        if (!status.ok()) {
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+            return;
+        }
 
+        std::unordered_map<uint32_t, std::string> users;
+        std::unordered_map<uint32_t, std::string> groups;
+        if (format != OutputFormat::Table) {
+            OutputWriter writer(out, format);
+            std::vector<std::string_view> keys;
+            for (const auto* column : columns) keys.push_back(column->key);
+            writer.header(keys);
             for (const auto& file : files) {
-                std::string displayName = file.name;
-                if (file.type == FileType::Directory) {
-                    displayName += "/";
+                writer.beginRecord();
+                for (const auto* column : columns) {
+                    std::string_view key = column->key;
+                    if (key == "name") writer.field(key, file.name);
+                    else if (key == "type") writer.field(key, typeName(file.type));
+                    else if (key == "size") writer.field(key, static_cast<uint64_t>(file.size));
+                    else if (key == "mtime") writer.field(key, toUnixTime(file.modifyTime));
+                    else if (key == "owner") writer.field(key, ownerName(file.uid, false, users));
+                    else if (key == "group") writer.field(key, ownerName(file.gid, true, groups));
+                    else if (key == "mode") writer.field(key, fmt::format("{:04o}", file.mode & 07777));
+                    else if (key == "inode") writer.field(key, static_cast<uint64_t>(file.inode));
+                    else if (key == "blocks") writer.field(key, static_cast<uint64_t>(file.blocks));
                 }
-                fileTable.add_row({
-                    displayName,
-                    (file.type == FileType::Directory) ? "Dir" : (file.type == FileType::File) ? "File" : "Unknown",
-                    (file.type == FileType::Directory) ? "" : std::to_string(file.size),
-                    fileTimeToString(file.modifyTime)
-                });
-            }
-            fileTable.format()
-                     .font_style({tabulate::FontStyle::bold})
-                     .border_top(" ")
-                     .border_bottom(" ")
-                     .border_left(" ")
-                     .border_right(" ")
-                     .corner(" ");
-            fileTable[0].format()
-                        .padding_top(1)
-                        .padding_bottom(1)
-                        .font_align(tabulate::FontAlign::center)
-                        .font_style({tabulate::FontStyle::underline})
-                        .font_background_color(tabulate::Color::red);
-            fileTable.column(0)
-                     .format()
-                     .font_color(tabulate::Color::yellow);
-            fileTable.print(std::cout);
-        } else {
-            fmt::print(fg(fmt::color::red), "{}\n", status.message);
+                writer.endRecord();
+            }
+            return;
+        }
+
+        tabulate::Table fileTable;
+        tabulate::Table::Row_t header;
+        for (const auto* column : columns) header.push_back(column->title);
+        fileTable.add_row(header);
+
+        for (const auto& file : files) {
+            tabulate::Table::Row_t row;
+            for (const auto* column : columns) {
+                std::string_view key = column->key;
+                if (key == "name") {
+                    row.push_back(file.type == FileType::Directory ? file.name + "/" : file.name);
+                } else if (key == "type") {
+                    row.push_back((file.type == FileType::Directory) ? "Dir" : (file.type == FileType::File) ? "File" : "Unknown");
+                } else if (key == "size") {
+                    row.push_back((file.type == FileType::Directory) ? "" : std::to_string(file.size));
+                } else if (key == "mtime") {
+                    row.push_back(fileTimeToString(file.modifyTime));
+                } else if (key == "owner") {
+                    row.push_back(ownerName(file.uid, false, users));
+                } else if (key == "group") {
+                    row.push_back(ownerName(file.gid, true, groups));
+                } else if (key == "mode") {
+                    row.push_back(modeString(file.mode));
+                } else if (key == "inode") {
+                    row.push_back(std::to_string(file.inode));
+                } else if (key == "blocks") {
+                    row.push_back(std::to_string(file.blocks));
+                }
+            }
+            fileTable.add_row(row);
         }
+        fileTable.format()
+                 .font_style({tabulate::FontStyle::bold})
+                 .border_top(" ")
+                 .border_bottom(" ")
+                 .border_left(" ")
+                 .border_right(" ")
+                 .corner(" ");
+        fileTable[0].format()
+                    .padding_top(1)
+                    .padding_bottom(1)
+                    .font_align(tabulate::FontAlign::center)
+                    .font_style({tabulate::FontStyle::underline})
+                    .font_background_color(tabulate::Color::red);
+        fileTable.column(0)
+                 .format()
+                 .font_color(tabulate::Color::yellow);
+        fmt::print(out, "{}", fileTable.str());
     };
 
     commandParser->onCopy = [this](const std::string& sourcePath, const std::string& targetPath) {
         Status status = fileManager->copyItem(sourcePath, targetPath);
         if (status.ok()) {
-            fmt::print(fg(fmt::color::green), "Success: Item copied.\n");
+            fmt::print(out, fg(fmt::color::green), "Success: Item copied.\n");
         } else {
-            fmt::print(fg(fmt::color::red), "{}\n", status.message);
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
         }
     };
 
     commandParser->onMove = [this](const std::string& sourcePath, const std::string& targetPath) {
         Status status = fileManager->moveItem(sourcePath, targetPath);
         if (status.ok()) {
-            fmt::print(fg(fmt::color::green), "Success: Item moved.\n");
+            fmt::print(out, fg(fmt::color::green), "Success: Item moved.\n");
         } else {
-            fmt::print(fg(fmt::color::red), "{}\n", status.message);
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
         }
     };
 
     commandParser->onTouchFile = [this](const std::string& path) {
         Status status = fileManager->createFile(path);
         if (status.ok()) {
-            fmt::print(fg(fmt::color::green), "Success: File created.\n");
+            fmt::print(out, fg(fmt::color::green), "Success: File created.\n");
         } else {
-            fmt::print(fg(fmt::color::red), "{}\n", status.message);
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
         }
     };
 
     commandParser->onMakeDirectory = [this](const std::string& path) {
         Status status = fileManager->createDirectory(path);
         if (status.ok()) {
-            fmt::print(fg(fmt::color::green), "Success: Directory created.\n");
+            fmt::print(out, fg(fmt::color::green), "Success: Directory created.\n");
         } else {
-            fmt::print(fg(fmt::color::red), "{}\n", status.message);
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
         }
     };
 
     commandParser->onRemove = [this](const std::string& path) {
-        Status status = fileManager->removePath(path);
+        TrashEntry entry;
+        Status status = fileManager->trashPath(path, entry);
         if (status.ok()) {
-            fmt::print(fg(fmt::color::green), "Success: Item removed.\n");
+            fmt::print(out, fg(fmt::color::green), "Moved to trash: {} (use 'undo' to restore)\n", entry.originalPath.string());
         } else {
-            fmt::print(fg(fmt::color::red), "{}\n", status.message);
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
         }
     };
 
     commandParser->onRemoveDirectory = [this](const std::string& path) {
         Status status = fileManager->removePath(path);
         if (status.ok()) {
-            fmt::print(fg(fmt::color::green), "Success: Directory removed.\n");
+            fmt::print(out, fg(fmt::color::green), "Success: Directory removed.\n");
+        } else {
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+        }
+    };
+
+    commandParser->onRename = [this](const std::string& pattern, const std::string& replacement,
+                                     const std::string& dir, bool regex, bool dryRun) {
+        RenameOptions options;
+        options.pattern = pattern;
+        options.replacement = replacement;
+        options.regex = regex;
+        options.dryRun = dryRun;
+        std::vector<RenameItem> items;
+        Status status = fileManager->batchRename(dir, options, items);
+        if (!status.ok()) {
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+            return;
+        }
+        if (items.empty()) {
+            fmt::print(out, "No entries match '{}'\n", pattern);
+            return;
+        }
+        if (dryRun) {
+            for (const auto& item : items) {
+                fmt::print(out, "{} -> {}\n", item.from, fmt::styled(item.to, fg(fmt::color::green)));
+            }
+            fmt::print(out, fg(fmt::color::yellow), "Dry run: {} entries would be renamed.\n", items.size());
+        } else {
+            fmt::print(out, fg(fmt::color::green), "Success: {} entries renamed.\n", items.size());
+        }
+    };
+
+    commandParser->onUndo = [this]() {
+        TrashEntry entry;
+        Status status = fileManager->undoRemove(entry);
+        if (status.ok()) {
+            fmt::print(out, fg(fmt::color::green), "Restored: {}\n", entry.originalPath.string());
+        } else {
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+        }
+    };
+
+    commandParser->onTrashRestore = [this](const std::string& item) {
+        TrashEntry entry;
+        Status status = fileManager->restoreTrash(item, entry);
+        if (status.ok()) {
+            fmt::print(out, fg(fmt::color::green), "Restored: {}\n", entry.originalPath.string());
+        } else {
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+        }
+    };
+
+    commandParser->onTrashList = [this]() {
+        std::vector<TrashEntry> entries;
+        fileManager->listTrash(entries);
+        if (entries.empty()) {
+            fmt::print(out, "Trash is empty.\n");
+            return;
+        }
+        tabulate::Table trashTable;
+        trashTable.add_row({"ID", "Original Path", "Deleted"});
+        for (const auto& entry : entries) {
+            auto deleted = std::chrono::system_clock::from_time_t(static_cast<std::time_t>(entry.deletedAt));
+            trashTable.add_row({entry.id, entry.originalPath.string(),
+                                fileTimeToString(std::chrono::file_clock::from_sys(deleted))});
+        }
+        trashTable.format()
+                  .border_top(" ")
+                  .border_bottom(" ")
+                  .border_left(" ")
+                  .border_right(" ")
+                  .corner(" ");
+        trashTable[0].format()
+                     .font_style({tabulate::FontStyle::bold})
+                     .font_align(tabulate::FontAlign::center)
+                     .font_style({tabulate::FontStyle::underline});
+        fmt::print(out, "{}", trashTable.str());
+        fmt::print(out, "{} items. Items are purged {} hours after removal.\n",
+                   entries.size(), TrashManager::kRetentionSeconds / 3600);
+    };
+
+    commandParser->onTrashEmpty = [this]() {
+        uintmax_t count = 0;
+        Status status = fileManager->emptyTrash(count);
+        if (status.ok() && status.what) {
+            fmt::print(out, "{}\n", status.what);
+        } else if (status.ok()) {
+            fmt::print(out, fg(fmt::color::green), "Purging {} items in the background.\n", count);
         } else {
-            fmt::print(fg(fmt::color::red), "{}\n", status.message);
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
         }
     };
 
-    commandParser->onStat = [this](const std::string& path) {
+    commandParser->onStat = [this](const std::string& path, const std::string& output) {
+        OutputFormat format;
+        parseOutputFormat(output, format);
+
         FileInfo info;
         Status status = fileManager->getFileStat(path, info);
-        if (status.ok()) {
+        if (status.ok() && format != OutputFormat::Table) {
+            OutputWriter writer(out, format);
+            // 创建/访问时间目前只是修改时间的占位，不写入机器可读输出
+            writer.header({"path", "name", "type", "size", "mtime"});
+            writer.beginRecord();
+            writer.field("path", info.path.native());
+            writer.field("name", info.name);
+            writer.field("type", typeName(info.type));
+            writer.field("size", static_cast<uint64_t>(info.type == FileType::Directory ? 0 : info.size));
+            writer.field("mtime", toUnixTime(info.modifyTime));
+            writer.endRecord();
+        } else if (status.ok()) {
             tabulate::Table statTable;
             statTable.add_row({"Property", "Value"});
             statTable.add_row({"Name", info.name});
@@ -157,51 +443,661 @@ void Controller::setupBindings()
                         .font_style({tabulate::FontStyle::underline})
                         .font_background_color(tabulate::Color::blue);
             statTable.column(0).format().font_color(tabulate::Color::cyan);
-            statTable.print(std::cout);
+            fmt::print(out, "{}", statTable.str());
         } else {
-            fmt::print(fg(fmt::color::red), "{}\n", status.message);
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
         }
     };
 
-    commandParser->onSearch = [this](const std::string& keyword) {
+    commandParser->onSearch = [this](const SearchArgs& args) {
+        SearchOptions options;
+        if (!args.glob.empty()) {
+            options.pattern = args.glob;
+            options.mode = MatchMode::Glob;
+        } else if (!args.regex.empty()) {
+            options.pattern = args.regex;
+            options.mode = MatchMode::Regex;
+        } else {
+            options.pattern = args.keyword;
+        }
+
+        if (args.type == "f") options.type = FileType::File;
+        else if (args.type == "d") options.type = FileType::Directory;
+        else if (args.type == "l") options.type = FileType::Symlink;
+        options.walk = toWalkOptions(args.walk);
+
+        uintmax_t bytes = 0;
+        if (!args.minSize.empty()) {
+            if (!parseSize(args.minSize, bytes)) {
+                fmt::print(out, fg(fmt::color::red), "Invalid size: {}\n", args.minSize);
+                return;
+            }
+            options.minSize = bytes;
+        }
+        if (!args.maxSize.empty()) {
+            if (!parseSize(args.maxSize, bytes)) {
+                fmt::print(out, fg(fmt::color::red), "Invalid size: {}\n", args.maxSize);
+                return;
+            }
+            options.maxSize = bytes;
+        }
+
+        auto now = std::filesystem::file_time_type::clock::now();
+        std::chrono::seconds age;
+        if (!args.olderThan.empty()) {
+            if (!parseAge(args.olderThan, age)) {
+                fmt::print(out, fg(fmt::color::red), "Invalid age: {}\n", args.olderThan);
+                return;
+            }
+            options.modifiedBefore = now - age;
+        }
+        if (!args.newerThan.empty()) {
+            if (!parseAge(args.newerThan, age)) {
+                fmt::print(out, fg(fmt::color::red), "Invalid age: {}\n", args.newerThan);
+                return;
+            }
+            options.modifiedAfter = now - age;
+        }
+
+        OutputFormat format;
+        parseOutputFormat(args.output, format);
+
         std::vector<FileInfo> results;
-        Status status = fileManager->search(keyword, results);
-        if (status.ok()) {
+        Status status = fileManager->search("", options, results);
+        if (status.ok() && format != OutputFormat::Table) {
+            OutputWriter writer(out, format);
+            writer.header({"path", "type", "size", "mtime"});
+            for (const auto& file : results) writeFileRecord(writer, file, true);
+        } else if (status.ok()) {
             if (results.empty()) {
-                fmt::print("No files found.\n");
+                fmt::print(out, "No files found.\n");
             } else {
                 for (const auto& file : results) {
-                    fmt::print("{}\n", file.path.string());
+                    fmt::print(out, "{}\n", file.path.string());
+                }
+            }
+        } else {
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+        }
+    };
+
+    commandParser->onDiskUsage = [this](const std::string& path, bool tree, bool rescan, const WalkArgs& walk) {
+        WalkOptions walkOptions = toWalkOptions(walk);
+        std::string displayPath = path.empty() ? "." : path;
+        if (!tree) {
+            uintmax_t size;
+            Status status = fileManager->calculateDirSize(path, walkOptions, size);
+            if (status.ok()) {
+                fmt::print(out, "Total size of {}: {}\n", displayPath, formatSize(size));
+            } else {
+                fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+            }
+            return;
+        }
+
+        DiskUsageEntry root;
+        std::vector<DiskUsageEntry> children;
+        Status status = fileManager->diskUsageTree(path, rescan, walkOptions, root, children);
+        if (!status.ok()) {
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+            return;
+        }
+
+        fmt::print(out, fg(fmt::color::yellow) | fmt::emphasis::bold, "{}  {} ({} files)\n",
+                   root.path.string(), formatSize(root.totalSize), root.fileCount);
+        uintmax_t childTotal = 0;
+        for (const auto& child : children) {
+            childTotal += child.totalSize;
+            double ratio = root.totalSize ? static_cast<double>(child.totalSize) / root.totalSize : 0.0;
+            int filled = static_cast<int>(ratio * 20 + 0.5);
+            fmt::print(out, "  {:>10}  [{:<20}] {:5.1f}%  {}/\n", formatSize(child.totalSize),
+                       std::string(filled, '#'), ratio * 100, child.name);
+        }
+        fmt::print(out, "  {:>10}  {:<22} {:>6}  (files in this directory)\n", formatSize(root.totalSize - childTotal), "", "");
+    };
+
+    commandParser->onDuplicates = [this](const std::string& path) {
+        std::vector<DuplicateGroup> groups;
+        Status status = fileManager->findDuplicates(path, groups);
+        if (!status.ok()) {
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+            return;
+        }
+        if (groups.empty()) {
+            fmt::print(out, "No duplicate files found.\n");
+            return;
+        }
+
+        uintmax_t wasted = 0;
+        for (size_t i = 0; i < groups.size(); ++i) {
+            const auto& group = groups[i];
+            wasted += group.size * (group.paths.size() - 1);
+            fmt::print(out, fg(fmt::color::yellow), "[{}] {} files x {}\n", i + 1, group.paths.size(), formatSize(group.size));
+            for (const auto& file : group.paths) {
+                fmt::print(out, "    {}\n", file.string());
+            }
+        }
+        fmt::print(out, fg(fmt::color::green), "{} duplicate groups, {} reclaimable.\n", groups.size(), formatSize(wasted));
+    };
+
+    commandParser->onAnalyze = [this](const std::string& path, const WalkArgs& walk) {
+        TreeAnalysis analysis;
+        Status status = fileManager->analyzeTree(path, toWalkOptions(walk), analysis);
+        if (!status.ok()) {
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+            return;
+        }
+        fmt::print(out, fg(fmt::color::yellow) | fmt::emphasis::bold, "{}  {} in {} files, {} directories\n",
+                   path.empty() ? "." : path, formatSize(analysis.bytes), analysis.files, analysis.dirs);
+        if (analysis.files == 0) return;
+
+        // 每张表最多显示 limit 行，其余合并为 "(other)"
+        auto printHistogram = [&](const char* title, const std::vector<HistogramBucket>& buckets, size_t limit) {
+            tabulate::Table table;
+            table.add_row({title, "Files", "Files %", "Size", "Size %"});
+            auto addRow = [&](const std::string& label, uintmax_t files, uintmax_t bytes) {
+                double filesRatio = static_cast<double>(files) / analysis.files;
+                double bytesRatio = analysis.bytes ? static_cast<double>(bytes) / analysis.bytes : 0.0;
+                table.add_row({label, std::to_string(files), fmt::format("{:.1f}%", filesRatio * 100),
+                               formatSize(bytes), fmt::format("{:.1f}%", bytesRatio * 100)});
+            };
+            uintmax_t otherFiles = 0;
+            uintmax_t otherBytes = 0;
+            for (size_t i = 0; i < buckets.size(); ++i) {
+                if (i < limit) {
+                    addRow(buckets[i].label, buckets[i].files, buckets[i].bytes);
+                } else {
+                    otherFiles += buckets[i].files;
+                    otherBytes += buckets[i].bytes;
+                }
+            }
+            if (buckets.size() > limit) addRow(fmt::format("(other {})", buckets.size() - limit), otherFiles, otherBytes);
+
+            table.format()
+                 .border_top(" ")
+                 .border_bottom(" ")
+                 .border_left(" ")
+                 .border_right(" ")
+                 .corner(" ");
+            table[0].format()
+                    .font_style({tabulate::FontStyle::bold})
+                    .font_style({tabulate::FontStyle::underline});
+            for (size_t column = 1; column < 5; ++column) {
+                table.column(column).format().font_align(tabulate::FontAlign::right);
+            }
+            fmt::print(out, "{}\n", table.str());
+        };
+        printHistogram("Extension", analysis.byExtension, 20);
+        printHistogram("Size", analysis.bySize, analysis.bySize.size());
+        printHistogram("Modified", analysis.byAge, analysis.byAge.size());
+    };
+
+    commandParser->onTop = [this](const std::string& path, size_t count, const std::string& by,
+                                  const std::string& output, const WalkArgs& walk) {
+        TopOptions options;
+        options.count = count;
+        options.by = by == "mtime" ? SortMode::ByTime : SortMode::BySize;
+        options.walk = toWalkOptions(walk);
+        OutputFormat format;
+        parseOutputFormat(output, format);
+
+        std::vector<FileInfo> files;
+        Status status = fileManager->topFiles(path, options, files);
+        if (!status.ok()) {
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+            return;
+        }
+        if (format != OutputFormat::Table) {
+            OutputWriter writer(out, format);
+            writer.header({"path", "type", "size", "mtime"});
+            for (const auto& file : files) writeFileRecord(writer, file, true);
+            return;
+        }
+        if (files.empty()) {
+            fmt::print(out, "No files found.\n");
+            return;
+        }
+        size_t rankWidth = fmt::formatted_size("{}", files.size());
+        for (size_t i = 0; i < files.size(); ++i) {
+            fmt::print(out, "{:>{}}  {:>10}  {}  {}\n", i + 1, rankWidth, formatSize(files[i].size),
+                       fileTimeToString(files[i].modifyTime), files[i].path.string());
+        }
+    };
+
+    commandParser->onGrep = [this](const std::string& pattern, const std::string& path) {
+        uintmax_t matches = 0;
+        Status status = fileManager->grep(path, pattern, [this](const GrepMatch& match) {
+            fmt::print(out, "{}:{}:{}\n",
+                       fmt::styled(match.path, fg(fmt::color::magenta)),
+                       fmt::styled(match.lineNumber, fg(fmt::color::green)),
+                       match.line);
+        }, matches);
+        if (!status.ok()) {
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+        } else if (matches == 0) {
+            fmt::print(out, "No matches found for '{}'\n", pattern);
+        }
+    };
+
+    commandParser->onWordCount = [this](const std::string& path) {
+        std::vector<WordCount> files;
+        WordCount total;
+        Status status = fileManager->wordCount(path, files, total);
+        if (!status.ok()) {
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+            return;
+        }
+
+        // 各列按合计的位数对齐
+        size_t width = fmt::formatted_size("{}", std::max({total.lines, total.words, total.bytes}));
+        for (const auto& file : files) {
+            fmt::print(out, "{:>{}} {:>{}} {:>{}} {}\n", file.lines, width, file.words, width, file.bytes, width, file.path);
+        }
+        if (files.size() != 1) {
+            fmt::print(out, fmt::emphasis::bold, "{:>{}} {:>{}} {:>{}} total ({} files)\n",
+                       total.lines, width, total.words, width, total.bytes, width, files.size());
+        }
+    };
+
+    commandParser->onCompare = [this](const std::string& first, const std::string& second) {
+        std::vector<FileDifference> differences;
+        Status status = fileManager->compare(first, second, differences);
+        if (!status.ok()) {
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+            return;
+        }
+        if (differences.empty()) {
+            fmt::print(out, fg(fmt::color::green), "{} and {} are identical\n", first, second);
+            return;
+        }
+
+        for (const auto& diff : differences) {
+            // 比较两个文件时没有相对路径
+            std::string name = diff.path.empty() ? fmt::format("{} {}", first, second) : diff.path;
+            switch (diff.kind) {
+                case DifferenceKind::OnlyInFirst:
+                    fmt::print(out, fg(fmt::color::red), "- {} (only in {})\n", name, first);
+                    break;
+                case DifferenceKind::OnlyInSecond:
+                    fmt::print(out, fg(fmt::color::green), "+ {} (only in {})\n", name, second);
+                    break;
+                case DifferenceKind::TypeDiffers:
+                    fmt::print(out, fg(fmt::color::yellow), "T {} (type differs)\n", name);
+                    break;
+                case DifferenceKind::SizeDiffers:
+                    fmt::print(out, fg(fmt::color::yellow), "S {} ({} -> {})\n", name,
+                               formatSize(diff.firstSize), formatSize(diff.secondSize));
+                    break;
+                case DifferenceKind::ContentDiffers:
+                    fmt::print(out, fg(fmt::color::yellow), "M {} (differs at byte {})\n", name, diff.offset);
+                    break;
+                case DifferenceKind::Unreadable:
+                    fmt::print(out, fg(fmt::color::red), "? {} (cannot read)\n", name);
+                    break;
+            }
+        }
+        fmt::print(out, "{} differences\n", differences.size());
+    };
+
+    commandParser->onHead = [this](const std::string& path, size_t lines) {
+        Status status = fileManager->headFile(path, lines, [this](std::string_view data) {
+            return std::fwrite(data.data(), 1, data.size(), out) == data.size();
+        });
+        if (!status.ok()) {
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+        }
+    };
+
+    commandParser->onTail = [this](const std::string& path, size_t lines, bool follow) {
+        auto print = [this](std::string_view data) {
+            return std::fwrite(data.data(), 1, data.size(), out) == data.size();
+        };
+        uintmax_t endOffset = 0;
+        Status status = fileManager->tailFile(path, lines, print, endOffset);
+        if (status.ok() && follow) {
+            std::fflush(out);
+            // 跟随时每块新内容立即刷新，服务模式下即立即发送给客户端
+            status = fileManager->followFile(path, endOffset, [this](std::string_view data) {
+                return std::fwrite(data.data(), 1, data.size(), out) == data.size() && std::fflush(out) == 0;
+            });
+        }
+        if (!status.ok()) {
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+        }
+    };
+
+    commandParser->onView = [this](const ViewArgs& args) {
+        constexpr size_t kDefaultPageLines = 40;
+        size_t lines = args.lines > 0 ? args.lines : kDefaultPageLines;
+
+        uintmax_t offset = 0;
+        bool align = false;
+        if (args.path.empty()) {
+            if (viewPath.empty()) {
+                fmt::print(out, fg(fmt::color::red), "Missing target: Please enter 'view [file]'\n");
+                return;
+            }
+            offset = viewOffset;
+        } else {
+            // 记录绝对路径，之后 cd 到其他目录也能继续翻页
+            Path current;
+            fileManager->getCurrentPath(current);
+            viewPath = current / args.path;
+            if (args.line > 0) {
+                Status status = fileManager->findLine(viewPath, args.line, offset);
+                if (!status.ok()) {
+                    fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+                    return;
+                }
+            } else if (!args.offset.empty()) {
+                if (!parseSize(args.offset, offset)) {
+                    fmt::print(out, fg(fmt::color::red), "Invalid offset: {}\n", args.offset);
+                    return;
                 }
+                align = true;
+            } else if (args.percent >= 0) {
+                FileInfo info;
+                Status status = fileManager->getFileStat(viewPath.string(), info);
+                if (!status.ok()) {
+                    fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+                    return;
+                }
+                offset = static_cast<uintmax_t>(static_cast<long double>(info.size) * args.percent / 100);
+                align = true;
             }
+        }
+
+        TextPage page;
+        Status status = fileManager->readPage(viewPath, offset, lines, align, page);
+        if (!status.ok()) {
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+            return;
+        }
+        std::fwrite(page.text.data(), 1, page.text.size(), out);
+        if (!page.text.empty() && page.text.back() != '\n') fmt::print(out, "\n");
+        viewOffset = page.nextOffset;
+
+        double percent = page.fileSize ? 100.0 * static_cast<double>(page.nextOffset) / static_cast<double>(page.fileSize) : 100.0;
+        if (page.nextOffset >= page.fileSize) {
+            fmt::print(out, fg(fmt::color::gray), "-- {} bytes {}-{} of {} (END) --\n",
+                       viewPath.filename().string(), page.offset, page.nextOffset, page.fileSize);
         } else {
-            fmt::print(fg(fmt::color::red), "{}\n", status.message);
+            fmt::print(out, fg(fmt::color::gray), "-- {} bytes {}-{} of {} ({:.1f}%), 'view' for the next page --\n",
+                       viewPath.filename().string(), page.offset, page.nextOffset, page.fileSize, percent);
         }
     };
 
-    commandParser->onDiskUsage = [this](const std::string& path) {
-        uintmax_t size;
-        Status status = fileManager->calculateDirSize(path, size);
+    commandParser->onSnapshotSave = [this](const std::string& file, const std::string& path) {
+        uintmax_t entries = 0;
+        Status status = fileManager->saveSnapshot(path, file, entries);
         if (status.ok()) {
-            fmt::print("Total size of {}: {}\n", path, formatSize(size));
+            fmt::print(out, fg(fmt::color::green), "Success: Snapshot saved to {} ({} entries).\n", file, entries);
         } else {
-            fmt::print(fg(fmt::color::red), "{}\n", status.message);
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+        }
+    };
+
+    commandParser->onCacheStatus = [this](const std::string& path, const WalkArgs& walk) {
+        std::vector<CacheResidency> files;
+        CacheResidency total;
+        Status status = fileManager->cacheStatus(path, toWalkOptions(walk), files, total);
+        if (!status.ok()) {
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+            return;
+        }
+
+        // 驻留字节数按页的比例折算，最后一页不满时不会超过文件大小
+        auto print = [this](const CacheResidency& entry, const std::string& name, fmt::text_style style) {
+            double ratio = entry.pages ? static_cast<double>(entry.residentPages) / entry.pages : 1.0;
+            fmt::print(out, style, "{:5.1f}%  {:>10} / {:<10}  {}\n", ratio * 100,
+                       formatSize(static_cast<uintmax_t>(entry.bytes * ratio)), formatSize(entry.bytes), name);
+        };
+        for (const auto& file : files) print(file, file.path, fmt::text_style());
+        if (files.size() != 1) {
+            print(total, fmt::format("total ({} files)", total.files), fmt::emphasis::bold);
+        }
+    };
+
+    commandParser->onCacheAdvise = [this](const std::string& path, bool drop, const WalkArgs& walk) {
+        CacheResidency total;
+        Status status = fileManager->adviseCache(path, drop ? CacheAction::Drop : CacheAction::Warm,
+                                                 toWalkOptions(walk), total);
+        if (!status.ok()) {
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+            return;
+        }
+        fmt::print(out, fg(fmt::color::green), "{} {} files ({}).\n", drop ? "Dropped" : "Warmed",
+                   total.files, formatSize(total.bytes));
+    };
+
+    commandParser->onMemStats = [this]() {
+        if (!AllocTracker::enabled()) {
+            fmt::print(out, "Allocation tracking is not compiled in. Rebuild with -DMFE_ALLOC_TRACKING=ON.\n");
+            return;
+        }
+        if (allocHistory.empty()) {
+            fmt::print(out, "No commands recorded yet.\n");
+            return;
+        }
+
+        auto signedSize = [this](int64_t bytes) {
+            return bytes < 0 ? "-" + formatSize(static_cast<uintmax_t>(-bytes)) : formatSize(static_cast<uintmax_t>(bytes));
+        };
+        tabulate::Table table;
+        tabulate::Table::Row_t header = {"Command", "Allocs", "Allocated", "Peak", "Retained"};
+        for (size_t i = 0; i < kAllocCategoryCount; ++i) {
+            header.push_back(AllocTracker::categoryName(static_cast<AllocCategory>(i)));
+        }
+        table.add_row(header);
+        for (const auto& stats : allocHistory) {
+            // 过长的命令行截断显示
+            std::string command = stats.command.size() > 40 ? stats.command.substr(0, 37) + "..." : stats.command;
+            tabulate::Table::Row_t row = {command, std::to_string(stats.allocated.total.count),
+                                          formatSize(stats.allocated.total.bytes), signedSize(stats.peak),
+                                          signedSize(stats.retained)};
+            for (const auto& counters : stats.allocated.byCategory) {
+                row.push_back(counters.count ? formatSize(counters.bytes) : "-");
+            }
+            table.add_row(row);
+        }
+        table.format()
+             .border_top(" ")
+             .border_bottom(" ")
+             .border_left(" ")
+             .border_right(" ")
+             .corner(" ");
+        table[0].format()
+                .font_style({tabulate::FontStyle::bold})
+                .font_style({tabulate::FontStyle::underline});
+        fmt::print(out, "{}", table.str());
+
+        AllocSnapshot now = AllocTracker::snapshot();
+        fmt::print(out, "Live heap: {} in {} allocations since start ({} allocated).\n",
+                   formatSize(static_cast<uintmax_t>(now.live)), now.total.count, formatSize(now.total.bytes));
+    };
+
+    commandParser->onSnapshotDiff = [this](const std::string& before, const std::string& after) {
+        std::vector<SnapshotChange> changes;
+        Status status = fileManager->diffSnapshots(before, after, changes);
+        if (!status.ok()) {
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+            return;
+        }
+
+        size_t counts[4] = {0, 0, 0, 0};
+        for (const auto& change : changes) {
+            counts[static_cast<int>(change.kind)]++;
+            std::string suffix = (change.type == FileType::Directory) ? "/" : "";
+            switch (change.kind) {
+                case ChangeKind::Added:
+                    fmt::print(out, fg(fmt::color::green), "+ {}{}\n", change.path, suffix);
+                    break;
+                case ChangeKind::Removed:
+                    fmt::print(out, fg(fmt::color::red), "- {}{}\n", change.path, suffix);
+                    break;
+                case ChangeKind::Modified:
+                    fmt::print(out, fg(fmt::color::yellow), "M {}{} ({} -> {})\n", change.path, suffix,
+                               formatSize(change.oldSize), formatSize(change.newSize));
+                    break;
+                case ChangeKind::Moved:
+                    fmt::print(out, fg(fmt::color::cyan), "R {}{} -> {}{}\n", change.path, suffix, change.newPath, suffix);
+                    break;
+            }
+        }
+        fmt::print(out, "{} added, {} removed, {} modified, {} moved\n",
+                   counts[static_cast<int>(ChangeKind::Added)], counts[static_cast<int>(ChangeKind::Removed)],
+                   counts[static_cast<int>(ChangeKind::Modified)], counts[static_cast<int>(ChangeKind::Moved)]);
+    };
+
+    commandParser->onSync = [this](const std::string& src, const std::string& dst,
+                                   bool checksum, bool deleteExtras, bool dryRun) {
+        SyncOptions options;
+        options.checksum = checksum;
+        options.deleteExtras = deleteExtras;
+        options.dryRun = dryRun;
+
+        SyncReport report;
+        Status status = fileManager->syncTree(src, dst, options, report);
+        if (!status.ok()) {
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+            return;
+        }
+
+        for (const auto& action : report.plannedActions) {
+            fmt::print(out, "{}\n", action);
+        }
+        for (size_t i = 0; i < report.errors.size(); ++i) {
+            fmt::print(out, fg(fmt::color::red), "{}\n", report.errors.message(i));
+        }
+        fmt::print(out, fg(fmt::color::green), "{}{} files copied ({}), {} unchanged, {} directories created, {} deleted\n",
+                   dryRun ? "[dry run] " : "", report.filesCopied, formatSize(report.bytesCopied),
+                   report.filesUnchanged, report.dirsCreated, report.entriesDeleted);
+        if (!report.errors.empty()) {
+            fmt::print(out, fg(fmt::color::red), "{} entries failed\n", report.errors.size());
+        }
+    };
+
+    commandParser->onPack = [this](const std::string& dir, const std::string& archive) {
+        ArchiveReport report;
+        Status status = fileManager->packTree(dir, archive, report);
+        if (!status.ok()) {
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+            return;
+        }
+        for (size_t i = 0; i < report.errors.size(); ++i) {
+            fmt::print(out, fg(fmt::color::yellow), "{}\n", report.errors.message(i));
         }
+        fmt::print(out, fg(fmt::color::green), "Packed {} entries ({}) into {}\n",
+                   report.entries, formatSize(report.bytes), archive);
+    };
+
+    commandParser->onUnpack = [this](const std::string& archive, const std::string& dir) {
+        ArchiveReport report;
+        Status status = fileManager->unpackArchive(archive, dir, report);
+        if (!status.ok()) {
+            fmt::print(out, fg(fmt::color::red), "{}\n", status.message());
+            return;
+        }
+        for (size_t i = 0; i < report.errors.size(); ++i) {
+            fmt::print(out, fg(fmt::color::red), "{}\n", report.errors.message(i));
+        }
+        fmt::print(out, fg(fmt::color::green), "Extracted {} entries ({})\n", report.entries, formatSize(report.bytes));
+    };
+
+    commandParser->onThrottle = [this](const ThrottleArgs& args) {
+        IoLimits limits;
+        fileManager->getIoLimits(limits);
+        if (args.off) limits = IoLimits();
+
+        uintmax_t value = 0;
+        if (!args.rate.empty()) {
+            if (!parseSize(args.rate, value)) {
+                fmt::print(out, fg(fmt::color::red), "Invalid rate: {}\n", args.rate);
+                return;
+            }
+            limits.bytesPerSecond = value;
+        }
+        auto parseCount = [&](const std::string& text, uintmax_t& outValue) {
+            auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), outValue);
+            return ec == std::errc() && end == text.data() + text.size();
+        };
+        if (!args.iops.empty()) {
+            if (!parseCount(args.iops, value)) {
+                fmt::print(out, fg(fmt::color::red), "Invalid IOPS: {}\n", args.iops);
+                return;
+            }
+            limits.opsPerSecond = value;
+        }
+        if (!args.inFlight.empty()) {
+            if (!parseCount(args.inFlight, value) || value > UINT32_MAX) {
+                fmt::print(out, fg(fmt::color::red), "Invalid in-flight limit: {}\n", args.inFlight);
+                return;
+            }
+            limits.maxInFlight = static_cast<unsigned>(value);
+        }
+        if (args.idle) limits.idlePriority = true;
+        if (args.normal) limits.idlePriority = false;
+        fileManager->setIoLimits(limits);
+
+        auto show = [&](uint64_t v, const std::string& text) { return v == 0 ? std::string("unlimited") : text; };
+        fmt::print(out, "I/O rate:     {}\n", show(limits.bytesPerSecond, formatSize(limits.bytesPerSecond) + "/s"));
+        fmt::print(out, "IOPS:         {}\n", show(limits.opsPerSecond, std::to_string(limits.opsPerSecond)));
+        fmt::print(out, "In flight:    {}\n", show(limits.maxInFlight, std::to_string(limits.maxInFlight)));
+        fmt::print(out, "I/O priority: {}\n", limits.idlePriority ? "idle" : "normal");
     };
 
     commandParser->onExit = [this]() {
-        fmt::print("Exiting shell...\n");
+        fmt::print(out, "Exiting shell...\n");
     };
 }
 
 void Controller::parse(const std::string& inputLine) {
-    commandParser->process(inputLine);
+    // 未显式标记的分配 (命令解析、表格与格式化输出) 记入 Rendering
+    const AllocSnapshot allocBefore = AllocTracker::snapshot();
+    AllocTracker::resetPeak();
+    {
+        AllocScope scope(AllocCategory::Rendering);
+        commandParser->process(inputLine);
+    }
+    if (AllocTracker::enabled()) recordAllocStats(inputLine, allocBefore);
+
+    // 会话模式下解析器的帮助和错误信息先写入缓冲区，再与命令输出一起送出
+    if (out != stdout) {
+        std::string parserText = parserOutput.str();
+        if (!parserText.empty()) {
+            std::fwrite(parserText.data(), 1, parserText.size(), out);
+            parserOutput.str(std::string());
+        }
+    }
+    std::fflush(out);
+}
+
+void Controller::recordAllocStats(const std::string& inputLine, const AllocSnapshot& before) {
+    std::istringstream in(inputLine);
+    std::string command;
+    in >> command;
+    if (command.empty() || command == "memstats") return;
+
+    AllocSnapshot after = AllocTracker::snapshot();
+    CommandAllocStats stats;
+    stats.command = inputLine;
+    stats.allocated.total.count = after.total.count - before.total.count;
+    stats.allocated.total.bytes = after.total.bytes - before.total.bytes;
+    for (size_t i = 0; i < kAllocCategoryCount; ++i) {
+        stats.allocated.byCategory[i].count = after.byCategory[i].count - before.byCategory[i].count;
+        stats.allocated.byCategory[i].bytes = after.byCategory[i].bytes - before.byCategory[i].bytes;
+    }
+    stats.peak = after.peak - before.live;
+    stats.retained = after.live - before.live;
+    allocHistory.push_back(std::move(stats));
+    if (allocHistory.size() > kAllocHistorySize) allocHistory.pop_front();
 }
 
 std::string Controller::fileTimeToString(const std::filesystem::file_time_type& ftime) {
     auto sys_time = std::chrono::file_clock::to_sys(ftime);
     auto time_t_val = std::chrono::system_clock::to_time_t(sys_time);
-    auto local_tm = *std::localtime(&time_t_val);
+    std::tm local_tm;
+    localtime_r(&time_t_val, &local_tm);
     return fmt::format("{:04d}-{:02d}-{:02d} {:02d}:{:02d}:{:02d}",
                        local_tm.tm_year + 1900,
                        local_tm.tm_mon + 1,
@@ -215,4 +1111,65 @@ std::string Controller::formatSize(uintmax_t bytes) {
     if (bytes < 1024) return std::to_string(bytes) + " B";
     if (bytes < 1024 * 1024) return std::to_string(bytes / 1024) + " KB";
     return std::to_string(bytes / (1024 * 1024)) + " MB";
-}
\ No newline at end of file
+}
+
+// 解析带单位的大小：100, 4K, 100M, 2G, 1T (1024 进制，可带 B 后缀)
+bool Controller::parseSize(const std::string& text, uintmax_t& outBytes) {
+    // stoull 会跳过空白并接受负号 ("-1" 回绕为 2^64-1)，因此要求以数字开头
+    if (text.empty() || text[0] < '0' || text[0] > '9') return false;
+    size_t pos = 0;
+    uintmax_t value = 0;
+    try {
+        value = std::stoull(text, &pos);
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    std::string unit = text.substr(pos);
+    if (!unit.empty() && (unit.back() == 'B' || unit.back() == 'b') && unit.size() > 1) unit.pop_back();
+    if (unit.empty() || unit == "B" || unit == "b") {
+        outBytes = value;
+        return true;
+    }
+    if (unit.size() != 1) return false;
+
+    int shift = 0;
+    switch (unit[0]) {
+        case 'K': case 'k': shift = 10; break;
+        case 'M': case 'm': shift = 20; break;
+        case 'G': case 'g': shift = 30; break;
+        case 'T': case 't': shift = 40; break;
+        default: return false;
+    }
+    if (value > (UINTMAX_MAX >> shift)) return false;
+    outBytes = value << shift;
+    return true;
+}
+
+// 解析时间跨度：30s, 15m, 12h, 30d, 2w，纯数字按天计
+bool Controller::parseAge(const std::string& text, std::chrono::seconds& outAge) {
+    size_t pos = 0;
+    long long value = 0;
+    try {
+        value = std::stoll(text, &pos);
+    } catch (const std::exception&) {
+        return false;
+    }
+    if (value < 0) return false;
+
+    std::string unit = text.substr(pos);
+    long long scale = 0;
+    if (unit.empty() || unit == "d") scale = 86400;
+    else if (unit == "s") scale = 1;
+    else if (unit == "m") scale = 60;
+    else if (unit == "h") scale = 3600;
+    else if (unit == "w") scale = 7 * 86400;
+    else return false;
+    if (value > std::numeric_limits<long long>::max() / scale) return false;
+
+    // 调用方计算 now - age，file_time_type 以纳秒计，只能表示约 ±292 年，且 libstdc++ 的纪元在 2174 年
+    // 超过 100 年按 100 年处理，此时的筛选结果与更大的值相同
+    constexpr long long kMaxAgeSeconds = 100LL * 366 * 86400;
+    outAge = std::chrono::seconds(std::min(value * scale, kMaxAgeSeconds));
+    return true;
+}
@@ -0,0 +1,158 @@
+#include "OutputWriter.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+namespace {
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+// JSON 字符串中需要转义的字符
+bool needsJsonEscape(unsigned char c) {
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+bool needsTsvEscape(unsigned char c) {
+    return c == '\t' || c == '\n' || c == '\r' || c == '\\';
+}
+
+} // namespace
+
+bool parseOutputFormat(std::string_view text, OutputFormat& outFormat) {
+    if (text.empty() || text == "table") outFormat = OutputFormat::Table;
+    else if (text == "jsonl") outFormat = OutputFormat::JsonLines;
+    else if (text == "nul") outFormat = OutputFormat::Nul;
+    else if (text == "tsv") outFormat = OutputFormat::Tsv;
+    else return false;
+    return true;
+}
+
+OutputWriter::OutputWriter(std::FILE* out, OutputFormat format)
+    : out(out), format(format), buffer(new char[kBufferSize]) {}
+
+OutputWriter::~OutputWriter() {
+    flush();
+}
+
+void OutputWriter::flush() {
+    if (used > 0) {
+        std::fwrite(buffer.get(), 1, used, out);
+        used = 0;
+    }
+    std::fflush(out);
+}
+
+void OutputWriter::append(std::string_view text) {
+    while (!text.empty()) {
+        if (used == kBufferSize) flush();
+        size_t n = std::min(text.size(), kBufferSize - used);
+        std::memcpy(buffer.get() + used, text.data(), n);
+        used += n;
+        text.remove_prefix(n);
+    }
+}
+
+void OutputWriter::appendEscaped(std::string_view text) {
+    // 不需要转义的连续片段整段复制
+    size_t start = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        bool escape = format == OutputFormat::JsonLines ? needsJsonEscape(c) : needsTsvEscape(c);
+        if (!escape) continue;
+
+        append(text.substr(start, i - start));
+        start = i + 1;
+        put('\\');
+        switch (c) {
+            case '\n': put('n'); break;
+            case '\t': put('t'); break;
+            case '\r': put('r'); break;
+            case '"':  put('"'); break;
+            case '\\': put('\\'); break;
+            default:
+                append("u00");
+                put(kHexDigits[c >> 4]);
+                put(kHexDigits[c & 0xF]);
+                break;
+        }
+    }
+    append(text.substr(start));
+}
+
+void OutputWriter::appendNumber(uint64_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    append(std::string_view(digits, static_cast<size_t>(result.ptr - digits)));
+}
+
+void OutputWriter::appendNumber(int64_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    append(std::string_view(digits, static_cast<size_t>(result.ptr - digits)));
+}
+
+void OutputWriter::header(std::initializer_list<std::string_view> names) {
+    header(std::vector<std::string_view>(names));
+}
+
+void OutputWriter::header(const std::vector<std::string_view>& names) {
+    if (format != OutputFormat::Tsv) return;
+    bool first = true;
+    for (std::string_view name : names) {
+        if (!first) put('\t');
+        append(name);
+        first = false;
+    }
+    put('\n');
+}
+
+void OutputWriter::beginRecord() {
+    fieldIndex = 0;
+    if (format == OutputFormat::JsonLines) put('{');
+}
+
+bool OutputWriter::beginField(std::string_view name) {
+    unsigned index = fieldIndex++;
+    switch (format) {
+        case OutputFormat::JsonLines:
+            if (index > 0) put(',');
+            put('"');
+            appendEscaped(name);
+            append("\":");
+            return true;
+        case OutputFormat::Tsv:
+            if (index > 0) put('\t');
+            return true;
+        case OutputFormat::Nul:
+            return index == 0;
+        default:
+            return false;
+    }
+}
+
+void OutputWriter::field(std::string_view name, std::string_view value) {
+    if (!beginField(name)) return;
+    if (format == OutputFormat::Nul) {
+        append(value);
+        return;
+    }
+    if (format == OutputFormat::JsonLines) put('"');
+    appendEscaped(value);
+    if (format == OutputFormat::JsonLines) put('"');
+}
+
+void OutputWriter::field(std::string_view name, uint64_t value) {
+    if (beginField(name)) appendNumber(value);
+}
+
+void OutputWriter::field(std::string_view name, int64_t value) {
+    if (beginField(name)) appendNumber(value);
+}
+
+void OutputWriter::endRecord() {
+    switch (format) {
+        case OutputFormat::JsonLines: append("}\n"); break;
+        case OutputFormat::Nul: put('\0'); break;
+        default: put('\n'); break;
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// 行数 / 单词数统计 (wc)
+// 单词为被空白 (' ' \t \n \v \f \r) 分隔的非空白字节序列；UTF-8 等非 ASCII 字节算作单词的一部分
+// 用 SIMD 每次比较 16 字节：换行和 "前一字节为空白且本字节非空白" (单词开头) 的比较结果为 0xFF，
+// 直接累加进 16 个字节计数器，每 255 轮用 _mm_sad_epu8 横向求和一次，不需要逐位 popcount
+struct TextCounter {
+    uint64_t lines = 0;
+    uint64_t words = 0;
+
+    static bool isSpace(uint8_t c) {
+        return c == ' ' || static_cast<uint8_t>(c - '\t') <= '\r' - '\t';
+    }
+
+    // 统计 [data, data + len)
+    // [In] prevSpace: data 之前的字节是否为空白，文件开头视为空白；分块统计时由调用者给出
+    void count(const uint8_t* data, size_t len, bool prevSpace) {
+        size_t i = 0;
+        bool carry = prevSpace;
+
+#if defined(__SSE2__)
+        const __m128i vNewline = _mm_set1_epi8('\n');
+        const __m128i vSpace = _mm_set1_epi8(' ');
+        const __m128i vTab = _mm_set1_epi8('\t');
+        const __m128i vCtrlRange = _mm_set1_epi8('\r' - '\t');
+        const __m128i zero = _mm_setzero_si128();
+        // 上一块的空白比较结果，只用到最高字节
+        __m128i previous = carry ? _mm_set1_epi8(-1) : zero;
+
+        while (len - i >= 16) {
+            __m128i lineAcc = zero;
+            __m128i wordAcc = zero;
+            size_t rounds = std::min<size_t>((len - i) / 16, 255);
+            for (size_t r = 0; r < rounds; ++r, i += 16) {
+                __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                // \t..\r：block - '\t' 按无符号比较不大于 4
+                __m128i shifted = _mm_sub_epi8(block, vTab);
+                __m128i space = _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(shifted, vCtrlRange), shifted),
+                                             _mm_cmpeq_epi8(block, vSpace));
+                __m128i prevSpace = _mm_or_si128(_mm_slli_si128(space, 1), _mm_srli_si128(previous, 15));
+                lineAcc = _mm_sub_epi8(lineAcc, _mm_cmpeq_epi8(block, vNewline));
+                wordAcc = _mm_sub_epi8(wordAcc, _mm_andnot_si128(space, prevSpace));
+                previous = space;
+            }
+            __m128i lineSum = _mm_sad_epu8(lineAcc, zero);
+            __m128i wordSum = _mm_sad_epu8(wordAcc, zero);
+            lines += static_cast<uint64_t>(_mm_cvtsi128_si32(lineSum)) +
+                     static_cast<uint64_t>(_mm_cvtsi128_si32(_mm_srli_si128(lineSum, 8)));
+            words += static_cast<uint64_t>(_mm_cvtsi128_si32(wordSum)) +
+                     static_cast<uint64_t>(_mm_cvtsi128_si32(_mm_srli_si128(wordSum, 8)));
+        }
+        carry = (_mm_movemask_epi8(previous) & 0x8000) != 0;
+#endif
+
+        for (; i < len; ++i) {
+            bool space = isSpace(data[i]);
+            lines += data[i] == '\n';
+            words += !space && carry;
+            carry = space;
+        }
+    }
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// 字节串查找器
+// 用 SIMD 同时比较候选位置的首字节和末字节，两者都命中的位置再用 memcmp 校验
+class LiteralMatcher {
+public:
+    explicit LiteralMatcher(std::string pattern) : needle(std::move(pattern)) {}
+
+    size_t length() const { return needle.size(); }
+
+    // 在 [begin, end) 中查找首次出现的位置，未找到返回 end
+    const uint8_t* find(const uint8_t* begin, const uint8_t* end) const {
+        const size_t n = needle.size();
+        if (n == 0) return begin;
+        if (static_cast<size_t>(end - begin) < n) return end;
+
+        const uint8_t* pat = reinterpret_cast<const uint8_t*>(needle.data());
+        if (n == 1) {
+            const void* hit = std::memchr(begin, pat[0], static_cast<size_t>(end - begin));
+            return hit ? static_cast<const uint8_t*>(hit) : end;
+        }
+
+        const uint8_t first = pat[0];
+        const uint8_t last = pat[n - 1];
+        const uint8_t* p = begin;
+        const uint8_t* limit = end - n + 1; // 最后一个可能的起始位置之后
+
+#if defined(__SSE2__)
+        const __m128i vFirst = _mm_set1_epi8(static_cast<char>(first));
+        const __m128i vLast = _mm_set1_epi8(static_cast<char>(last));
+        while (limit - p >= 16) {
+            __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + n - 1));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(blockFirst, vFirst), _mm_cmpeq_epi8(blockLast, vLast))));
+            while (mask != 0) {
+                int bit = __builtin_ctz(mask);
+                if (std::memcmp(p + bit + 1, pat + 1, n - 2) == 0) return p + bit;
+                mask &= mask - 1;
+            }
+            p += 16;
+        }
+#endif
+
+        while (p < limit) {
+            const void* hit = std::memchr(p, first, static_cast<size_t>(limit - p));
+            if (!hit) return end;
+            p = static_cast<const uint8_t*>(hit);
+            if (p[n - 1] == last && std::memcmp(p + 1, pat + 1, n - 2) == 0) return p;
+            ++p;
+        }
+        return end;
+    }
+
+private:
+    std::string needle;
+};
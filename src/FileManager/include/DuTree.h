@@ -0,0 +1,53 @@
+#pragma once
+
+#include "models.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 目录占用树 (du --tree)
+// 一次遍历收集所有目录，再按前序编号自底向上汇总，结果常驻内存
+// 之后树内任意目录的总大小和子目录排行都可直接查询，不再访问磁盘
+class DuTree {
+public:
+    static constexpr uint32_t kNoNode = UINT32_MAX;
+
+    struct Node {
+        uint32_t parent;        // 父目录节点，根节点为 kNoNode
+        uint32_t nameOffset;    // 名称在字符串池中的位置
+        uint32_t nameLen;
+        uint32_t childBegin;    // 子目录在 childIndex 中的起始位置
+        uint32_t childCount;
+        uint64_t ownSize;       // 直接包含的文件大小
+        uint64_t totalSize;     // 含所有子孙的文件总大小
+        uint64_t fileCount;     // 子孙文件总数
+    };
+
+    // 构建占用树
+    // [In] root: 根目录 (规范化的绝对路径)
+    // [In] walkOptions: 剪枝选项，被排除的条目不计入
+    // 返回 0、打开根目录失败时的 errno，或排除规则无效时的 EINVAL
+    int build(const Path& root, const WalkOptions& walkOptions = {});
+
+    // 查找目录对应的节点，不在树内返回 kNoNode
+    // [In] dirPath: 规范化的绝对路径
+    uint32_t find(const Path& dirPath) const;
+
+    const Path& rootPath() const { return root; }
+    const WalkOptions& walkOptions() const { return options; }
+    const Node& node(uint32_t index) const { return nodes[index]; }
+    std::string_view name(uint32_t index) const;
+
+    // 某节点的直接子目录节点 (按名称有序)
+    std::vector<uint32_t> children(uint32_t index) const;
+
+private:
+    Path root;
+    WalkOptions options; // 构建时的剪枝选项，选项不同的查询不能复用
+    std::vector<Node> nodes;
+    std::vector<uint32_t> childIndex;
+    std::string namePool;
+
+    uint32_t findChild(uint32_t parent, std::string_view childName) const;
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <sys/stat.h>
+
+// 在两个文件描述符之间复制 length 字节
+// 优先使用 copy_file_range (同文件系统可走 reflink / 服务端复制)，
+// 不支持时退回 sendfile，再退回 read / write
+// [In] inOffset: 非空时从该偏移读取并更新它，不改变 inFd 的文件位置，可多线程共用同一个 inFd
+// 返回 0 或失败时的 errno
+int copyFileData(int inFd, int outFd, uint64_t length, off_t* inOffset = nullptr);
+
+// 复制单个普通文件，目标已存在时截断覆盖
+// 复制完成后同步权限位和修改时间，便于增量同步判断是否变化
+// [In] srcPath: 源文件
+// [In] dstPath: 目标文件
+// 返回 0 或失败时的 errno
+int copyRegularFile(const std::string& srcPath, const std::string& dstPath);
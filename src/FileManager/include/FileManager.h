@@ -3,23 +3,49 @@
 #include "status.h"
 #include "models.h"
 #include <filesystem>
+#include <functional>
+#include <memory>
+#include <string_view>
 #include <vector>
 
 using Path = std::filesystem::path;
 
+class DuTree;
+class NameIndex;
+class TrashManager;
+
 class FileManager {
 
 private:
+    struct SharedCaches;
+
     std::filesystem::path currentPath;
+    std::shared_ptr<SharedCaches> caches; // 目录占用树等缓存，服务模式下各会话共享
+    std::shared_ptr<TrashManager> trash;  // 回收站及其后台清理线程，服务模式下各会话共享
+    std::vector<std::string> trashHistory; // 本会话移入回收站的条目 id，供 undo 使用
 
     // 辅助函数
-    uintmax_t calculateDirTotalSize(const Path& dirPath) const;
+    uintmax_t calculateDirTotalSize(const Path& dirPath, const WalkOptions& options = {}) const;
     bool pathExists(const Path& targetPath) const;
     std::string fileTimeToString(const std::filesystem::file_time_type& fileTime) const;
+    Path resolvePath(const Path& targetPath) const;
+    void invalidateCaches(const Path& changedPath);
+    std::shared_ptr<const DuTree> loadDuTree() const;
+    bool askConfirm(const std::string& question) const;
 
 public:
+    // 删除、覆盖前的确认回调，返回 true 表示确认
+    // 为空时在标准输入输出上询问 (y/n)
+    std::function<bool(const std::string& question)> confirm;
+
+    // 持续运行的命令 (tail -f) 在该描述符可读或挂断时结束
+    // 为 -1 时改为由 Ctrl-C (SIGINT) 结束；服务模式下为会话的连接
+    int cancelFd = -1;
+
     // 构造函数
     FileManager(const std::string& initPath = "");
+    // 与 other 共享缓存的实例，工作目录独立 (服务模式下每个会话一个)
+    FileManager(const std::string& initPath, const FileManager& other);
     // 析构函数
     ~FileManager();
 
@@ -38,6 +64,12 @@ public:
     // [In]  sortMode: 排序方式
     // [Out] outFiles: 传出文件列表
     Status listFiles(SortMode sortMode, std::vector<FileInfo>& outFiles) const;
+    // 只获取指定的元数据：只要名称 / 类型 / inode 时只读取目录项，不做任何 stat
+    // 排序所需的字段 (按大小排序时的大小和目录总大小、按时间排序时的修改时间) 会自动加入
+    // [In]  sortMode: 排序方式
+    // [In]  fields: 需要的字段，FileField 按位组合
+    // [Out] outFiles: 传出文件列表，未获取的字段为默认值
+    Status listFiles(SortMode sortMode, uint32_t fields, std::vector<FileInfo>& outFiles) const;
 
 
     // 获取当前工作目录下指定名称文件 / 文件夹的详细信息
@@ -51,6 +83,24 @@ public:
     // [Out] outSize: 传出总字节数
     Status calculateDirSize(const Path& dirPath, uintmax_t& outSize) const;
 
+    // 计算文件夹大小，跳过被排除的子树
+    // [In]  dirPath: 文件夹路径
+    // [In]  options: 剪枝选项
+    // [Out] outSize: 传出总字节数
+    Status calculateDirSize(const Path& dirPath, const WalkOptions& options, uintmax_t& outSize) const;
+
+
+    // 目录占用树
+    // 一次遍历汇总所有子目录大小并缓存，之后树内的 du / ls -s 直接查询，不再访问磁盘
+    // 增删改操作会丢弃受影响的缓存
+    // [In]  dirPath: 目标目录，已在缓存树内时直接查询
+    // [In]  rescan: 为 true 时强制重新遍历
+    // [In]  options: 剪枝选项，只复用以相同选项构建的缓存
+    // [Out] outRoot: 目标目录汇总
+    // [Out] outChildren: 直接子目录汇总，按大小降序
+    Status diskUsageTree(const Path& dirPath, bool rescan, const WalkOptions& options, DiskUsageEntry& outRoot,
+                         std::vector<DiskUsageEntry>& outChildren);
+
 
     // 创建文件
     // 在当前工作目录创建文件
@@ -101,4 +151,216 @@ public:
     // [In]  keyword: 文件名关键词
     // [Out] outResults: 传出匹配的文件列表
     Status search(const Path& dirPath, const std::string& keyword, std::vector<FileInfo>& outResults) const;
+    // 按指定匹配方式 (子串 / glob / 正则) 搜索，模式只编译一次
+    // [In]  dirPath: 目标目录
+    // [In]  options: 搜索条件
+    // [Out] outResults: 传出匹配的文件列表
+    Status search(const Path& dirPath, const SearchOptions& options, std::vector<FileInfo>& outResults) const;
+
+    // 为增量搜索 (isearch) 构建名称索引，之后每次按键只在索引中筛选，不再遍历目录
+    // [In]  dirPath: 目标目录，为空时使用当前工作目录
+    // [In]  options: 剪枝选项
+    // [Out] outIndex: 传出索引
+    Status buildNameIndex(const Path& dirPath, const WalkOptions& options, NameIndex& outIndex) const;
+
+
+    // 一次遍历统计目录树中文件按扩展名、大小区间、修改时间区间的分布 (analyze 命令)
+    // 多线程遍历，每个线程累加到自己的计数器，遍历结束后再合并，遍历中不加锁
+    // [In]  dirPath: 目标目录，为空时使用当前工作目录
+    // [In]  options: 剪枝选项
+    // [Out] outAnalysis: 传出统计结果
+    Status analyzeTree(const Path& dirPath, const WalkOptions& options, TreeAnalysis& outAnalysis) const;
+
+
+    // 找出目录树中最大 / 最旧的 count 个普通文件 (top 命令)
+    // 多线程遍历，每个线程维护容量为 count 的堆，遍历结束后合并，内存占用只与 count 有关
+    // [In]  dirPath: 目标目录，为空时使用当前工作目录
+    // [In]  options: 排序依据、结果数与剪枝选项
+    // [Out] outFiles: 传出结果，最大 / 最旧的在前
+    Status topFiles(const Path& dirPath, const TopOptions& options, std::vector<FileInfo>& outFiles) const;
+
+
+    // 比较两个文件或两个目录树的内容 (cmp 命令)
+    // 先比较大小，大小相同时以 pread 分窗口读取 (不映射) 逐块比较，遇到第一个不同的字节即停止；大文件切块并行比较
+    // 目录树按名称同步遍历两侧，文件内容由工作线程并行比较
+    // [In]  first: 第一个文件或目录
+    // [In]  second: 第二个文件或目录
+    // [Out] outDifferences: 传出差异，按路径排序，为空表示完全相同
+    Status compare(const Path& first, const Path& second, std::vector<FileDifference>& outDifferences) const;
+
+
+    // 统计文件或目录树中各文件在页缓存中的驻留页数 (cache status)
+    // 以只读方式映射各文件并用 mincore 查询，不会读入任何页；多线程遍历
+    // [In]  targetPath: 文件或目录
+    // [In]  options: 剪枝选项
+    // [Out] outFiles: 传出各文件的驻留情况，按路径排序
+    // [Out] outTotal: 传出合计
+    Status cacheStatus(const Path& targetPath, const WalkOptions& options,
+                       std::vector<CacheResidency>& outFiles, CacheResidency& outTotal) const;
+
+    // 预读文件或目录树进页缓存，或将其从页缓存中丢弃 (cache warm / cache drop)
+    // Warm 多线程分块 readahead 并读取，返回时数据已在页缓存中，受 throttle 限制；Drop 使用 posix_fadvise(DONTNEED)，脏页不会被丢弃
+    // [In]  targetPath: 文件或目录
+    // [In]  action: 预读或丢弃
+    // [In]  options: 剪枝选项
+    // [Out] outTotal: 传出处理的文件数、字节数与页数
+    Status adviseCache(const Path& targetPath, CacheAction action, const WalkOptions& options,
+                       CacheResidency& outTotal) const;
+
+
+    // 查找重复文件
+    // 依次按大小、首尾块哈希、全文哈希分组缩小候选，哈希阶段并行执行
+    // 同一 inode 的硬链接视为同一文件，不计为重复
+    // [In]  dirPath: 目标目录，为空时使用当前工作目录
+    // [Out] outGroups: 传出重复文件分组，按可回收字节数降序
+    Status findDuplicates(const Path& dirPath, std::vector<DuplicateGroup>& outGroups) const;
+
+
+    // 搜索文件内容
+    // 多线程并行处理文件，文件以 read 分块读取 (不映射，读取期间被截断也不会触发 SIGBUS)，二进制文件直接跳过
+    // 同一文件的命中按行号顺序连续回调，回调在内部锁保护下串行执行
+    // [In]  targetPath: 目标目录或单个文件
+    // [In]  pattern: 要查找的字节串 (区分大小写)
+    // [In]  onMatch: 每条命中行的回调
+    // [Out] outMatchCount: 传出命中行总数
+    Status grep(const Path& targetPath, const std::string& pattern,
+                const std::function<void(const GrepMatch&)>& onMatch, uintmax_t& outMatchCount) const;
+
+
+    // 批量重命名目录中的条目 (rename 命令)
+    // 先为所有匹配的条目生成计划并检查冲突 (多个条目重名、与未参与重命名的条目重名)，
+    // 有冲突时什么也不做；链式和循环重命名 (a->b, b->a) 按依赖排序，循环经临时名称完成
+    // 执行时每项为一次相对目录描述符的 renameat2(RENAME_NOREPLACE)，中途失败则撤销已完成的部分
+    // [In]  dirPath: 目标目录，为空时使用当前工作目录 (不递归)
+    // [In]  options: 匹配与替换规则
+    // [Out] outItems: 传出重命名计划，按原名排序
+    Status batchRename(const Path& dirPath, const RenameOptions& options, std::vector<RenameItem>& outItems);
+
+
+    // 统计行数、单词数和字节数 (wc 命令)
+    // 文件以 pread 分窗口读取 (不映射) 后用 SIMD 计数；大文件切块由多个线程并行统计，目录中的文件由遍历线程分发给工作线程
+    // 目录中无法读取的文件被跳过
+    // [In]  targetPath: 文件，或目录 (统计其中所有文件)
+    // [Out] outFiles: 传出每个文件的统计，按路径排序
+    // [Out] outTotal: 传出合计
+    Status wordCount(const Path& targetPath, std::vector<WordCount>& outFiles, WordCount& outTotal) const;
+
+
+    // 保存目录树快照
+    // 记录每个条目的相对路径、类型、大小、修改时间和 inode，按路径排序写成可内存映射的二进制文件
+    // [In]  dirPath: 目标目录，为空时使用当前工作目录
+    // [In]  snapshotFile: 输出文件
+    // [Out] outEntries: 传出条目数
+    Status saveSnapshot(const Path& dirPath, const Path& snapshotFile, uintmax_t& outEntries);
+
+
+    // 比较两个快照
+    // 两个快照均通过 mmap 加载并线性归并，耗时与条目数成正比
+    // [In]  beforeFile: 旧快照
+    // [In]  afterFile: 新快照
+    // [Out] outChanges: 传出新增 / 删除 / 修改 / 移动的条目，按路径排序
+    Status diffSnapshots(const Path& beforeFile, const Path& afterFile, std::vector<SnapshotChange>& outChanges) const;
+
+
+    // 增量同步
+    // 并行遍历源与目标两棵树，按大小和修改时间 (可选逐字节比较) 找出变化的文件
+    // 比较线程边比较边把复制任务交给复制线程，只复制新增或变化的文件
+    // [In]  src: 源目录
+    // [In]  dst: 目标目录，不存在时创建
+    // [In]  options: 同步选项
+    // [Out] outReport: 传出同步结果
+    Status syncTree(const Path& src, const Path& dst, const SyncOptions& options, SyncReport& outReport);
+
+
+    // 将目录树打包为 tar (ustar，超长路径使用 GNU 扩展)
+    // 遍历线程读取小文件、为大文件预读，写线程同时写出归档，内存占用与树的规模无关
+    // [In]  dirPath: 要打包的目录
+    // [In]  archiveFile: 输出的 tar 文件
+    // [Out] outReport: 传出条目数、数据量和被跳过的条目
+    Status packTree(const Path& dirPath, const Path& archiveFile, ArchiveReport& outReport);
+
+
+    // 解开 tar 归档
+    // 先校验全部头部并创建目录，再并行写出各个文件，最后创建链接
+    // 所有写入都相对目标目录逐级解析，不经过任何符号链接，条目无法写到目标目录之外
+    // [In]  archiveFile: tar 文件
+    // [In]  destDir: 目标目录，为空时使用当前工作目录
+    // [Out] outReport: 传出条目数、数据量和失败的条目
+    Status unpackArchive(const Path& archiveFile, const Path& destDir, ArchiveReport& outReport);
+
+
+    // 输出文件开头的若干行 (head 命令)
+    // 只读取到第 lineCount 个换行符为止，与文件大小无关
+    // [In]  filePath: 文件路径
+    // [In]  lineCount: 行数
+    // [In]  onData: 输出回调，内容分块传出，返回 false 时停止
+    Status headFile(const Path& filePath, size_t lineCount,
+                    const std::function<bool(std::string_view)>& onData) const;
+
+    // 输出文件末尾的若干行 (tail 命令)
+    // 从文件末尾按块向前查找换行符，只读取输出的部分
+    // [In]  filePath: 文件路径
+    // [In]  lineCount: 行数
+    // [In]  onData: 输出回调，内容分块传出，返回 false 时停止
+    // [Out] outEndOffset: 传出已输出到的位置，可作为 followFile 的起点
+    Status tailFile(const Path& filePath, size_t lineCount,
+                    const std::function<bool(std::string_view)>& onData, uintmax_t& outEndOffset) const;
+
+    // 持续输出文件新追加的内容 (tail -f)
+    // 由 inotify 驱动，不轮询；文件被截断时从头输出，被轮转 (移走或删除后重建) 时打开新文件
+    // 回调返回 false、cancelFd 可读或收到 Ctrl-C 时返回
+    // [In]  filePath: 文件路径
+    // [In]  offset: 起始位置
+    // [In]  onData: 输出回调
+    Status followFile(const Path& filePath, uintmax_t offset,
+                      const std::function<bool(std::string_view)>& onData) const;
+
+    // 读取一页文本 (view 命令)
+    // [In]  filePath: 文件路径
+    // [In]  offset: 起始字节偏移
+    // [In]  lineCount: 最多读取的行数
+    // [In]  alignToLine: offset 不在行首时前进到下一行行首
+    // [Out] outPage: 传出该页
+    Status readPage(const Path& filePath, uintmax_t offset, size_t lineCount, bool alignToLine,
+                    TextPage& outPage) const;
+
+    // 查找第 lineNumber 行的起始偏移，需要从头扫描
+    // [In]  filePath: 文件路径
+    // [In]  lineNumber: 行号，从 1 开始
+    // [Out] outOffset: 传出该行起始的字节偏移
+    Status findLine(const Path& filePath, uintmax_t lineNumber, uintmax_t& outOffset) const;
+
+
+    // 设置 I/O 限制 (throttle 命令)
+    // 限制作用于整个进程的遍历和复制，对正在执行的命令立即生效
+    // [In] limits: 新的限制，0 表示不限制
+    Status setIoLimits(const IoLimits& limits);
+
+    // 获取当前的 I/O 限制
+    // [Out] outLimits: 传出当前限制
+    Status getIoLimits(IoLimits& outLimits) const;
+
+
+    // 移入回收站 (rm 命令)
+    // 只做一次 rename，与目标大小无关；后台线程在保留期过后按限速清除
+    // [In]  targetPath: 文件、目录或链接
+    // [Out] outEntry: 传出回收站条目
+    Status trashPath(const Path& targetPath, TrashEntry& outEntry);
+
+    // 恢复本会话最近一次移入回收站的条目 (undo 命令)
+    // [Out] outEntry: 传出恢复的条目
+    Status undoRemove(TrashEntry& outEntry);
+
+    // 恢复回收站中的条目
+    // [In]  item: 条目 id，或删除前的路径 (多次删除同一路径时恢复最近的一次)
+    // [Out] outEntry: 传出恢复的条目
+    Status restoreTrash(const std::string& item, TrashEntry& outEntry);
+
+    // 列出回收站中尚未清除的条目
+    // [Out] outEntries: 传出条目，按删除时间升序
+    Status listTrash(std::vector<TrashEntry>& outEntries) const;
+
+    // 清空回收站，删除在后台进行
+    // [Out] outCount: 传出将被清除的条目数
+    Status emptyTrash(uintmax_t& outCount);
 };
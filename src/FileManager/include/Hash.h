@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// 128 位内容摘要
+struct HashDigest {
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+
+    bool operator==(const HashDigest& other) const { return lo == other.lo && hi == other.hi; }
+    bool operator<(const HashDigest& other) const { return lo != other.lo ? lo < other.lo : hi < other.hi; }
+};
+
+// 流式非加密哈希，两路不同种子的 XXH64 拼成 128 位
+// 仅用于内容比对，不用于安全场景
+class ContentHasher {
+public:
+    ContentHasher() { reset(); }
+
+    void reset() {
+        lanes[0].reset(0x9E3779B97F4A7C15ULL);
+        lanes[1].reset(0xC2B2AE3D27D4EB4FULL);
+        total = 0;
+        bufferLen = 0;
+    }
+
+    void update(const void* data, size_t len) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        total += len;
+
+        // 先补齐上次残留的不完整条带
+        if (bufferLen > 0) {
+            size_t take = std::min(len, sizeof(buffer) - bufferLen);
+            std::memcpy(buffer + bufferLen, p, take);
+            bufferLen += take;
+            p += take;
+            len -= take;
+            if (bufferLen < sizeof(buffer)) return;
+            consumeStripe(buffer);
+            bufferLen = 0;
+        }
+
+        while (len >= sizeof(buffer)) {
+            consumeStripe(p);
+            p += sizeof(buffer);
+            len -= sizeof(buffer);
+        }
+
+        if (len > 0) {
+            std::memcpy(buffer, p, len);
+            bufferLen = len;
+        }
+    }
+
+    HashDigest digest() const {
+        return {lanes[0].finish(total, buffer, bufferLen), lanes[1].finish(total, buffer, bufferLen)};
+    }
+
+private:
+    static constexpr uint64_t P1 = 11400714785074694791ULL;
+    static constexpr uint64_t P2 = 14029467366897019727ULL;
+    static constexpr uint64_t P3 = 1609587929392839161ULL;
+    static constexpr uint64_t P4 = 9650029242287828579ULL;
+    static constexpr uint64_t P5 = 2870177450012600261ULL;
+
+    static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+    static uint64_t read64(const uint8_t* p) {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static uint32_t read32(const uint8_t* p) {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static uint64_t round(uint64_t acc, uint64_t input) {
+        acc += input * P2;
+        acc = rotl(acc, 31);
+        return acc * P1;
+    }
+
+    static uint64_t mergeRound(uint64_t acc, uint64_t val) {
+        acc ^= round(0, val);
+        return acc * P1 + P4;
+    }
+
+    struct Lane {
+        uint64_t seed;
+        uint64_t v[4];
+
+        void reset(uint64_t s) {
+            seed = s;
+            v[0] = s + P1 + P2;
+            v[1] = s + P2;
+            v[2] = s;
+            v[3] = s - P1;
+        }
+
+        void stripe(const uint8_t* p) {
+            v[0] = round(v[0], read64(p));
+            v[1] = round(v[1], read64(p + 8));
+            v[2] = round(v[2], read64(p + 16));
+            v[3] = round(v[3], read64(p + 24));
+        }
+
+        uint64_t finish(uint64_t totalLen, const uint8_t* tail, size_t tailLen) const {
+            uint64_t h;
+            if (totalLen >= 32) {
+                h = rotl(v[0], 1) + rotl(v[1], 7) + rotl(v[2], 12) + rotl(v[3], 18);
+                for (uint64_t lane : v) h = mergeRound(h, lane);
+            } else {
+                h = seed + P5;
+            }
+            h += totalLen;
+
+            const uint8_t* p = tail;
+            const uint8_t* end = tail + tailLen;
+            for (; p + 8 <= end; p += 8) {
+                h ^= round(0, read64(p));
+                h = rotl(h, 27) * P1 + P4;
+            }
+            if (p + 4 <= end) {
+                h ^= static_cast<uint64_t>(read32(p)) * P1;
+                h = rotl(h, 23) * P2 + P3;
+                p += 4;
+            }
+            for (; p < end; ++p) {
+                h ^= static_cast<uint64_t>(*p) * P5;
+                h = rotl(h, 11) * P1;
+            }
+
+            h ^= h >> 33;
+            h *= P2;
+            h ^= h >> 29;
+            h *= P3;
+            h ^= h >> 32;
+            return h;
+        }
+    };
+
+    void consumeStripe(const uint8_t* p) {
+        lanes[0].stripe(p);
+        lanes[1].stripe(p);
+    }
+
+    Lane lanes[2];
+    uint64_t total;
+    uint8_t buffer[32];
+    size_t bufferLen;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "status.h"
+#include "NameMatcher.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+// gitignore 语法的忽略规则集合，用于遍历时剪枝
+// 支持的写法：
+//   *.o / node_modules     不含 '/'，匹配任意层级的文件名
+//   build/                 结尾 '/'，只匹配目录
+//   /out, docs/*.pdf       含 '/'，相对规则所在目录匹配路径，* 不跨越 '/'
+//   **/x, a/**, a/**/b     ** 匹配任意层目录
+//   !keep.log              取反，重新包含之前被忽略的条目
+// 规则按添加顺序求值，后添加的优先 (与 git 相同：深层 .gitignore 覆盖浅层)
+class IgnoreRules {
+public:
+    // 添加一条规则
+    // [In] line: 规则文本，空行和 # 开头的注释被忽略
+    // [In] baseLen: 规则所在目录相对遍历根目录的路径长度，根目录为 0
+    Status add(std::string_view line, size_t baseLen = 0);
+
+    // 读取目录下的 .gitignore 并添加其中的规则，文件不存在时什么也不做
+    // 无法解析的行被跳过
+    // [In] dirFd: 目录的文件描述符
+    // [In] baseLen: 该目录相对遍历根目录的路径长度
+    void loadGitignore(int dirFd, size_t baseLen);
+
+    // 判断条目是否被忽略
+    // [In] relPath: 相对遍历根目录的路径 (不以 '/' 开头)
+    // [In] name: 文件名
+    // [In] isDir: 是否为目录
+    bool ignored(std::string_view relPath, std::string_view name, bool isDir) const;
+
+    bool empty() const { return rules.empty(); }
+    size_t size() const { return rules.size(); }
+
+    // 丢弃 count 之后添加的规则 (离开目录时撤销其 .gitignore)
+    void truncate(size_t count) { rules.resize(count); }
+
+    // 在末尾追加另一组规则 (子目录的 .gitignore)，追加的规则优先
+    void append(const IgnoreRules& other) { rules.insert(rules.end(), other.rules.begin(), other.rules.end()); }
+
+private:
+    struct Rule {
+        NameMatcher nameMatcher; // 文件名规则
+        std::string pathPattern; // 路径规则 (fnmatch 模式)
+        size_t baseLen;
+        bool pathRule;
+        bool negate;
+        bool dirOnly;
+    };
+
+    std::vector<Rule> rules;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "models.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+// 进程内共享的 I/O 限流器
+// 遍历器和复制引擎在每次 I/O 前调用 acquire()，限制可随时修改并对正在运行的命令立即生效
+// 速率限制以 "下一个可用时刻" 的原子变量实现 (GCRA)，未设置任何限制时 acquire() 只有几次原子读
+class IoThrottle {
+public:
+    static IoThrottle& instance();
+
+    void setLimits(const IoLimits& limits);
+    IoLimits limits() const;
+
+    // 限速时单次 I/O 的建议上限 (约 100ms 的配额)，使等待均匀分布且能及时响应限制的修改
+    // 未限速时返回 UINT64_MAX
+    uint64_t maxChunk() const {
+        uint64_t rate = bytesPerSecond.load(std::memory_order_relaxed);
+        return rate == 0 ? UINT64_MAX : std::max<uint64_t>(rate / 10, kMinChunk);
+    }
+
+    // 一次 I/O 之前调用，必要时休眠到配额可用，并对当前线程应用 I/O 优先级
+    // [In] bytes: 本次操作的数据量，无数据的操作 (stat、打开目录) 为 0
+    void acquire(uint64_t bytes = 0);
+
+    // 限制同时进行的 I/O 操作数，构造时占用一个名额，析构时归还
+    class Slot {
+    public:
+        explicit Slot(IoThrottle& throttle);
+        ~Slot();
+        Slot(const Slot&) = delete;
+        Slot& operator=(const Slot&) = delete;
+
+    private:
+        IoThrottle& throttle;
+        bool held = false;
+    };
+
+private:
+    IoThrottle() = default;
+
+    static constexpr uint64_t kMinChunk = 4096;
+
+    void applyPriority();
+    static void waitFor(std::atomic<int64_t>& nextFree, uint64_t costNs);
+
+    std::atomic<uint64_t> bytesPerSecond{0};
+    std::atomic<uint64_t> opsPerSecond{0};
+    std::atomic<unsigned> maxInFlight{0};
+    std::atomic<bool> idlePriority{false};
+    std::atomic<uint32_t> priorityGeneration{0}; // 优先级变化时递增，各线程据此重新设置
+
+    std::atomic<int64_t> nextByteSlot{0}; // 字节配额下一个可用时刻 (steady_clock 纳秒)
+    std::atomic<int64_t> nextOpSlot{0};
+
+    std::mutex inFlightMutex;
+    std::condition_variable inFlightFreed;
+    unsigned inFlight = 0;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 只读内存映射文件 (RAII)
+// 空文件不建立映射，data() 返回 nullptr 且 size() 为 0
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // 打开并映射整个文件
+    // [In] path: 文件路径
+    // 返回 0 或失败时的 errno
+    int open(const std::string& path);
+
+    // 映射已打开的普通文件，接管 fd (失败时也会将其关闭)
+    // [In] fd: 只读打开的文件描述符
+    // [In] size: 文件大小 (调用方已 fstat)
+    // 返回 0 或失败时的 errno
+    int open(int fd, size_t size);
+
+    // 解除映射并关闭文件
+    void close();
+
+    // 对映射区域给出访问模式建议 (MADV_SEQUENTIAL 等)
+    void advise(int advice) const;
+
+    const uint8_t* data() const { return mapData; }
+    size_t size() const { return mapSize; }
+    int fd() const { return fileFd; }
+    bool isOpen() const { return fileFd >= 0; }
+
+private:
+    int fileFd = -1;
+    uint8_t* mapData = nullptr;
+    size_t mapSize = 0;
+};
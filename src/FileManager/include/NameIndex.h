@@ -0,0 +1,70 @@
+#pragma once
+
+#include "models.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 名称索引 (isearch)
+// 一次遍历收集树内所有条目的相对路径和小写名称，之后的查询只扫描内存中的字符串池
+// 小写名称以 '\0' 分隔连续存放，全量查询时整池做一次子串查找，不逐条调用
+class NameIndex {
+public:
+    struct Entry {
+        uint64_t pathOffset; // 相对路径在 paths 中的位置
+        uint64_t nameOffset; // 小写名称在 names 中的位置
+        uint32_t pathLen;
+        uint32_t nameLen;
+        FileType type;
+    };
+
+    // 构建索引，条目按相对路径排序
+    // [In] root: 根目录 (规范化的绝对路径)
+    // [In] walkOptions: 剪枝选项，被排除的条目不进入索引
+    // 返回 0、打开根目录失败时的 errno，或排除规则无效时的 EINVAL
+    int build(const Path& root, const WalkOptions& walkOptions = {});
+
+    const Path& rootPath() const { return root; }
+    size_t size() const { return entries.size(); }
+    const Entry& entry(uint32_t id) const { return entries[id]; }
+    std::string_view path(uint32_t id) const;
+
+    // 名称包含关键词 (不区分大小写) 的全部条目，按路径有序
+    // [In]  lowerKeyword: 已转小写的关键词，为空时返回全部条目
+    // [Out] outIds: 传出条目编号
+    void search(std::string_view lowerKeyword, std::vector<uint32_t>& outIds) const;
+
+    // 在上一次的结果中继续筛选，candidates 必须是某个被 lowerKeyword 包含的关键词的结果
+    // [In]  candidates: 上一次的结果
+    // [In]  lowerKeyword: 已转小写的关键词
+    // [Out] outIds: 传出条目编号，保持 candidates 的顺序
+    void narrow(const std::vector<uint32_t>& candidates, std::string_view lowerKeyword,
+                std::vector<uint32_t>& outIds) const;
+
+private:
+    Path root;
+    std::vector<Entry> entries;
+    std::string paths;
+    std::string names;
+};
+
+// 增量搜索：保存每个关键词的结果
+// 关键词变长时只在上一次的结果中筛选，删除字符时直接回退到之前保存的结果
+class IncrementalSearch {
+public:
+    explicit IncrementalSearch(const NameIndex& index) : index(index) {}
+
+    // 更新关键词并返回新的结果，引用在下一次 update 之前有效
+    // [In] keyword: 当前输入的完整关键词
+    const std::vector<uint32_t>& update(std::string_view keyword);
+
+private:
+    struct Level {
+        std::string keyword; // 已转小写
+        std::vector<uint32_t> ids;
+    };
+
+    const NameIndex& index;
+    std::vector<Level> levels; // 后一层的关键词包含前一层的关键词，结果是前一层的子集
+};
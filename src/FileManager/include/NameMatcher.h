@@ -0,0 +1,50 @@
+#pragma once
+
+#include "status.h"
+#include "models.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 文件名匹配器
+// 模式只编译一次：glob / 正则先转换为 NFA，再通过子集构造生成 DFA
+// matches() 只查表，不做任何堆分配，可被多个线程同时调用
+class NameMatcher {
+public:
+    NameMatcher() = default;
+
+    // 编译模式
+    // [In]  mode: 匹配方式
+    // [In]  pattern: 模式串
+    // [Out] outMatcher: 传出编译好的匹配器
+    static Status compile(MatchMode mode, const std::string& pattern, NameMatcher& outMatcher);
+
+    // 判断文件名是否匹配
+    bool matches(std::string_view name) const;
+
+private:
+    static constexpr uint32_t kDeadState = 0;
+
+    MatchMode mode = MatchMode::Substring;
+
+    // 子串模式：已转小写的关键词
+    std::string lowerKeyword;
+
+    // 快速排除：必须的前缀 / 后缀 / 子串
+    std::string prefix;
+    std::string suffix;
+    std::string required;
+    size_t minLength = 0;
+
+    // DFA：字节先映射为等价类，再查 transitions[state * classCount + class]
+    bool anchoredEnd = true;
+    std::array<uint8_t, 256> byteClass{};
+    uint32_t classCount = 0;
+    uint32_t startState = kDeadState;
+    std::vector<uint32_t> transitions;
+    std::vector<uint8_t> accepting;
+
+    friend class PatternCompiler;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "AllocTracker.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// 默认工作线程数：硬件并发数，至少为 1
+inline unsigned defaultThreadCount() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+// 并行执行 fn(index, worker)，index ∈ [0, count)，worker ∈ [0, threadCount)
+// 任务按原子计数器动态领取，适合耗时不均的 I/O 任务
+// worker 编号可用于索引每个线程独占的缓冲区
+template <typename Fn>
+void parallelFor(size_t count, Fn&& fn, unsigned threadCount = 0) {
+    if (count == 0) return;
+    if (threadCount == 0) threadCount = defaultThreadCount();
+    threadCount = static_cast<unsigned>(std::min<size_t>(threadCount, count));
+
+    std::atomic<size_t> next{0};
+    const AllocCategory category = AllocScope::current(); // 工作线程的分配记入调用方的分类
+    auto worker = [&](unsigned workerId) {
+        AllocScope scope(category);
+        for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < count;
+             i = next.fetch_add(1, std::memory_order_relaxed)) {
+            fn(i, workerId);
+        }
+    };
+
+    if (threadCount == 1) {
+        worker(0);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (unsigned t = 1; t < threadCount; ++t) {
+        threads.emplace_back(worker, t);
+    }
+    worker(0);
+    for (auto& th : threads) th.join();
+}
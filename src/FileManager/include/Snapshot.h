@@ -0,0 +1,64 @@
+#pragma once
+
+#include "models.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// 目录树快照的二进制格式
+// [SnapshotHeader][根路径, 8 字节对齐][SnapshotRecord * entryCount][路径字符串池]
+// 记录按相对路径的字节序排列，可直接内存映射后归并比较
+struct SnapshotHeader {
+    char magic[8];         // "MFESNAP1"
+    uint32_t version;
+    uint32_t recordSize;   // sizeof(SnapshotRecord)，用于校验
+    uint64_t entryCount;
+    uint64_t stringBytes;
+    int64_t createdAt;     // 创建时间 (Unix 秒)
+    uint64_t rootLen;
+};
+
+struct SnapshotRecord {
+    uint64_t pathOffset;   // 相对路径在字符串池中的位置
+    uint32_t pathLen;
+    uint8_t type;          // FileType
+    uint8_t reserved[3];
+    uint64_t size;
+    int64_t mtimeNs;       // 修改时间 (Unix 纳秒)
+    uint64_t inode;
+    uint64_t dev;
+};
+
+// 只读快照，通过 mmap 加载，打开开销与条目数无关
+class SnapshotReader {
+public:
+    // 打开并校验快照文件
+    // [In] file: 快照文件路径
+    Status open(const std::string& file);
+
+    uint64_t size() const { return count; }
+    const SnapshotRecord& record(uint64_t index) const { return records[index]; }
+    std::string_view path(uint64_t index) const {
+        return std::string_view(strings + records[index].pathOffset, records[index].pathLen);
+    }
+    std::string_view root() const { return rootPath; }
+    int64_t createdAt() const { return created; }
+
+private:
+    MappedFile file;
+    const SnapshotRecord* records = nullptr;
+    const char* strings = nullptr;
+    uint64_t count = 0;
+    int64_t created = 0;
+    std::string_view rootPath;
+};
+
+// 遍历目录树并写出快照
+// [In] root: 根目录
+// [In] file: 输出文件，先写临时文件再原子替换
+// 返回写入的条目数
+Result<uint64_t> writeSnapshot(const Path& root, const std::string& file);
+
+// 归并比较两个快照，同一 (dev, inode) 从旧路径消失、在新路径出现视为移动
+void compareSnapshots(const SnapshotReader& before, const SnapshotReader& after, std::vector<SnapshotChange>& outChanges);
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+
+// 透明哈希：配合 std::equal_to<> 使 std::string 为键的哈希容器可直接用 string_view 查找，查找时不构造临时字符串
+struct StringHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view text) const { return std::hash<std::string_view>{}(text); }
+};
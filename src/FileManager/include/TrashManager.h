@@ -0,0 +1,69 @@
+#pragma once
+
+#include "status.h"
+#include "models.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/types.h>
+
+// 回收站
+// rm 把目标 rename 进同一文件系统上的回收站目录，耗时与目标大小无关
+// 后台线程按限速删除过期条目，删除前的条目都可以恢复
+//
+// 回收站目录布局 (每个文件系统一个)：
+//   files/<id>    被删除的条目本身
+//   info/<id>     删除时间和原路径
+//   purging/<id>  正在被后台线程删除的条目，不可再恢复
+// 优先使用 $HOME/.local/share/mfe-trash (与目标同一文件系统时)，否则使用挂载点下的 .mfe-trash-<uid>
+class TrashManager {
+public:
+    TrashManager();
+    ~TrashManager();
+
+    TrashManager(const TrashManager&) = delete;
+    TrashManager& operator=(const TrashManager&) = delete;
+
+    // 将条目移入回收站
+    // [In]  target: 绝对路径
+    // [Out] outEntry: 传出回收站条目
+    Status moveToTrash(const Path& target, TrashEntry& outEntry);
+
+    // 将条目移回原位置，原位置已存在同名条目时失败
+    // [In]  id: 回收站条目的 id
+    // [Out] outEntry: 传出恢复的条目
+    Status restore(const std::string& id, TrashEntry& outEntry);
+
+    // 列出所有已知回收站中尚未清除的条目，按删除时间升序
+    // [Out] outEntries: 传出条目
+    void list(std::vector<TrashEntry>& outEntries);
+
+    // 请求后台线程立即清除所有条目
+    // [Out] outCount: 传出将被清除的条目数
+    void purgeAll(uintmax_t& outCount);
+
+    // 条目在回收站中的保留时间，超过后由后台线程清除
+    static constexpr int64_t kRetentionSeconds = 24 * 3600;
+
+private:
+    // 与 target 同一文件系统、可用的回收站目录，按优先顺序
+    std::vector<Path> trashDirsFor(const Path& target);
+    void listDir(const Path& dir, std::vector<TrashEntry>& outEntries) const;
+    void purgeLoop();
+    void purgeDir(const Path& dir, bool all);
+
+    static constexpr unsigned kPurgeOpsPerSecond = 5000; // 后台删除的限速 (每秒 unlink 次数)
+
+    std::mutex mutex;                   // 保护 trashDirs 以及条目在 files / purging 之间的移动
+    std::condition_variable wakeUp;
+    std::map<dev_t, Path> trashDirs;    // 已使用过的回收站目录，按文件系统
+    uint64_t counter = 0;               // 生成唯一 id
+    bool purgeRequested = false;
+    std::atomic<bool> stopping{false};  // 析构时置位，正在进行的删除尽快中止
+    std::thread purger;                 // 首次使用回收站时启动
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "models.h"
+#include "IgnoreRules.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sys/stat.h>
+
+// 将 stat 中的时间戳转换为 file_time_type
+inline std::filesystem::file_time_type toFileTime(const struct timespec& ts) {
+    auto sysTime = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec)));
+    return std::chrono::file_clock::from_sys(sysTime);
+}
+
+// 遍历回调的返回值
+enum class WalkAction {
+    Continue, // 继续遍历 (目录则进入)
+    Skip,     // 不进入该目录
+    Stop      // 终止整个遍历
+};
+
+// 遍历过程中的单个条目
+// 仅在回调期间有效，path / name 指向遍历器内部复用的缓冲区
+class WalkEntry {
+public:
+    std::string_view path;  // 完整路径
+    std::string_view name;  // 文件名
+    FileType type;          // 类型 (来自 d_type，必要时才 lstat)
+    uint64_t inode;         // inode 编号 (来自 d_ino)
+    int depth;              // 相对根目录的深度，根目录的直接子项为 0
+    int dirFd;              // 所在目录的文件描述符
+
+    // 按需获取 lstat 信息，同一条目只调用一次系统调用
+    // 失败返回 nullptr
+    const struct stat* stat();
+
+private:
+    friend class TreeWalker;
+    friend class ParallelWalker;
+    struct stat statBuf;
+    bool statDone = false;
+    bool statOk = false;
+};
+
+// 基于 openat / readdir 的非递归目录遍历器
+// 不跟随符号链接，路径缓冲区在整个遍历中复用，单个条目不产生堆分配
+class TreeWalker {
+public:
+    using Visitor = std::function<WalkAction(WalkEntry& entry)>;
+    using ErrorHandler = std::function<void(std::string_view path, int err)>;
+
+    // 设置剪枝选项，被排除的条目不会传给回调，被排除的目录不会被打开
+    // [In] options: 排除规则、.gitignore、单一文件系统
+    // 排除规则无法解析时返回错误
+    Status setOptions(const WalkOptions& options);
+
+    // 遍历 root 下的所有条目 (不包含 root 自身)
+    // [In] root: 根目录
+    // [In] visit: 条目回调
+    // [In] onError: 无法打开子目录时的回调，可为空
+    // 返回 0 或打开根目录失败时的 errno
+    int walk(const Path& root, const Visitor& visit, const ErrorHandler& onError = nullptr);
+
+private:
+    IgnoreRules rules; // --exclude 规则，遍历中按目录叠加 .gitignore 规则
+    bool gitignore = false;
+    bool oneFileSystem = false;
+};
+
+// 一棵树的扁平列表，按相对路径排序 (sync / cmp 对比两棵树)
+struct TreeListing {
+    struct Entry {
+        uint64_t pathOffset;
+        uint32_t pathLen;
+        FileType type;
+        uint64_t size;
+        int64_t mtimeSec;
+    };
+
+    std::string pool;
+    std::vector<Entry> entries;
+    int err = 0; // 打开根目录失败时的 errno
+
+    std::string_view path(const Entry& e) const {
+        return std::string_view(pool).substr(e.pathOffset, e.pathLen);
+    }
+};
+
+// 遍历 root 生成扁平列表
+void listTree(const Path& root, TreeListing& out);
+
+// 多线程目录遍历器
+// 以目录为任务单位：工作线程各自领取一个目录读完，子目录放回共享队列由任意线程继续
+// 回调在多个线程上并发执行，并传入线程编号 [0, threadCount())，用于索引各线程独占的累加器，
+// 这样遍历中不需要为每个条目加锁；条目的回调顺序不确定
+// 与 TreeWalker 相同：不跟随符号链接，支持同样的剪枝选项
+class ParallelWalker {
+public:
+    using Visitor = std::function<WalkAction(WalkEntry& entry, unsigned worker)>;
+    using ErrorHandler = TreeWalker::ErrorHandler;
+
+    // [In] threads: 工作线程数，0 表示 defaultThreadCount()
+    explicit ParallelWalker(unsigned threads = 0);
+
+    unsigned threadCount() const { return threads; }
+
+    // 设置剪枝选项，语义与 TreeWalker::setOptions 相同
+    Status setOptions(const WalkOptions& options);
+
+    // 遍历 root 下的所有条目 (不包含 root 自身)
+    // 回调返回 Skip 时不进入该目录，返回 Stop 时所有线程尽快结束
+    // [In] root: 根目录
+    // [In] visit: 条目回调，可能被多个线程同时调用
+    // [In] onError: 无法打开子目录时的回调，可能被多个线程同时调用，可为空
+    // 返回 0 或打开根目录失败时的 errno
+    int walk(const Path& root, const Visitor& visit, const ErrorHandler& onError = nullptr);
+
+private:
+    unsigned threads;
+    std::shared_ptr<const IgnoreRules> rules; // --exclude 规则
+    bool gitignore = false;
+    bool oneFileSystem = false;
+};
@@ -0,0 +1,152 @@
+#include "FileManager.h"
+#include "AllocTracker.h"
+#include "TreeWalker.h"
+#include "StringHash.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <string_view>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 大小区间：0、<1K，之后每档 4 倍，最后一档为 >=4G
+constexpr const char* kSizeLabels[] = {
+    "0", "<1K", "1K-4K", "4K-16K", "16K-64K", "64K-256K", "256K-1M", "1M-4M",
+    "4M-16M", "16M-64M", "64M-256M", "256M-1G", "1G-4G", ">=4G"};
+constexpr size_t kSizeBuckets = std::size(kSizeLabels);
+
+// 修改时间区间的上界 (秒)
+constexpr int64_t kDay = 24 * 3600;
+constexpr int64_t kAgeLimits[] = {kDay, 7 * kDay, 30 * kDay, 90 * kDay, 365 * kDay, 3 * 365 * kDay};
+constexpr const char* kAgeLabels[] = {"<1d", "1-7d", "7-30d", "30-90d", "90d-1y", "1-3y", ">3y"};
+constexpr size_t kAgeBuckets = std::size(kAgeLabels);
+
+constexpr size_t kMaxExtensionLength = 16; // 更长的后缀视为没有扩展名
+constexpr std::string_view kNoExtension = "(none)";
+
+size_t sizeBucket(uintmax_t size) {
+    if (size == 0) return 0;
+    if (size < 1024) return 1;
+    size_t index = 2 + (static_cast<size_t>(std::bit_width(size)) - 11) / 2;
+    return std::min(index, kSizeBuckets - 1);
+}
+
+size_t ageBucket(int64_t ageSeconds) {
+    size_t index = 0;
+    while (index < std::size(kAgeLimits) && ageSeconds >= kAgeLimits[index]) ++index;
+    return index;
+}
+
+struct Counter {
+    uintmax_t files = 0;
+    uintmax_t bytes = 0;
+
+    void add(uintmax_t size) {
+        ++files;
+        bytes += size;
+    }
+    void merge(const Counter& other) {
+        files += other.files;
+        bytes += other.bytes;
+    }
+};
+
+// 查找已有的扩展名不分配内存
+using ExtensionMap = std::unordered_map<std::string, Counter, StringHash, std::equal_to<>>;
+
+// 每个遍历线程独占的累加器，按缓存行对齐避免线程间的伪共享
+struct alignas(64) Accumulator {
+    ExtensionMap byExtension;
+    std::array<Counter, kSizeBuckets> bySize{};
+    std::array<Counter, kAgeBuckets> byAge{};
+    uintmax_t dirs = 0;
+    std::string extension; // 小写扩展名的复用缓冲区
+};
+
+// 取小写扩展名 (含 '.')，没有扩展名时返回 kNoExtension
+// 以 '.' 开头且没有其他 '.' 的名称 (.bashrc) 视为没有扩展名
+std::string_view extensionOf(std::string_view name, std::string& buffer) {
+    size_t dot = name.rfind('.');
+    if (dot == std::string_view::npos || dot == 0 || dot + 1 == name.size() ||
+        name.size() - dot > kMaxExtensionLength) {
+        return kNoExtension;
+    }
+    buffer.assign(name.substr(dot));
+    for (char& c : buffer) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    return buffer;
+}
+
+} // namespace
+
+Status FileManager::analyzeTree(const Path& dirPath, const WalkOptions& options, TreeAnalysis& outAnalysis) const {
+    AllocScope resultScope(AllocCategory::Results);
+    outAnalysis = TreeAnalysis();
+    fs::path target = resolvePath(dirPath);
+
+    ParallelWalker walker;
+    Status status = walker.setOptions(options);
+    if (!status.ok()) return status;
+
+    const int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::vector<Accumulator> accumulators(walker.threadCount());
+
+    int err = walker.walk(target, [&](WalkEntry& entry, unsigned worker) {
+        Accumulator& acc = accumulators[worker];
+        if (entry.type == FileType::Directory) {
+            ++acc.dirs;
+            return WalkAction::Continue;
+        }
+        if (entry.type != FileType::File) return WalkAction::Continue;
+        const struct stat* st = entry.stat();
+        if (!st) return WalkAction::Continue;
+
+        uintmax_t size = static_cast<uintmax_t>(st->st_size);
+        std::string_view extension = extensionOf(entry.name, acc.extension);
+        auto it = acc.byExtension.find(extension);
+        if (it == acc.byExtension.end()) it = acc.byExtension.emplace(std::string(extension), Counter()).first;
+        it->second.add(size);
+        acc.bySize[sizeBucket(size)].add(size);
+        acc.byAge[ageBucket(now - static_cast<int64_t>(st->st_mtim.tv_sec))].add(size);
+        return WalkAction::Continue;
+    });
+    if (err != 0) {
+        return Status::SystemError(Status::codeFromErrno(err), "Cannot open directory", std::move(target), err);
+    }
+
+    // 合并各线程的结果
+    ExtensionMap byExtension;
+    std::array<Counter, kSizeBuckets> bySize{};
+    std::array<Counter, kAgeBuckets> byAge{};
+    for (auto& acc : accumulators) {
+        for (auto& [extension, counter] : acc.byExtension) byExtension[extension].merge(counter);
+        for (size_t i = 0; i < kSizeBuckets; ++i) bySize[i].merge(acc.bySize[i]);
+        for (size_t i = 0; i < kAgeBuckets; ++i) byAge[i].merge(acc.byAge[i]);
+        outAnalysis.dirs += acc.dirs;
+    }
+
+    outAnalysis.byExtension.reserve(byExtension.size());
+    for (auto& [extension, counter] : byExtension) {
+        outAnalysis.byExtension.push_back({extension, counter.files, counter.bytes});
+        outAnalysis.files += counter.files;
+        outAnalysis.bytes += counter.bytes;
+    }
+    std::sort(outAnalysis.byExtension.begin(), outAnalysis.byExtension.end(),
+              [](const HistogramBucket& a, const HistogramBucket& b) {
+                  if (a.bytes != b.bytes) return a.bytes > b.bytes;
+                  return a.label < b.label;
+              });
+    for (size_t i = 0; i < kSizeBuckets; ++i) {
+        if (bySize[i].files) outAnalysis.bySize.push_back({kSizeLabels[i], bySize[i].files, bySize[i].bytes});
+    }
+    for (size_t i = 0; i < kAgeBuckets; ++i) {
+        if (byAge[i].files) outAnalysis.byAge.push_back({kAgeLabels[i], byAge[i].files, byAge[i].bytes});
+    }
+    return Status::Success();
+}
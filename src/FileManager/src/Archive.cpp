@@ -0,0 +1,827 @@
+#include "FileManager.h"
+#include "TreeWalker.h"
+#include "WorkQueue.h"
+#include "Parallel.h"
+#include "FileCopy.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t kBlockSize = 512;
+constexpr size_t kInlineLimit = 64 * 1024;                 // 不超过该大小的文件由遍历线程直接读入内存
+constexpr size_t kWriteBufferSize = size_t(1) << 20;
+constexpr off_t kPrefetchBytes = off_t(8) << 20;           // 大文件提前预读的长度
+constexpr size_t kQueueCapacity = 256;                     // 限制流水线中的内存和打开的文件数
+constexpr unsigned kMaxExtractThreads = 8;
+constexpr uint64_t kMaxExtendedHeader = uint64_t(1) << 20; // 长路径 / pax 扩展头内容的上限
+constexpr char kLongLinkName[] = "././@LongLink";
+
+// ustar 头部
+struct TarHeader {
+    char name[100];
+    char mode[8];
+    char uid[8];
+    char gid[8];
+    char size[12];
+    char mtime[12];
+    char checksum[8];
+    char typeflag;
+    char linkname[100];
+    char magic[6];
+    char version[2];
+    char uname[32];
+    char gname[32];
+    char devmajor[8];
+    char devminor[8];
+    char prefix[155];
+    char padding[12];
+};
+static_assert(sizeof(TarHeader) == kBlockSize, "tar header must be one block");
+
+uint64_t roundUpBlock(uint64_t n) {
+    return (n + kBlockSize - 1) & ~uint64_t(kBlockSize - 1);
+}
+
+// 写入定长八进制字段 (末尾为 NUL)，放不下时使用 GNU 的 base-256 编码
+void putNumber(char* field, size_t width, uint64_t value) {
+    if (value < (uint64_t(1) << (3 * (width - 1)))) {
+        field[width - 1] = '\0';
+        for (size_t i = width - 1; i-- > 0;) {
+            field[i] = static_cast<char>('0' + (value & 7));
+            value >>= 3;
+        }
+        return;
+    }
+    std::memset(field, 0, width);
+    for (size_t i = width; i-- > 1 && value != 0;) {
+        field[i] = static_cast<char>(value & 0xff);
+        value >>= 8;
+    }
+    field[0] = static_cast<char>(0x80);
+}
+
+bool parseNumber(const char* field, size_t width, uint64_t& out) {
+    out = 0;
+    if (static_cast<unsigned char>(field[0]) & 0x80) {
+        out = static_cast<unsigned char>(field[0]) & 0x7f;
+        for (size_t i = 1; i < width; ++i) {
+            if (out >> 56) return false;
+            out = (out << 8) | static_cast<unsigned char>(field[i]);
+        }
+        return true;
+    }
+    size_t i = 0;
+    while (i < width && field[i] == ' ') ++i;
+    for (; i < width && field[i] != '\0' && field[i] != ' '; ++i) {
+        if (field[i] < '0' || field[i] > '7' || (out >> 61)) return false;
+        out = (out << 3) | static_cast<uint64_t>(field[i] - '0');
+    }
+    return true;
+}
+
+// 校验和按校验和字段全为空格计算
+uint32_t headerChecksum(const TarHeader& header, bool asSigned) {
+    const char* bytes = reinterpret_cast<const char*>(&header);
+    uint32_t sum = 0;
+    for (size_t i = 0; i < sizeof(TarHeader); ++i) {
+        bool inField = i >= offsetof(TarHeader, checksum) && i < offsetof(TarHeader, checksum) + sizeof(header.checksum);
+        char c = inField ? ' ' : bytes[i];
+        sum += asSigned ? static_cast<uint32_t>(static_cast<int32_t>(static_cast<signed char>(c)))
+                        : static_cast<unsigned char>(c);
+    }
+    return sum;
+}
+
+bool isZeroBlock(const uint8_t* block) {
+    return std::all_of(block, block + kBlockSize, [](uint8_t b) { return b == 0; });
+}
+
+// 定长字段可能没有 NUL 结尾
+std::string_view fieldString(const char* field, size_t width) {
+    return std::string_view(field, strnlen(field, width));
+}
+
+// 规范化归档内的路径：去掉开头的 '/' 和 "." 分量，含 ".." 的路径不允许解出到目标目录之外
+bool sanitizeMemberPath(std::string_view raw, std::string& out) {
+    out.clear();
+    size_t pos = 0;
+    while (pos <= raw.size()) {
+        size_t slash = raw.find('/', pos);
+        if (slash == std::string_view::npos) slash = raw.size();
+        std::string_view part = raw.substr(pos, slash - pos);
+        pos = slash + 1;
+        if (part.empty() || part == ".") continue;
+        if (part == "..") return false;
+        if (!out.empty()) out.push_back('/');
+        out.append(part);
+    }
+    return true;
+}
+
+// ---------------- pack ----------------
+
+// 遍历线程交给写线程的条目
+struct PackItem {
+    std::string name;        // 归档内路径，目录以 '/' 结尾
+    std::string linkTarget;  // 符号链接目标或硬链接指向的归档路径
+    char typeflag = '0';
+    struct stat st;
+    int fd = -1;             // 大文件由写线程从该描述符复制
+    std::string data;        // 小文件内容
+};
+
+// 带缓冲的归档写出，大文件绕过缓冲区直接由内核复制
+class TarWriter {
+public:
+    explicit TarWriter(int fd) : fd(fd) { buffer.reserve(kWriteBufferSize); }
+
+    int error() const { return err; }
+
+    void write(const void* data, size_t len) {
+        if (buffer.size() + len > kWriteBufferSize) flush();
+        const char* p = static_cast<const char*>(data);
+        buffer.insert(buffer.end(), p, p + len);
+    }
+
+    void writeZeros(uint64_t len) {
+        while (len > 0) {
+            size_t n = static_cast<size_t>(std::min<uint64_t>(len, kWriteBufferSize));
+            if (buffer.size() + n > kWriteBufferSize) flush();
+            buffer.resize(buffer.size() + n, '\0');
+            len -= n;
+        }
+    }
+
+    void flush() {
+        size_t done = 0;
+        while (err == 0 && done < buffer.size()) {
+            ssize_t n = ::write(fd, buffer.data() + done, buffer.size() - done);
+            if (n < 0) {
+                if (errno != EINTR) err = errno;
+                continue;
+            }
+            done += static_cast<size_t>(n);
+        }
+        position += done;
+        buffer.clear();
+    }
+
+    void writeEntry(const PackItem& item) {
+        if (item.name.size() > sizeof(TarHeader::name)) writeLongName('L', item.name);
+        if (item.linkTarget.size() > sizeof(TarHeader::linkname)) writeLongName('K', item.linkTarget);
+
+        uint64_t size = item.typeflag == '0' ? static_cast<uint64_t>(item.st.st_size) : 0;
+        TarHeader header{};
+        std::memcpy(header.name, item.name.data(), std::min(item.name.size(), sizeof(header.name)));
+        std::memcpy(header.linkname, item.linkTarget.data(), std::min(item.linkTarget.size(), sizeof(header.linkname)));
+        putNumber(header.mode, sizeof(header.mode), item.st.st_mode & 07777);
+        putNumber(header.uid, sizeof(header.uid), item.st.st_uid);
+        putNumber(header.gid, sizeof(header.gid), item.st.st_gid);
+        putNumber(header.size, sizeof(header.size), size);
+        putNumber(header.mtime, sizeof(header.mtime), static_cast<uint64_t>(std::max<int64_t>(item.st.st_mtim.tv_sec, 0)));
+        header.typeflag = item.typeflag;
+        writeHeader(header);
+
+        if (size == 0) return;
+        uint64_t copied;
+        if (item.fd >= 0) {
+            flush();
+            if (err != 0) return;
+            int copyErr = copyFileData(item.fd, fd, size);
+            if (copyErr != 0) {
+                err = copyErr;
+                return;
+            }
+            // 复制期间文件可能被截断，按实际输出位置计算
+            off_t now = lseek(fd, 0, SEEK_CUR);
+            copied = now < 0 ? size : static_cast<uint64_t>(now) - position;
+            position += copied;
+        } else {
+            write(item.data.data(), item.data.size());
+            copied = item.data.size();
+        }
+        // 头部中的大小已经写出，不足部分补零以保持归档结构
+        writeZeros(roundUpBlock(size) - copied);
+    }
+
+    void finish() {
+        writeZeros(2 * kBlockSize);
+        flush();
+    }
+
+private:
+    int fd;
+    int err = 0;
+    uint64_t position = 0;  // 已写入文件的字节数 (不含缓冲区)
+    std::vector<char> buffer;
+
+    void writeHeader(TarHeader& header) {
+        std::memcpy(header.magic, "ustar", 6);
+        std::memcpy(header.version, "00", 2);
+        putNumber(header.checksum, 7, headerChecksum(header, false));
+        header.checksum[7] = ' ';
+        write(&header, sizeof(header));
+    }
+
+    // GNU 扩展：超长路径或链接目标放在紧邻的前一个条目的数据中
+    void writeLongName(char typeflag, const std::string& value) {
+        TarHeader header{};
+        std::memcpy(header.name, kLongLinkName, sizeof(kLongLinkName));
+        putNumber(header.mode, sizeof(header.mode), 0644);
+        putNumber(header.uid, sizeof(header.uid), 0);
+        putNumber(header.gid, sizeof(header.gid), 0);
+        putNumber(header.size, sizeof(header.size), value.size() + 1);
+        putNumber(header.mtime, sizeof(header.mtime), 0);
+        header.typeflag = typeflag;
+        writeHeader(header);
+        write(value.c_str(), value.size() + 1);
+        writeZeros(roundUpBlock(value.size() + 1) - (value.size() + 1));
+    }
+};
+
+struct InodeKey {
+    dev_t dev;
+    ino_t inode;
+    bool operator<(const InodeKey& other) const {
+        return dev != other.dev ? dev < other.dev : inode < other.inode;
+    }
+};
+
+// 小文件整体读入，读取失败返回 errno
+int readSmallFile(int fd, size_t size, std::string& out) {
+    out.resize(size);
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = read(fd, out.data() + done, size - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno;
+        }
+        if (n == 0) break;
+        done += static_cast<size_t>(n);
+    }
+    out.resize(done);
+    return 0;
+}
+
+// ---------------- unpack ----------------
+
+struct TarMember {
+    std::string path;        // 相对目标目录的路径
+    std::string linkTarget;
+    char typeflag;
+    uint64_t mode;
+    uint64_t mtime;
+    uint64_t dataOffset;     // 数据在归档中的偏移
+    uint64_t size;
+    bool superseded = false; // 同一路径在归档后面再次出现
+};
+
+// 读取 pax 扩展头中的 path / linkpath
+void parsePaxRecords(std::string_view data, std::string& path, std::string& linkPath) {
+    while (!data.empty()) {
+        size_t space = data.find(' ');
+        if (space == std::string_view::npos) return;
+        size_t len = 0;
+        for (char c : data.substr(0, space)) {
+            if (c < '0' || c > '9') return;
+            len = len * 10 + static_cast<size_t>(c - '0');
+        }
+        if (len <= space + 1 || len > data.size()) return;
+        std::string_view record = data.substr(space + 1, len - space - 2); // 去掉末尾 '\n'
+        size_t eq = record.find('=');
+        if (eq != std::string_view::npos) {
+            std::string_view key = record.substr(0, eq);
+            if (key == "path") path = record.substr(eq + 1);
+            else if (key == "linkpath") linkPath = record.substr(eq + 1);
+        }
+        data.remove_prefix(len);
+    }
+}
+
+// 从 offset 处读满 len 字节，文件变短或出错时返回 false
+bool readAt(int fd, void* buffer, size_t len, uint64_t offset) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = pread(fd, static_cast<char*>(buffer) + done, len - done, static_cast<off_t>(offset + done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// 解析全部头部，不写任何文件
+// 头部通过 pread 读取而不映射归档：归档在解析时可能被其他进程截断，访问映射区域越过文件末尾会触发 SIGBUS
+// [In] total: 打开时 fstat 得到的归档大小
+bool parseArchive(int fd, uint64_t total, std::vector<TarMember>& outMembers,
+                  EntryErrors& outSkipped, const char*& outError) {
+    std::string longName;
+    std::string longLink;
+    std::string extended;
+    uint64_t offset = 0;
+
+    while (offset + kBlockSize <= total) {
+        TarHeader header;
+        if (!readAt(fd, &header, sizeof(header), offset)) {
+            outError = "Corrupted tar archive (unexpected end of file)";
+            return false;
+        }
+        if (isZeroBlock(reinterpret_cast<const uint8_t*>(&header))) return true;
+
+        uint64_t stored = 0;
+        uint64_t size = 0;
+        if (!parseNumber(header.checksum, sizeof(header.checksum), stored) ||
+            (stored != headerChecksum(header, false) && stored != headerChecksum(header, true))) {
+            outError = "Corrupted tar archive (bad header checksum)";
+            return false;
+        }
+        if (!parseNumber(header.size, sizeof(header.size), size)) {
+            outError = "Corrupted tar archive (bad size field)";
+            return false;
+        }
+        uint64_t dataOffset = offset + kBlockSize;
+        if (size > total - dataOffset) {
+            outError = "Corrupted tar archive (unexpected end of file)";
+            return false;
+        }
+        offset = dataOffset + roundUpBlock(size);
+
+        // 扩展头只作用于紧随其后的条目，只有扩展头需要读取内容
+        std::string_view data;
+        if (header.typeflag == 'L' || header.typeflag == 'K' || header.typeflag == 'x') {
+            if (size > kMaxExtendedHeader) {
+                outError = "Corrupted tar archive (extended header too large)";
+                return false;
+            }
+            extended.resize(static_cast<size_t>(size));
+            if (!readAt(fd, extended.data(), extended.size(), dataOffset)) {
+                outError = "Corrupted tar archive (unexpected end of file)";
+                return false;
+            }
+            data = extended;
+        }
+        switch (header.typeflag) {
+            case 'L':
+                longName = fieldString(data.data(), data.size());
+                continue;
+            case 'K':
+                longLink = fieldString(data.data(), data.size());
+                continue;
+            case 'x':
+                parsePaxRecords(data, longName, longLink);
+                continue;
+            case 'g':
+                continue;
+            default:
+                break;
+        }
+
+        std::string rawName = std::move(longName);
+        std::string rawLink = std::move(longLink);
+        longName.clear();
+        longLink.clear();
+        if (rawName.empty()) {
+            rawName = fieldString(header.name, sizeof(header.name));
+            std::string_view prefix = fieldString(header.prefix, sizeof(header.prefix));
+            if (std::memcmp(header.magic, "ustar", 5) == 0 && !prefix.empty()) {
+                rawName = std::string(prefix) + "/" + rawName;
+            }
+        }
+        if (rawLink.empty()) rawLink = fieldString(header.linkname, sizeof(header.linkname));
+
+        TarMember member;
+        member.typeflag = header.typeflag == '\0' || header.typeflag == '7' ? '0' : header.typeflag;
+        parseNumber(header.mode, sizeof(header.mode), member.mode);
+        parseNumber(header.mtime, sizeof(header.mtime), member.mtime);
+        member.dataOffset = dataOffset;
+        member.size = size;
+
+        if (!sanitizeMemberPath(rawName, member.path)) {
+            outSkipped.add(StatusCode::InvalidArguments, "Skipped path outside the target directory", rawName);
+            continue;
+        }
+        if (member.path.empty()) continue; // 归档根 "./"
+
+        switch (member.typeflag) {
+            case '0':
+            case '5':
+                break;
+            case '2':
+                member.linkTarget = rawLink;
+                break;
+            case '1':
+                if (!sanitizeMemberPath(rawLink, member.linkTarget) || member.linkTarget.empty()) {
+                    outSkipped.add(StatusCode::InvalidArguments, "Skipped link outside the target directory", rawName);
+                    continue;
+                }
+                break;
+            default:
+                outSkipped.add(StatusCode::NotAFile, "Skipped unsupported entry type", rawName);
+                continue;
+        }
+        outMembers.push_back(std::move(member));
+    }
+
+    // 缺少结尾的两个零块也可接受，但不能有残缺的头部
+    if (offset < total) {
+        outError = "Corrupted tar archive (unexpected end of file)";
+        return false;
+    }
+    return true;
+}
+
+// 在 rootFd 之下逐级打开目录 rel，任何一级是符号链接都失败 (ELOOP / ENOTDIR)
+// 成员路径已由 sanitizeMemberPath 去掉 ".."，因此结果一定位于 rootFd 之下，
+// 归档中先创建的符号链接 (d -> /etc) 和目标目录中已有的符号链接都无法把后续条目引到外面
+// [In] create: 为 true 时创建缺少的目录
+// 返回 O_PATH 描述符，失败返回 -1 并保留 errno
+int openDirBeneath(int rootFd, std::string_view rel, bool create) {
+    int fd = fcntl(rootFd, F_DUPFD_CLOEXEC, 0);
+    size_t pos = 0;
+    while (fd >= 0 && pos < rel.size()) {
+        size_t slash = rel.find('/', pos);
+        if (slash == std::string_view::npos) slash = rel.size();
+        std::string part(rel.substr(pos, slash - pos));
+        pos = slash + 1;
+
+        int next = openat(fd, part.c_str(), O_PATH | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (next < 0 && errno == ENOENT && create && (mkdirat(fd, part.c_str(), 0777) == 0 || errno == EEXIST)) {
+            next = openat(fd, part.c_str(), O_PATH | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        }
+        int err = errno;
+        close(fd);
+        errno = err;
+        fd = next;
+    }
+    return fd;
+}
+
+// 成员路径的父目录与最后一段名称
+std::pair<std::string_view, std::string> splitMemberPath(std::string_view path) {
+    size_t slash = path.rfind('/');
+    if (slash == std::string_view::npos) return {std::string_view(), std::string(path)};
+    return {path.substr(0, slash), std::string(path.substr(slash + 1))};
+}
+
+void makeTimes(uint64_t mtime, struct timespec (&times)[2]) {
+    times[0].tv_sec = times[1].tv_sec = static_cast<time_t>(mtime);
+    times[0].tv_nsec = times[1].tv_nsec = 0;
+}
+
+} // namespace
+
+Status FileManager::packTree(const Path& dirPath, const Path& archiveFile, ArchiveReport& outReport) {
+    outReport = ArchiveReport();
+    fs::path srcRoot = resolvePath(dirPath).lexically_normal();
+    if (!srcRoot.has_filename()) srcRoot = srcRoot.parent_path();
+    if (!fs::exists(srcRoot) || !fs::is_directory(srcRoot)) {
+        return Status::Error(StatusCode::NotADirectory, "Invalid directory", std::move(srcRoot));
+    }
+
+    fs::path outPath = resolvePath(archiveFile);
+    int outFd = open(outPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (outFd < 0) {
+        return Status::SystemError(StatusCode::PermissionDenied, "Cannot write", std::move(outPath), errno);
+    }
+    struct stat outSt;
+    fstat(outFd, &outSt);
+
+    // 归档内以目录名为顶层，与 tar -cf out.tar dir 一致
+    std::string rootName = srcRoot.filename().string();
+    if (rootName.empty()) rootName = ".";
+    const size_t rootLen = srcRoot.string().size();
+
+    std::mutex errorMutex;
+    auto recordError = [&](std::string_view path, int err) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        outReport.errors.add(StatusCode::CopyFailed, "Skipped", path, err);
+    };
+
+    // 遍历线程：stat、读取小文件、打开并预读大文件；写线程 (当前线程) 依次写出
+    WorkQueue<PackItem> queue(kQueueCapacity);
+    int walkErr = 0; // 打开根目录失败时的 errno，由遍历线程写入，join 之后读取
+    std::thread producer([&]() {
+        PackItem rootItem;
+        rootItem.name = rootName + "/";
+        rootItem.typeflag = '5';
+        // 根目录可以是指向目录的符号链接，与遍历器一致地跟随它
+        if (stat(srcRoot.c_str(), &rootItem.st) != 0) {
+            walkErr = errno;
+            queue.close();
+            return;
+        }
+        if (!queue.push(std::move(rootItem))) {
+            queue.close();
+            return;
+        }
+
+        std::map<InodeKey, std::string> linkNames; // 多个硬链接的 inode -> 首次出现的归档路径
+        TreeWalker walker;
+        walkErr = walker.walk(srcRoot, [&](WalkEntry& entry) {
+            const struct stat* st = entry.stat();
+            if (!st) {
+                recordError(entry.path, errno);
+                return WalkAction::Continue;
+            }
+            if (st->st_dev == outSt.st_dev && st->st_ino == outSt.st_ino) {
+                return WalkAction::Continue; // 输出文件位于被打包的目录中
+            }
+
+            PackItem item;
+            item.st = *st;
+            std::string_view rel = entry.path.substr(rootLen);
+            if (!rel.empty() && rel.front() == '/') rel.remove_prefix(1);
+            item.name.reserve(rootName.size() + rel.size() + 2);
+            item.name.append(rootName).append("/").append(rel);
+
+            switch (entry.type) {
+                case FileType::Directory:
+                    item.typeflag = '5';
+                    item.name.push_back('/');
+                    break;
+                case FileType::Symlink: {
+                    char target[PATH_MAX];
+                    ssize_t n = readlinkat(entry.dirFd, entry.name.data(), target, sizeof(target));
+                    if (n < 0) {
+                        recordError(entry.path, errno);
+                        return WalkAction::Continue;
+                    }
+                    item.typeflag = '2';
+                    item.linkTarget.assign(target, static_cast<size_t>(n));
+                    break;
+                }
+                case FileType::File: {
+                    if (st->st_nlink > 1) {
+                        auto [it, inserted] = linkNames.try_emplace(InodeKey{st->st_dev, st->st_ino}, item.name);
+                        if (!inserted) {
+                            item.typeflag = '1';
+                            item.linkTarget = it->second;
+                            break;
+                        }
+                    }
+                    int fd = openat(entry.dirFd, entry.name.data(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+                    if (fd < 0) {
+                        recordError(entry.path, errno);
+                        return WalkAction::Continue;
+                    }
+                    item.typeflag = '0';
+                    if (static_cast<uint64_t>(st->st_size) <= kInlineLimit) {
+                        int err = readSmallFile(fd, static_cast<size_t>(st->st_size), item.data);
+                        close(fd);
+                        if (err != 0) {
+                            recordError(entry.path, err);
+                            return WalkAction::Continue;
+                        }
+                    } else {
+                        // 写线程追上之前内核已开始读取
+                        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+                        posix_fadvise(fd, 0, std::min<off_t>(st->st_size, kPrefetchBytes), POSIX_FADV_WILLNEED);
+                        item.fd = fd;
+                    }
+                    break;
+                }
+                default:
+                    // 设备文件、管道、套接字不打包
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    outReport.errors.add(StatusCode::NotAFile, "Skipped special file", entry.path);
+                    return WalkAction::Continue;
+            }
+
+            if (!queue.push(std::move(item))) {
+                if (item.fd >= 0) close(item.fd);
+                return WalkAction::Stop;
+            }
+            return WalkAction::Continue;
+        }, [&](std::string_view path, int err) { recordError(path, err); });
+        queue.close();
+    });
+
+    TarWriter writer(outFd);
+    while (auto item = queue.pop()) {
+        if (writer.error() == 0) {
+            writer.writeEntry(*item);
+            if (writer.error() != 0) {
+                queue.close(); // 让遍历线程尽快停止
+            } else {
+                outReport.entries++;
+                if (item->typeflag == '0') outReport.bytes += static_cast<uintmax_t>(item->st.st_size);
+            }
+        }
+        if (item->fd >= 0) close(item->fd);
+    }
+    producer.join();
+
+    // 根目录无法读取时归档只有根条目，不能当作成功
+    if (walkErr != 0) {
+        close(outFd);
+        unlink(outPath.c_str());
+        return Status::SystemError(Status::codeFromErrno(walkErr), "Cannot open directory", std::move(srcRoot), walkErr);
+    }
+    if (writer.error() == 0) writer.finish();
+    int err = writer.error();
+    if (close(outFd) != 0 && err == 0) err = errno;
+    if (err != 0) {
+        unlink(outPath.c_str());
+        return Status::SystemError(StatusCode::CopyFailed, "Cannot write", std::move(outPath), err);
+    }
+    invalidateCaches(outPath);
+    return Status::Success();
+}
+
+Status FileManager::unpackArchive(const Path& archiveFile, const Path& destDir, ArchiveReport& outReport) {
+    outReport = ArchiveReport();
+    fs::path archivePath = resolvePath(archiveFile);
+    fs::path destRoot = resolvePath(destDir);
+    if (!fs::exists(archivePath)) {
+        return Status::Error(StatusCode::PathNotFound, "Archive not found", std::move(archivePath));
+    }
+
+    int archiveFd = open(archivePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (archiveFd < 0) {
+        return Status::SystemError(StatusCode::PermissionDenied, "Cannot open", std::move(archivePath), errno);
+    }
+    struct FdGuard {
+        int fd;
+        ~FdGuard() { close(fd); }
+    } archiveGuard{archiveFd};
+    struct stat archiveStat;
+    int statErr = fstat(archiveFd, &archiveStat) != 0 ? errno : (S_ISREG(archiveStat.st_mode) ? 0 : EINVAL);
+    if (statErr != 0) {
+        return Status::SystemError(StatusCode::PermissionDenied, "Cannot open", std::move(archivePath), statErr);
+    }
+    posix_fadvise(archiveFd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    std::vector<TarMember> members;
+    const char* parseError = "Corrupted tar archive (empty file)";
+    const uint64_t archiveSize = static_cast<uint64_t>(archiveStat.st_size);
+    if (archiveSize == 0 || !parseArchive(archiveFd, archiveSize, members, outReport.errors, parseError)) {
+        return Status::Error(StatusCode::InvalidArguments, parseError, std::move(archivePath));
+    }
+
+    std::error_code ec;
+    fs::create_directories(destRoot, ec);
+    if (ec) {
+        return Status::SystemError(StatusCode::PermissionDenied, "Cannot create directory", std::move(destRoot), ec.value());
+    }
+    // 之后的所有写入都经 openDirBeneath 相对该描述符解析
+    int rootFd = open(destRoot.c_str(), O_PATH | O_DIRECTORY | O_CLOEXEC);
+    if (rootFd < 0) {
+        return Status::SystemError(StatusCode::PermissionDenied, "Cannot open directory", std::move(destRoot), errno);
+    }
+    FdGuard rootGuard{rootFd};
+
+    // 归档中靠后的同名条目覆盖靠前的
+    std::unordered_map<std::string_view, size_t> lastIndex;
+    for (size_t i = 0; i < members.size(); ++i) {
+        auto [it, inserted] = lastIndex.try_emplace(members[i].path, i);
+        if (!inserted) {
+            members[it->second].superseded = true;
+            it->second = i;
+        }
+    }
+
+    std::mutex errorMutex;
+    auto recordError = [&](const std::string& path, int err) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        outReport.errors.add(StatusCode::CopyFailed, "Cannot extract", path, err);
+    };
+
+    // 1. 目录 (以及文件的父目录)，按路径排序保证父目录先创建
+    std::vector<std::string> dirs;
+    std::vector<size_t> files;
+    std::vector<size_t> hardLinks;
+    std::vector<size_t> symlinks;
+    for (size_t i = 0; i < members.size(); ++i) {
+        const TarMember& m = members[i];
+        if (m.superseded) continue;
+        if (m.typeflag == '5') {
+            dirs.push_back(m.path);
+            continue;
+        }
+        size_t slash = m.path.rfind('/');
+        if (slash != std::string::npos) dirs.push_back(m.path.substr(0, slash));
+        (m.typeflag == '0' ? files : m.typeflag == '1' ? hardLinks : symlinks).push_back(i);
+    }
+    std::sort(dirs.begin(), dirs.end());
+    dirs.erase(std::unique(dirs.begin(), dirs.end()), dirs.end());
+    for (const auto& dir : dirs) {
+        int fd = openDirBeneath(rootFd, dir, true);
+        if (fd < 0) recordError(dir, errno);
+        else close(fd);
+    }
+
+    // 2. 普通文件并行写出，数据直接从归档文件复制
+    std::atomic<uintmax_t> bytes{0};
+    std::atomic<uintmax_t> extracted{0};
+    parallelFor(files.size(), [&](size_t k, unsigned) {
+        const TarMember& m = members[files[k]];
+        auto [parent, name] = splitMemberPath(m.path);
+        int parentFd = openDirBeneath(rootFd, parent, false);
+        int out = parentFd < 0 ? -1 : openat(parentFd, name.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC, 0600);
+        if (parentFd >= 0) {
+            int err = errno;
+            close(parentFd);
+            errno = err;
+        }
+        if (out < 0) {
+            recordError(m.path, errno);
+            return;
+        }
+        off_t offset = static_cast<off_t>(m.dataOffset);
+        int err = copyFileData(archiveFd, out, m.size, &offset);
+        if (err == 0) {
+            fchmod(out, static_cast<mode_t>(m.mode & 07777));
+            struct timespec times[2];
+            makeTimes(m.mtime, times);
+            futimens(out, times);
+        }
+        if (close(out) != 0 && err == 0) err = errno;
+        if (err != 0) {
+            recordError(m.path, err);
+            return;
+        }
+        bytes.fetch_add(m.size, std::memory_order_relaxed);
+        extracted.fetch_add(1, std::memory_order_relaxed);
+    }, std::min(defaultThreadCount(), kMaxExtractThreads));
+
+    // 3. 硬链接，再 4. 符号链接，最后创建符号链接使其不会出现在任何其他条目的路径中
+    // 链接和其目标的父目录都经 openDirBeneath 解析；linkat 不跟随目标本身的符号链接
+    auto createLink = [&](const TarMember& m) {
+        auto [parent, name] = splitMemberPath(m.path);
+        int parentFd = openDirBeneath(rootFd, parent, false);
+        if (parentFd < 0) return errno;
+        struct FdGuard {
+            int fd;
+            ~FdGuard() { close(fd); }
+        } parentGuard{parentFd};
+
+        // 同名的非目录条目先删除
+        struct stat st;
+        if (fstatat(parentFd, name.c_str(), &st, AT_SYMLINK_NOFOLLOW) == 0 && !S_ISDIR(st.st_mode)) {
+            unlinkat(parentFd, name.c_str(), 0);
+        }
+        if (m.typeflag == '2') {
+            if (symlinkat(m.linkTarget.c_str(), parentFd, name.c_str()) != 0) return errno;
+            struct timespec times[2];
+            makeTimes(m.mtime, times);
+            utimensat(parentFd, name.c_str(), times, AT_SYMLINK_NOFOLLOW);
+            return 0;
+        }
+        auto [targetParent, targetName] = splitMemberPath(m.linkTarget);
+        int targetFd = openDirBeneath(rootFd, targetParent, false);
+        if (targetFd < 0) return errno;
+        int rc = linkat(targetFd, targetName.c_str(), parentFd, name.c_str(), 0);
+        int err = rc == 0 ? 0 : errno;
+        close(targetFd);
+        return err;
+    };
+    for (const std::vector<size_t>* group : {&hardLinks, &symlinks}) {
+        for (size_t index : *group) {
+            int err = createLink(members[index]);
+            if (err != 0) {
+                recordError(members[index].path, err);
+                continue;
+            }
+            extracted.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // 5. 目录的权限和时间最后设置，子项写入会改变目录的修改时间
+    for (size_t i = members.size(); i-- > 0;) {
+        const TarMember& m = members[i];
+        if (m.superseded || m.typeflag != '5') continue;
+        auto [parent, name] = splitMemberPath(m.path);
+        int parentFd = openDirBeneath(rootFd, parent, false);
+        if (parentFd < 0) continue;
+        int dirFd = openat(parentFd, name.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        close(parentFd);
+        if (dirFd < 0) continue;
+        fchmod(dirFd, static_cast<mode_t>(m.mode & 07777));
+        struct timespec times[2];
+        makeTimes(m.mtime, times);
+        futimens(dirFd, times);
+        close(dirFd);
+        extracted.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    outReport.entries = extracted.load();
+    outReport.bytes = bytes.load();
+    invalidateCaches(destRoot);
+    return Status::Success();
+}
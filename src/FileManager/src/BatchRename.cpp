@@ -0,0 +1,258 @@
+#include "FileManager.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <regex>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t kNone = static_cast<size_t>(-1);
+
+// glob 转为整名匹配的正则，每个 * ? [...] 成为一个捕获组
+bool globToRegex(std::string_view glob, std::string& outRegex) {
+    outRegex.clear();
+    for (size_t i = 0; i < glob.size(); ++i) {
+        char c = glob[i];
+        if (c == '*') {
+            outRegex += "(.*)";
+        } else if (c == '?') {
+            outRegex += "(.)";
+        } else if (c == '[') {
+            size_t close = glob.find(']', i + 2);
+            if (close == std::string_view::npos) return false;
+            outRegex += "([";
+            size_t j = i + 1;
+            if (glob[j] == '!' || glob[j] == '^') {
+                outRegex += '^';
+                ++j;
+            }
+            for (; j < close; ++j) {
+                if (glob[j] == '\\' || glob[j] == '[' || glob[j] == ']') outRegex += '\\';
+                outRegex += glob[j];
+            }
+            outRegex += "])";
+            i = close;
+        } else {
+            if (std::string_view("\\^$.|+(){}[]").find(c) != std::string_view::npos) outRegex += '\\';
+            outRegex += c;
+        }
+    }
+    return true;
+}
+
+// 替换模板：字面量与捕获组引用交替
+struct Template {
+    struct Part {
+        std::string literal;
+        int group = -1; // >= 0 时引用捕获组
+    };
+    std::vector<Part> parts;
+    int maxGroup = -1;
+
+    explicit Template(std::string_view text) {
+        std::string literal;
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (text[i] == '#' && i + 1 < text.size() && text[i + 1] == '#') {
+                literal += '#';
+                ++i;
+            } else if (text[i] == '#' && i + 1 < text.size() && std::isdigit(static_cast<unsigned char>(text[i + 1]))) {
+                int group = 0;
+                while (i + 1 < text.size() && std::isdigit(static_cast<unsigned char>(text[i + 1]))) {
+                    group = group * 10 + (text[++i] - '0');
+                }
+                if (!literal.empty()) parts.push_back({std::move(literal), -1});
+                literal.clear();
+                parts.push_back({{}, group});
+                maxGroup = std::max(maxGroup, group);
+            } else {
+                literal += text[i];
+            }
+        }
+        if (!literal.empty()) parts.push_back({std::move(literal), -1});
+    }
+
+    std::string expand(const std::smatch& match) const {
+        std::string result;
+        for (const auto& part : parts) {
+            if (part.group < 0) result += part.literal;
+            else result += match[static_cast<size_t>(part.group)].str();
+        }
+        return result;
+    }
+};
+
+bool validName(const std::string& name) {
+    return !name.empty() && name != "." && name != ".." && name.find('/') == std::string::npos &&
+           name.find('\0') == std::string::npos;
+}
+
+// 不覆盖已存在条目的重命名；文件系统不支持 RENAME_NOREPLACE 时先检查再 rename
+int renameNoReplace(int dirFd, const std::string& from, const std::string& to) {
+    if (renameat2(dirFd, from.c_str(), dirFd, to.c_str(), RENAME_NOREPLACE) == 0) return 0;
+    if (errno != EINVAL && errno != ENOSYS) return errno;
+    struct stat st;
+    if (fstatat(dirFd, to.c_str(), &st, AT_SYMLINK_NOFOLLOW) == 0) return EEXIST;
+    return renameat(dirFd, from.c_str(), dirFd, to.c_str()) == 0 ? 0 : errno;
+}
+
+} // namespace
+
+Status FileManager::batchRename(const Path& dirPath, const RenameOptions& options, std::vector<RenameItem>& outItems) {
+    outItems.clear();
+    if (options.pattern.empty() || options.replacement.empty()) {
+        return Status::Error(StatusCode::InvalidArguments, "Missing pattern: Please enter 'rename [pattern] [replacement] [dir]'");
+    }
+
+    std::string regexText = options.pattern;
+    if (!options.regex && !globToRegex(options.pattern, regexText)) {
+        return Status::Error(StatusCode::InvalidArguments, "Invalid glob pattern", options.pattern);
+    }
+    std::regex pattern;
+    try {
+        pattern.assign(regexText, std::regex::ECMAScript | std::regex::optimize);
+    } catch (const std::regex_error&) {
+        return Status::Error(StatusCode::InvalidArguments, "Invalid regular expression", options.pattern);
+    }
+    const Template replacement(options.replacement);
+    if (replacement.maxGroup > static_cast<int>(pattern.mark_count())) {
+        return Status::Error(StatusCode::InvalidArguments, "Replacement refers to a missing group", options.replacement);
+    }
+    // 与 shell 相同，glob 不以 '.' 开头时不匹配隐藏条目
+    const bool matchHidden = options.regex || options.pattern[0] == '.';
+
+    fs::path target = resolvePath(dirPath);
+    int dirFd = open(target.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd < 0) {
+        return Status::SystemError(Status::codeFromErrno(errno), "Cannot open directory", std::move(target), errno);
+    }
+    struct FdGuard {
+        int fd;
+        ~FdGuard() { close(fd); }
+    } dirGuard{dirFd};
+
+    // 读取目录中的全部名称
+    std::vector<std::string> names;
+    {
+        int listFd = dup(dirFd);
+        DIR* dir = listFd >= 0 ? fdopendir(listFd) : nullptr;
+        if (!dir) {
+            if (listFd >= 0) close(listFd);
+            return Status::SystemError(StatusCode::PermissionDenied, "Cannot open directory", std::move(target), errno);
+        }
+        while (dirent* entry = readdir(dir)) {
+            std::string_view name = entry->d_name;
+            if (name == "." || name == "..") continue;
+            names.emplace_back(name);
+        }
+        closedir(dir);
+    }
+    std::sort(names.begin(), names.end());
+
+    // 生成计划
+    std::smatch match;
+    for (const auto& name : names) {
+        if (!matchHidden && name[0] == '.') continue;
+        if (!std::regex_match(name, match, pattern)) continue;
+        std::string newName = replacement.expand(match);
+        if (newName == name) continue;
+        if (!validName(newName)) {
+            return Status::Error(StatusCode::InvalidArguments, "Replacement gives an invalid name", target / name);
+        }
+        outItems.push_back({name, std::move(newName)});
+    }
+    if (outItems.empty()) return Status::Success();
+
+    // 冲突检查：新名称互不相同；与目录中已有条目同名时，该条目必须也会被改名
+    std::unordered_map<std::string_view, size_t> sourceIndex;
+    sourceIndex.reserve(outItems.size());
+    for (size_t i = 0; i < outItems.size(); ++i) sourceIndex.emplace(outItems[i].from, i);
+    std::unordered_set<std::string_view> existing(names.begin(), names.end());
+    std::unordered_set<std::string_view> targets;
+    targets.reserve(outItems.size());
+    std::vector<size_t> dependsOn(outItems.size(), kNone); // 新名称当前被哪一项占用
+    for (size_t i = 0; i < outItems.size(); ++i) {
+        const std::string& to = outItems[i].to;
+        if (!targets.insert(to).second) {
+            Status status = Status::Error(StatusCode::PathAlreadyExists, "Several entries would be renamed to", to);
+            outItems.clear();
+            return status;
+        }
+        auto it = sourceIndex.find(to);
+        if (it != sourceIndex.end()) {
+            dependsOn[i] = it->second;
+        } else if (existing.count(to)) {
+            Status status = Status::Error(StatusCode::PathAlreadyExists, "Target already exists", target / to);
+            outItems.clear();
+            return status;
+        }
+    }
+    if (options.dryRun) return Status::Success();
+
+    // 排序：占用新名称的条目先改名
+    // 每个新名称最多被一项占用，依赖关系只会构成链和环；环中先把一项移到临时名称，最后再移到新名称
+    struct Step {
+        std::string from;
+        std::string to;
+    };
+    std::vector<Step> steps;
+    steps.reserve(outItems.size() + 1);
+    std::vector<uint8_t> state(outItems.size(), 0); // 0 未处理，1 在当前链上，2 已排定
+    std::vector<size_t> chain;
+    unsigned tempCounter = 0;
+    for (size_t i = 0; i < outItems.size(); ++i) {
+        if (state[i] != 0) continue;
+        chain.clear();
+        size_t cycleStart = kNone;
+        for (size_t cur = i;;) {
+            state[cur] = 1;
+            chain.push_back(cur);
+            size_t next = dependsOn[cur];
+            if (next == kNone || state[next] == 2) break;
+            if (state[next] == 1) {
+                cycleStart = next;
+                break;
+            }
+            cur = next;
+        }
+
+        std::string temp;
+        if (cycleStart != kNone) {
+            do {
+                temp = ".mfe-rename-" + std::to_string(getpid()) + "-" + std::to_string(tempCounter++);
+            } while (existing.count(temp) || targets.count(temp));
+            steps.push_back({outItems[cycleStart].from, temp});
+        }
+        for (size_t k = chain.size(); k-- > 0;) {
+            size_t index = chain[k];
+            steps.push_back({index == cycleStart ? temp : outItems[index].from, outItems[index].to});
+            state[index] = 2;
+        }
+    }
+
+    // 执行，失败时按相反顺序撤销已完成的步骤
+    for (size_t s = 0; s < steps.size(); ++s) {
+        int err = renameNoReplace(dirFd, steps[s].from, steps[s].to);
+        if (err == 0) continue;
+        for (size_t k = s; k-- > 0;) {
+            renameNoReplace(dirFd, steps[k].to, steps[k].from);
+        }
+        invalidateCaches(target);
+        Status status = Status::SystemError(StatusCode::MoveFailed, "Rename failed, no entries were renamed",
+                                            target / steps[s].from, err);
+        outItems.clear();
+        return status;
+    }
+
+    invalidateCaches(target);
+    return Status::Success();
+}
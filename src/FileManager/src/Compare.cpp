@@ -0,0 +1,280 @@
+#include "FileManager.h"
+#include "AllocTracker.h"
+#include "TreeWalker.h"
+#include "Parallel.h"
+#include "StringHash.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+// 文件通过 pread 分窗口读取而不映射：比较期间文件可能被其他进程截断，
+// 访问映射区域越过文件末尾会触发 SIGBUS；读取时发现被截断按内容不同报告
+
+namespace {
+
+constexpr size_t kNone = static_cast<size_t>(-1);
+constexpr size_t kBlockSize = size_t(64) << 10;        // memcmp 的单次比较长度，命中差异后只在该块内定位
+constexpr size_t kChunkSize = size_t(16) << 20;        // 大文件切块的大小
+constexpr size_t kParallelFileSize = size_t(64) << 20; // 超过此大小的文件切块并行比较
+constexpr size_t kWindowSize = size_t(1) << 20;        // 每次 pread 的字节数
+
+// 第一个不同字节的偏移，相同时返回 kNone
+// memcmp 由 libc 按 CPU 选择向量化实现，整块相同时不逐字节比较
+size_t firstDifference(const uint8_t* a, const uint8_t* b, size_t len) {
+    for (size_t pos = 0; pos < len; pos += kBlockSize) {
+        size_t n = std::min(kBlockSize, len - pos);
+        if (std::memcmp(a + pos, b + pos, n) == 0) continue;
+        return static_cast<size_t>(std::mismatch(a + pos, a + pos + n, b + pos).first - a);
+    }
+    return kNone;
+}
+
+// 只读打开普通文件，失败时返回 -1 并保留 errno
+int openRegular(const std::string& path, uint64_t& outSize) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    struct stat st;
+    int err = fstat(fd, &st) != 0 ? errno : (S_ISREG(st.st_mode) ? 0 : EINVAL);
+    if (err != 0) {
+        ::close(fd);
+        errno = err;
+        return -1;
+    }
+    outSize = static_cast<uint64_t>(st.st_size);
+    return fd;
+}
+
+// 从 offset 处读取最多 len 字节，返回读到的字节数，只在文件结束或出错时少于 len
+size_t readAt(int fd, uint8_t* buffer, size_t len, uint64_t offset) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = pread(fd, buffer + done, len - done, static_cast<off_t>(offset + done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        done += static_cast<size_t>(n);
+    }
+    return done;
+}
+
+// 比较两个文件的 [begin, begin + len)，返回第一个不同字节的偏移，相同时返回 kNone
+// 任一侧读不满 (被截断或出错) 时，以读到的较短位置作为差异
+size_t compareRange(int fdA, int fdB, uint64_t begin, uint64_t len, std::vector<uint8_t>& bufA, std::vector<uint8_t>& bufB) {
+    bufA.resize(kWindowSize);
+    bufB.resize(kWindowSize);
+    for (uint64_t pos = 0; pos < len; pos += kWindowSize) {
+        size_t want = static_cast<size_t>(std::min<uint64_t>(kWindowSize, len - pos));
+        size_t gotA = readAt(fdA, bufA.data(), want, begin + pos);
+        size_t gotB = readAt(fdB, bufB.data(), want, begin + pos);
+        size_t common = std::min(gotA, gotB);
+        size_t offset = firstDifference(bufA.data(), bufB.data(), common);
+        if (offset != kNone) return static_cast<size_t>(begin + pos) + offset;
+        if (common < want) return static_cast<size_t>(begin + pos) + common;
+    }
+    return kNone;
+}
+
+// 比较两个等长的文件，chunked 为 true 时切块并行
+size_t compareContents(int fdA, int fdB, uint64_t size, bool chunked) {
+    posix_fadvise(fdA, 0, 0, POSIX_FADV_SEQUENTIAL);
+    posix_fadvise(fdB, 0, 0, POSIX_FADV_SEQUENTIAL);
+    if (!chunked) {
+        std::vector<uint8_t> bufA;
+        std::vector<uint8_t> bufB;
+        return compareRange(fdA, fdB, 0, size, bufA, bufB);
+    }
+
+    // 各块独立比较，取偏移最小的差异；已找到差异之后的块不再读取
+    std::atomic<size_t> result{kNone};
+    const size_t chunks = static_cast<size_t>((size + kChunkSize - 1) / kChunkSize);
+    parallelFor(chunks, [&](size_t index, unsigned) {
+        size_t begin = index * kChunkSize;
+        if (begin >= result.load(std::memory_order_relaxed)) return;
+        std::vector<uint8_t> bufA;
+        std::vector<uint8_t> bufB;
+        size_t offset = compareRange(fdA, fdB, begin, std::min<uint64_t>(kChunkSize, size - begin), bufA, bufB);
+        if (offset == kNone) return;
+        size_t current = result.load(std::memory_order_relaxed);
+        while (offset < current && !result.compare_exchange_weak(current, offset, std::memory_order_relaxed)) {}
+    });
+    return result.load();
+}
+
+// 比较两个普通文件，不同或无法读取时填写 outDifference 并返回 true
+bool compareFiles(const std::string& first, const std::string& second, bool chunked, FileDifference& outDifference) {
+    uint64_t sizeA = 0;
+    uint64_t sizeB = 0;
+    int fdA = openRegular(first, sizeA);
+    int fdB = fdA >= 0 ? openRegular(second, sizeB) : -1;
+    struct FdGuard {
+        int fd;
+        ~FdGuard() { if (fd >= 0) ::close(fd); }
+    } guardA{fdA}, guardB{fdB};
+    if (fdA < 0 || fdB < 0) {
+        outDifference.kind = DifferenceKind::Unreadable;
+        return true;
+    }
+    outDifference.firstSize = sizeA;
+    outDifference.secondSize = sizeB;
+    if (sizeA != sizeB) {
+        outDifference.kind = DifferenceKind::SizeDiffers;
+        return true;
+    }
+    size_t offset = compareContents(fdA, fdB, sizeA, chunked);
+    if (offset == kNone) return false;
+    outDifference.kind = DifferenceKind::ContentDiffers;
+    outDifference.offset = offset;
+    return true;
+}
+
+bool sameLinkTarget(const std::string& a, const std::string& b) {
+    char targetA[4096];
+    char targetB[4096];
+    ssize_t lenA = readlink(a.c_str(), targetA, sizeof(targetA));
+    ssize_t lenB = readlink(b.c_str(), targetB, sizeof(targetB));
+    return lenA >= 0 && lenA == lenB && std::memcmp(targetA, targetB, static_cast<size_t>(lenA)) == 0;
+}
+
+// 待比较内容的一对文件
+struct FilePair {
+    std::string rel;
+    uint64_t size;
+};
+
+} // namespace
+
+Status FileManager::compare(const Path& first, const Path& second, std::vector<FileDifference>& outDifferences) const {
+    AllocScope resultScope(AllocCategory::Results);
+    outDifferences.clear();
+    fs::path firstRoot = resolvePath(first).lexically_normal();
+    fs::path secondRoot = resolvePath(second).lexically_normal();
+    if (!firstRoot.has_filename()) firstRoot = firstRoot.parent_path();
+    if (!secondRoot.has_filename()) secondRoot = secondRoot.parent_path();
+
+    std::error_code ec;
+    fs::file_status firstStatus = fs::status(firstRoot, ec);
+    if (!fs::exists(firstStatus)) return Status::Error(StatusCode::PathNotFound, "Target not found", std::move(firstRoot));
+    fs::file_status secondStatus = fs::status(secondRoot, ec);
+    if (!fs::exists(secondStatus)) return Status::Error(StatusCode::PathNotFound, "Target not found", std::move(secondRoot));
+
+    FileDifference difference;
+    if (fs::is_directory(firstStatus) != fs::is_directory(secondStatus)) {
+        difference.kind = DifferenceKind::TypeDiffers;
+        outDifferences.push_back(std::move(difference));
+        return Status::Success();
+    }
+    if (!fs::is_directory(firstStatus)) {
+        if (!fs::is_regular_file(firstStatus)) return Status::Error(StatusCode::NotAFile, "Not a regular file", std::move(firstRoot));
+        if (!fs::is_regular_file(secondStatus)) return Status::Error(StatusCode::NotAFile, "Not a regular file", std::move(secondRoot));
+        if (compareFiles(firstRoot.string(), secondRoot.string(), true, difference)) {
+            if (difference.kind == DifferenceKind::Unreadable) {
+                // 报告无法读取的那一侧
+                uint64_t size = 0;
+                int fd = openRegular(firstRoot.string(), size);
+                if (fd < 0) return Status::SystemError(StatusCode::PermissionDenied, "Cannot read file", std::move(firstRoot), errno);
+                ::close(fd);
+                fd = openRegular(secondRoot.string(), size);
+                int err = fd < 0 ? errno : 0;
+                if (fd >= 0) ::close(fd);
+                return Status::SystemError(StatusCode::PermissionDenied, "Cannot read file", std::move(secondRoot), err);
+            }
+            outDifferences.push_back(std::move(difference));
+        }
+        return Status::Success();
+    }
+
+    // 两棵树同时遍历
+    TreeListing firstList;
+    TreeListing secondList;
+    std::thread secondWalker([&]() { listTree(secondRoot, secondList); });
+    listTree(firstRoot, firstList);
+    secondWalker.join();
+    if (firstList.err != 0) {
+        return Status::SystemError(StatusCode::PermissionDenied, "Cannot open directory", std::move(firstRoot), firstList.err);
+    }
+    if (secondList.err != 0) {
+        return Status::SystemError(StatusCode::PermissionDenied, "Cannot open directory", std::move(secondRoot), secondList.err);
+    }
+
+    // 按相对路径归并两个列表
+    // 只在一侧或类型不同的目录只报告一次，其下的条目不再单独报告
+    std::unordered_set<std::string, StringHash, std::equal_to<>> reportedDirs;
+    auto underReportedDir = [&](std::string_view rel) {
+        if (reportedDirs.empty()) return false;
+        for (size_t slash = rel.rfind('/'); slash != std::string_view::npos; slash = rel.rfind('/')) {
+            rel = rel.substr(0, slash);
+            if (reportedDirs.find(rel) != reportedDirs.end()) return true;
+        }
+        return false;
+    };
+    auto report = [&](DifferenceKind kind, std::string_view rel, FileType type, uint64_t firstSize, uint64_t secondSize) {
+        if (underReportedDir(rel)) return;
+        if (type == FileType::Directory) reportedDirs.emplace(rel);
+        outDifferences.push_back({kind, std::string(rel), firstSize, secondSize, 0});
+    };
+
+    const std::string firstPrefix = firstRoot.string() + "/";
+    const std::string secondPrefix = secondRoot.string() + "/";
+    std::vector<FilePair> small;
+    std::vector<FilePair> large;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < firstList.entries.size() || j < secondList.entries.size()) {
+        const TreeListing::Entry* a = i < firstList.entries.size() ? &firstList.entries[i] : nullptr;
+        const TreeListing::Entry* b = j < secondList.entries.size() ? &secondList.entries[j] : nullptr;
+        std::string_view relA = a ? firstList.path(*a) : std::string_view();
+        std::string_view relB = b ? secondList.path(*b) : std::string_view();
+        if (a && (!b || relA < relB)) {
+            report(DifferenceKind::OnlyInFirst, relA, a->type, a->size, 0);
+            ++i;
+            continue;
+        }
+        if (b && (!a || relB < relA)) {
+            report(DifferenceKind::OnlyInSecond, relB, b->type, 0, b->size);
+            ++j;
+            continue;
+        }
+        ++i;
+        ++j;
+        if (a->type != b->type) {
+            report(DifferenceKind::TypeDiffers, relA, a->type == FileType::Directory ? a->type : b->type, a->size, b->size);
+        } else if (a->type == FileType::Symlink) {
+            if (!sameLinkTarget(firstPrefix + std::string(relA), secondPrefix + std::string(relB))) {
+                report(DifferenceKind::ContentDiffers, relA, a->type, a->size, b->size);
+            }
+        } else if (a->type == FileType::File) {
+            if (a->size != b->size) report(DifferenceKind::SizeDiffers, relA, a->type, a->size, b->size);
+            else (a->size > kParallelFileSize ? large : small).push_back({std::string(relA), a->size});
+        }
+    }
+
+    // 小文件由各线程整文件比较，大文件逐个切块并行比较，避免一个线程拖住整体
+    std::vector<std::vector<FileDifference>> found(defaultThreadCount());
+    parallelFor(small.size(), [&](size_t index, unsigned worker) {
+        FileDifference diff;
+        if (compareFiles(firstPrefix + small[index].rel, secondPrefix + small[index].rel, false, diff)) {
+            diff.path = std::move(small[index].rel);
+            found[worker].push_back(std::move(diff));
+        }
+    });
+    for (auto& pair : large) {
+        FileDifference diff;
+        if (compareFiles(firstPrefix + pair.rel, secondPrefix + pair.rel, true, diff)) {
+            diff.path = std::move(pair.rel);
+            outDifferences.push_back(std::move(diff));
+        }
+    }
+    for (auto& list : found) std::move(list.begin(), list.end(), std::back_inserter(outDifferences));
+
+    std::sort(outDifferences.begin(), outDifferences.end(),
+              [](const FileDifference& a, const FileDifference& b) { return a.path < b.path; });
+    return Status::Success();
+}
@@ -0,0 +1,108 @@
+#include "DuTree.h"
+#include "TreeWalker.h"
+#include <algorithm>
+#include <cerrno>
+
+int DuTree::build(const Path& rootDir, const WalkOptions& walkOptions) {
+    root = rootDir;
+    options = walkOptions;
+    nodes.clear();
+    childIndex.clear();
+    namePool.clear();
+
+    nodes.push_back({kNoNode, 0, 0, 0, 0, 0, 0, 0});
+
+    // dirStack[d] 为深度 d 的条目所在目录的节点
+    // 遍历器按深度优先前序访问，因此父节点下标总小于子节点
+    std::vector<uint32_t> dirStack{0};
+    TreeWalker walker;
+    if (!walker.setOptions(options).ok()) {
+        nodes.clear();
+        return EINVAL;
+    }
+    int err = walker.walk(root, [&](WalkEntry& entry) {
+        uint32_t parent = dirStack[static_cast<size_t>(entry.depth)];
+        if (entry.type == FileType::File) {
+            const struct stat* st = entry.stat();
+            if (st) {
+                nodes[parent].ownSize += static_cast<uint64_t>(st->st_size);
+                nodes[parent].fileCount++;
+            }
+        } else if (entry.type == FileType::Directory) {
+            Node dir{parent, static_cast<uint32_t>(namePool.size()), static_cast<uint32_t>(entry.name.size()),
+                     0, 0, 0, 0, 0};
+            namePool.append(entry.name);
+            nodes.push_back(dir);
+            dirStack.resize(static_cast<size_t>(entry.depth) + 1);
+            dirStack.push_back(static_cast<uint32_t>(nodes.size() - 1));
+        }
+        return WalkAction::Continue;
+    });
+    if (err != 0) {
+        nodes.clear();
+        return err;
+    }
+
+    // 自底向上汇总：逆前序遍历时子节点一定先于父节点
+    for (size_t i = nodes.size(); i-- > 0;) {
+        nodes[i].totalSize += nodes[i].ownSize;
+        if (nodes[i].parent != kNoNode) {
+            nodes[nodes[i].parent].totalSize += nodes[i].totalSize;
+            nodes[nodes[i].parent].fileCount += nodes[i].fileCount;
+        }
+    }
+
+    // 子目录按 CSR 方式连续存放，并按名称排序以便二分查找
+    for (size_t i = 1; i < nodes.size(); ++i) nodes[nodes[i].parent].childCount++;
+    uint32_t offset = 0;
+    for (Node& n : nodes) {
+        n.childBegin = offset;
+        offset += n.childCount;
+        n.childCount = 0;
+    }
+    childIndex.resize(offset);
+    for (size_t i = 1; i < nodes.size(); ++i) {
+        Node& parent = nodes[nodes[i].parent];
+        childIndex[parent.childBegin + parent.childCount++] = static_cast<uint32_t>(i);
+    }
+    for (const Node& n : nodes) {
+        auto begin = childIndex.begin() + n.childBegin;
+        std::sort(begin, begin + n.childCount, [&](uint32_t a, uint32_t b) { return name(a) < name(b); });
+    }
+    return 0;
+}
+
+std::string_view DuTree::name(uint32_t index) const {
+    const Node& n = nodes[index];
+    return std::string_view(namePool).substr(n.nameOffset, n.nameLen);
+}
+
+std::vector<uint32_t> DuTree::children(uint32_t index) const {
+    const Node& n = nodes[index];
+    return std::vector<uint32_t>(childIndex.begin() + n.childBegin, childIndex.begin() + n.childBegin + n.childCount);
+}
+
+uint32_t DuTree::findChild(uint32_t parent, std::string_view childName) const {
+    const Node& n = nodes[parent];
+    auto begin = childIndex.begin() + n.childBegin;
+    auto end = begin + n.childCount;
+    auto it = std::lower_bound(begin, end, childName, [&](uint32_t idx, std::string_view key) { return name(idx) < key; });
+    return (it != end && name(*it) == childName) ? *it : kNoNode;
+}
+
+uint32_t DuTree::find(const Path& dirPath) const {
+    if (nodes.empty()) return kNoNode;
+
+    Path rel = dirPath.lexically_relative(root);
+    if (rel.empty()) return kNoNode;
+
+    uint32_t current = 0;
+    for (const auto& part : rel) {
+        const std::string& component = part.native();
+        if (component == "." || component.empty()) continue;
+        if (component == "..") return kNoNode;
+        current = findChild(current, component);
+        if (current == kNoNode) return kNoNode;
+    }
+    return current;
+}
@@ -0,0 +1,233 @@
+#include "FileManager.h"
+#include "AllocTracker.h"
+#include "TreeWalker.h"
+#include "Parallel.h"
+#include "Hash.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t kEdgeBlockSize = 4096;       // 首尾块大小
+constexpr size_t kReadBufferSize = 1 << 20;   // 全文哈希的读缓冲区
+
+// 候选文件，路径存放在公共字符串池中以减少千万级条目的分配开销
+struct Candidate {
+    uint64_t size;
+    uint64_t dev;
+    uint64_t ino;
+    uint64_t pathOffset;
+    uint32_t pathLen;
+    bool readable = true;
+    HashDigest edgeHash;
+    HashDigest fullHash;
+};
+
+int openForRead(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOATIME);
+    if (fd < 0 && errno == EPERM) {
+        // O_NOATIME 仅允许文件属主使用
+        fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    return fd;
+}
+
+// 完整读取 [offset, offset + len)，返回实际读取字节数
+size_t preadFull(int fd, uint8_t* buf, size_t len, off_t offset) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = pread(fd, buf + done, len - done, offset + static_cast<off_t>(done));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (n == 0) break;
+        done += static_cast<size_t>(n);
+    }
+    return done;
+}
+
+// 在 [begin, end) 中找出 key 相同且数量不少于 2 的连续区间，交给 fn 处理
+template <typename Key, typename Fn>
+void forEachRun(std::vector<Candidate*>& items, size_t begin, size_t end, Key key, Fn fn) {
+    std::sort(items.begin() + begin, items.begin() + end,
+        [&](const Candidate* a, const Candidate* b) { return key(*a) < key(*b); });
+    size_t runStart = begin;
+    for (size_t i = begin + 1; i <= end; ++i) {
+        if (i == end || !(key(*items[i]) == key(*items[runStart]))) {
+            if (i - runStart >= 2) fn(runStart, i);
+            runStart = i;
+        }
+    }
+}
+
+} // namespace
+
+Status FileManager::findDuplicates(const Path& dirPath, std::vector<DuplicateGroup>& outGroups) const {
+    AllocScope resultScope(AllocCategory::Results);
+    outGroups.clear();
+
+    fs::path targetDir = resolvePath(dirPath);
+    if (!fs::exists(targetDir) || !fs::is_directory(targetDir)) {
+        return Status::Error(StatusCode::PathNotFound, "Invalid directory", std::move(targetDir));
+    }
+
+    // 阶段 0：遍历目录树，收集非空普通文件的大小和 inode
+    std::string pathPool;
+    std::vector<Candidate> candidates;
+    TreeWalker walker;
+    int err = walker.walk(targetDir, [&](WalkEntry& entry) {
+        if (entry.type != FileType::File) return WalkAction::Continue;
+        const struct stat* st = entry.stat();
+        if (!st || st->st_size == 0) return WalkAction::Continue;
+
+        Candidate c;
+        c.size = static_cast<uint64_t>(st->st_size);
+        c.dev = st->st_dev;
+        c.ino = st->st_ino;
+        c.pathOffset = pathPool.size();
+        c.pathLen = static_cast<uint32_t>(entry.path.size());
+        pathPool.append(entry.path);
+        candidates.push_back(c);
+        return WalkAction::Continue;
+    });
+    if (err != 0) {
+        return Status::SystemError(StatusCode::PermissionDenied, "Cannot open directory", std::move(targetDir), err);
+    }
+
+    auto pathOf = [&](const Candidate& c) {
+        return pathPool.substr(c.pathOffset, c.pathLen);
+    };
+
+    // 阶段 1：按大小分组，同组内按 (dev, ino) 去掉硬链接
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        if (a.size != b.size) return a.size > b.size;
+        if (a.dev != b.dev) return a.dev < b.dev;
+        return a.ino < b.ino;
+    });
+
+    std::vector<Candidate*> sized;
+    for (size_t i = 0; i < candidates.size();) {
+        size_t j = i;
+        size_t uniqueInodes = 0;
+        for (; j < candidates.size() && candidates[j].size == candidates[i].size; ++j) {
+            if (j == i || candidates[j].dev != candidates[j - 1].dev || candidates[j].ino != candidates[j - 1].ino) {
+                ++uniqueInodes;
+            }
+        }
+        if (uniqueInodes >= 2) {
+            for (size_t k = i; k < j; ++k) {
+                if (k == i || candidates[k].dev != candidates[k - 1].dev || candidates[k].ino != candidates[k - 1].ino) {
+                    sized.push_back(&candidates[k]);
+                }
+            }
+        }
+        i = j;
+    }
+
+    // 阶段 2：并行计算首尾块哈希，小文件此时即为全文哈希
+    unsigned threads = defaultThreadCount();
+    std::vector<std::vector<uint8_t>> buffers(threads, std::vector<uint8_t>(kReadBufferSize));
+
+    parallelFor(sized.size(), [&](size_t index, unsigned worker) {
+        Candidate& c = *sized[index];
+        int fd = openForRead(pathOf(c));
+        if (fd < 0) {
+            c.readable = false;
+            return;
+        }
+        uint8_t* buf = buffers[worker].data();
+        ContentHasher hasher;
+        if (c.size <= 2 * kEdgeBlockSize) {
+            size_t n = preadFull(fd, buf, c.size, 0);
+            c.readable = (n == c.size);
+            hasher.update(buf, n);
+        } else {
+            size_t head = preadFull(fd, buf, kEdgeBlockSize, 0);
+            size_t tail = preadFull(fd, buf + kEdgeBlockSize, kEdgeBlockSize,
+                                    static_cast<off_t>(c.size - kEdgeBlockSize));
+            c.readable = (head == kEdgeBlockSize && tail == kEdgeBlockSize);
+            hasher.update(buf, head + tail);
+        }
+        close(fd);
+        c.edgeHash = hasher.digest();
+        c.fullHash = c.edgeHash;
+    }, threads);
+
+    sized.erase(std::remove_if(sized.begin(), sized.end(), [](const Candidate* c) { return !c->readable; }),
+                sized.end());
+
+    // 大小相同的候选仍相邻，在每个大小组内按首尾哈希再分组
+    std::vector<Candidate*> edged;
+    for (size_t i = 0; i < sized.size();) {
+        size_t j = i;
+        while (j < sized.size() && sized[j]->size == sized[i]->size) ++j;
+        forEachRun(sized, i, j, [](const Candidate& c) { return c.edgeHash; }, [&](size_t b, size_t e) {
+            edged.insert(edged.end(), sized.begin() + b, sized.begin() + e);
+        });
+        i = j;
+    }
+
+    // 阶段 3：仅对首尾块无法覆盖的大文件并行计算全文哈希
+    std::vector<Candidate*> needFull;
+    for (Candidate* c : edged) {
+        if (c->size > 2 * kEdgeBlockSize) needFull.push_back(c);
+    }
+
+    parallelFor(needFull.size(), [&](size_t index, unsigned worker) {
+        Candidate& c = *needFull[index];
+        int fd = openForRead(pathOf(c));
+        if (fd < 0) {
+            c.readable = false;
+            return;
+        }
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        uint8_t* buf = buffers[worker].data();
+        ContentHasher hasher;
+        uint64_t offset = 0;
+        while (offset < c.size) {
+            size_t want = static_cast<size_t>(std::min<uint64_t>(kReadBufferSize, c.size - offset));
+            size_t n = preadFull(fd, buf, want, static_cast<off_t>(offset));
+            if (n == 0) break;
+            hasher.update(buf, n);
+            offset += n;
+        }
+        // 读取途中文件被截断则不参与比较
+        c.readable = (offset == c.size);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+        c.fullHash = hasher.digest();
+    }, threads);
+
+    edged.erase(std::remove_if(edged.begin(), edged.end(), [](const Candidate* c) { return !c->readable; }),
+                edged.end());
+
+    // 最终分组：大小与全文哈希均相同
+    for (size_t i = 0; i < edged.size();) {
+        size_t j = i;
+        while (j < edged.size() && edged[j]->size == edged[i]->size) ++j;
+        forEachRun(edged, i, j, [](const Candidate& c) { return c.fullHash; }, [&](size_t b, size_t e) {
+            DuplicateGroup group;
+            group.size = edged[b]->size;
+            for (size_t k = b; k < e; ++k) {
+                group.paths.emplace_back(pathOf(*edged[k]));
+            }
+            std::sort(group.paths.begin(), group.paths.end());
+            outGroups.push_back(std::move(group));
+        });
+        i = j;
+    }
+
+    std::sort(outGroups.begin(), outGroups.end(), [](const DuplicateGroup& a, const DuplicateGroup& b) {
+        uintmax_t wastedA = a.size * (a.paths.size() - 1);
+        uintmax_t wastedB = b.size * (b.paths.size() - 1);
+        if (wastedA != wastedB) return wastedA > wastedB;
+        return a.paths.front() < b.paths.front();
+    });
+
+    return Status::Success();
+}
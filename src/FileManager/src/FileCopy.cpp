@@ -0,0 +1,111 @@
+#include "FileCopy.h"
+#include "IoThrottle.h"
+#include <algorithm>
+#include <cerrno>
+#include <vector>
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kCopyChunkSize = size_t(1) << 30;   // 单次内核复制上限
+constexpr size_t kBufferSize = size_t(1) << 20;      // 用户态回退时的缓冲区
+
+int copyWithReadWrite(int inFd, int outFd, uint64_t length, off_t* inOffset) {
+    IoThrottle& throttle = IoThrottle::instance();
+    std::vector<char> buffer(kBufferSize);
+    while (length > 0) {
+        size_t want = static_cast<size_t>(std::min<uint64_t>({length, buffer.size(), throttle.maxChunk()}));
+        IoThrottle::Slot slot(throttle);
+        throttle.acquire(want);
+        ssize_t n = inOffset ? pread(inFd, buffer.data(), want, *inOffset) : read(inFd, buffer.data(), want);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno;
+        }
+        if (n == 0) break;
+        if (inOffset) *inOffset += n;
+        for (ssize_t written = 0; written < n;) {
+            ssize_t w = write(outFd, buffer.data() + written, static_cast<size_t>(n - written));
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                return errno;
+            }
+            written += w;
+        }
+        length -= static_cast<uint64_t>(n);
+    }
+    return 0;
+}
+
+} // namespace
+
+int copyFileData(int inFd, int outFd, uint64_t length, off_t* inOffset) {
+    IoThrottle& throttle = IoThrottle::instance();
+    bool useCopyRange = true;
+    bool useSendfile = true;
+    while (length > 0) {
+        size_t chunk = static_cast<size_t>(std::min<uint64_t>(length, kCopyChunkSize));
+        chunk = static_cast<size_t>(std::min<uint64_t>(chunk, throttle.maxChunk()));
+        if (!useCopyRange && !useSendfile) {
+            return copyWithReadWrite(inFd, outFd, length, inOffset);
+        }
+
+        IoThrottle::Slot slot(throttle);
+        throttle.acquire(chunk);
+        ssize_t n = -1;
+        if (useCopyRange) {
+            n = copy_file_range(inFd, inOffset, outFd, nullptr, chunk, 0);
+            if (n < 0 && (errno == EXDEV || errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP || errno == EBADF)) {
+                useCopyRange = false;
+                continue;
+            }
+        } else {
+            n = sendfile(outFd, inFd, inOffset, chunk);
+            if (n < 0 && (errno == EINVAL || errno == ENOSYS)) {
+                useSendfile = false;
+                continue;
+            }
+        }
+
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno;
+        }
+        if (n == 0) break; // 源文件在复制过程中被截断
+        length -= static_cast<uint64_t>(n);
+    }
+    return 0;
+}
+
+int copyRegularFile(const std::string& srcPath, const std::string& dstPath) {
+    int in = open(srcPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) return errno;
+
+    struct stat st;
+    if (fstat(in, &st) != 0) {
+        int err = errno;
+        close(in);
+        return err;
+    }
+
+    int out = open(dstPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, st.st_mode & 07777);
+    if (out < 0) {
+        int err = errno;
+        close(in);
+        return err;
+    }
+
+    posix_fadvise(in, 0, 0, POSIX_FADV_SEQUENTIAL);
+    int err = copyFileData(in, out, static_cast<uint64_t>(st.st_size));
+    if (err == 0) {
+        // 覆盖已有文件时 open 不会修改权限，这里显式同步
+        fchmod(out, st.st_mode & 07777);
+        struct timespec times[2] = {st.st_atim, st.st_mtim};
+        futimens(out, times);
+    }
+    if (close(out) != 0 && err == 0) err = errno;
+    close(in);
+    return err;
+}
@@ -1,4 +1,12 @@
 #include "FileManager.h"
+#include "AllocTracker.h"
+#include "TreeWalker.h"
+#include "NameMatcher.h"
+#include "DuTree.h"
+#include "FileCopy.h"
+#include "TrashManager.h"
+#include "IoThrottle.h"
+#include "Parallel.h"
 #include <algorithm>
 #include <sstream>
 #include <iostream>
@@ -6,12 +14,29 @@
 #include <iomanip>
 #include <chrono>
 #include <unistd.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
 #include <pwd.h>
 #include <climits>
+#include <cstring>
+#include <mutex>
 
 namespace fs = std::filesystem;
 using std::chrono::system_clock;
 
+namespace {
+
+constexpr size_t kParallelListThreshold = 64; // ls 需要 stat 的条目数达到此值时并行获取
+
+} // namespace
+
+// 可在多个实例间共享的缓存，占用树构建后只读，替换和失效时加锁
+struct FileManager::SharedCaches {
+    std::mutex mutex;
+    std::shared_ptr<const DuTree> duTree; // 目录占用树 (du --tree)
+};
+
 // 构造函数
 FileManager::FileManager(const std::string& initPath) {
     // 初始化为模拟的默认路径
@@ -33,6 +58,13 @@ FileManager::FileManager(const std::string& initPath) {
             throw std::runtime_error("Directory not found: " + initPath);
         }
     }
+    caches = std::make_shared<SharedCaches>();
+    trash = std::make_shared<TrashManager>();
+}
+
+FileManager::FileManager(const std::string& initPath, const FileManager& other) : FileManager(initPath) {
+    caches = other.caches;
+    trash = other.trash;
 }
 // 析构函数
 FileManager::~FileManager() {//释放声明的内存
@@ -69,10 +101,10 @@ Status FileManager::changeDirectory(const Path& targetPath) {
 
     // 校验目录合法性
     if (!fs::exists(newPath)) {
-        return Status::Error(StatusCode::PathNotFound, "Invalid directory: " + newPath.string());
+        return Status::Error(StatusCode::PathNotFound, "Invalid directory", std::move(newPath));
     }
     if (!fs::is_directory(newPath)) {
-        return Status::Error(StatusCode::NotADirectory, "Not a directory: " + newPath.string());
+        return Status::Error(StatusCode::NotADirectory, "Not a directory", std::move(newPath));
     }
 
     // 切换成功
@@ -84,49 +116,134 @@ Status FileManager::changeDirectory(const Path& targetPath) {
 std::string FileManager::fileTimeToString(const fs::file_time_type& fileTime) const {
     auto sysTime = std::chrono::file_clock::to_sys(fileTime);
     auto timeT = system_clock::to_time_t(sysTime);
-    std::tm tm = *std::localtime(&timeT);
+    std::tm tm;
+    localtime_r(&timeT, &tm);
     std::stringstream ss;
     ss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
     return ss.str();
 }
 
+// 辅助函数：将相对路径解析为基于当前工作目录的路径，空路径即当前工作目录
+Path FileManager::resolvePath(const Path& targetPath) const {
+    if (targetPath.empty()) return currentPath;
+    return targetPath.is_absolute() ? targetPath : currentPath / targetPath;
+}
+
+// 辅助函数：目录被修改后丢弃受影响的缓存（占用树）
+void FileManager::invalidateCaches(const Path& changedPath) {
+    std::lock_guard<std::mutex> lock(caches->mutex);
+    if (!caches->duTree) return;
+    Path changed = changedPath.lexically_normal();
+    Path inside = changed.lexically_relative(caches->duTree->rootPath());
+    Path above = caches->duTree->rootPath().lexically_relative(changed);
+    if ((!inside.empty() && *inside.begin() != "..") || (!above.empty() && *above.begin() != "..")) {
+        caches->duTree.reset();
+    }
+}
+
+// 辅助函数：取得当前的占用树，持有返回值期间即使缓存被替换也可安全读取
+std::shared_ptr<const DuTree> FileManager::loadDuTree() const {
+    std::lock_guard<std::mutex> lock(caches->mutex);
+    return caches->duTree;
+}
+
+// 辅助函数：删除、覆盖前请求确认
+bool FileManager::askConfirm(const std::string& question) const {
+    if (confirm) return confirm(question);
+    std::cout << question << " (y/n) ";
+    char choice;
+    std::cin >> choice;
+    return choice == 'y' || choice == 'Y';
+}
+
 // 辅助函数：计算目录总大小（递归包含子文件）
-uintmax_t FileManager::calculateDirTotalSize(const Path& dirPath) const {
-    uintmax_t totalSize = 0;
-    for (const auto& entry : fs::recursive_directory_iterator(dirPath)) {
-        if (entry.is_regular_file()) {
-            totalSize += entry.file_size();
+// 目录位于以相同选项构建的占用树内时直接查询，不访问磁盘
+uintmax_t FileManager::calculateDirTotalSize(const Path& dirPath, const WalkOptions& options) const {
+    if (auto duTree = loadDuTree(); duTree && duTree->walkOptions() == options) {
+        uint32_t node = duTree->find(dirPath.lexically_normal());
+        if (node != DuTree::kNoNode) {
+            return duTree->node(node).totalSize;
         }
     }
+
+    uintmax_t totalSize = 0;
+    TreeWalker walker;
+    if (!walker.setOptions(options).ok()) return 0;
+    walker.walk(dirPath, [&](WalkEntry& entry) {
+        if (entry.type == FileType::File) {
+            if (const struct stat* st = entry.stat()) totalSize += static_cast<uintmax_t>(st->st_size);
+        }
+        return WalkAction::Continue;
+    });
     return totalSize;
 }
 
 // 列出当前目录文件（支持按大小/时间排序）
 Status FileManager::listFiles(SortMode sortMode, std::vector<FileInfo>& outFiles) const {
+    return listFiles(sortMode, FieldType | FieldSize | FieldModifyTime | FieldDirTotalSize, outFiles);
+}
+
+Status FileManager::listFiles(SortMode sortMode, uint32_t fields, std::vector<FileInfo>& outFiles) const {
+    AllocScope resultScope(AllocCategory::Results);
     outFiles.clear();
 
-    // 遍历当前目录
-    try {
-        for (const auto& entry : fs::directory_iterator(currentPath)) {
-            FileInfo info;
-            info.name = entry.path().filename().string();
-            info.path = entry.path();
-            info.type = entry.is_directory() ? FileType::Directory : FileType::File;
-            info.modifyTime = entry.last_write_time();
-
-            // 设置大小（文件：字节数；目录：-，排序时用总大小）
-            if (info.type == FileType::File) {
-                info.size = entry.file_size();
-            } else {
-                info.size = 0; // 列表显示为 "-"，排序时单独处理
-                info.dirTotalSize = calculateDirTotalSize(entry.path());
+    // 排序键需要的字段
+    if (sortMode == SortMode::BySize) fields |= FieldSize | FieldDirTotalSize;
+    if (sortMode == SortMode::ByTime) fields |= FieldModifyTime;
+    if (fields & (FieldSize | FieldDirTotalSize)) fields |= FieldType;
+    const bool needStat = (fields & (FieldSize | FieldModifyTime | FieldOwner | FieldMode | FieldBlocks)) != 0;
+
+    // 一次读取全部目录项 (getdents)，名称、d_type、d_ino 不需要 stat
+    int dirFd = open(currentPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    DIR* dir = dirFd >= 0 ? fdopendir(dirFd) : nullptr;
+    if (!dir) {
+        int err = errno;
+        if (dirFd >= 0) close(dirFd);
+        return Status::SystemError(StatusCode::PermissionDenied, "Permission denied", currentPath, err);
+    }
+    std::vector<unsigned char> entryTypes;
+    while (dirent* entry = readdir(dir)) {
+        std::string_view name = entry->d_name;
+        if (name == "." || name == "..") continue;
+        FileInfo info;
+        info.name = name;
+        info.path = currentPath / info.name;
+        info.type = FileType::Unknown;
+        info.inode = entry->d_ino;
+        outFiles.push_back(std::move(info));
+        entryTypes.push_back(entry->d_type);
+    }
+
+    // 只对需要的字段 stat；与 directory_entry 一致跟随符号链接，悬空链接取链接本身
+    auto fill = [&](size_t index, unsigned) {
+        FileInfo& info = outFiles[index];
+        unsigned char entryType = entryTypes[index];
+        bool typeKnown = entryType != DT_UNKNOWN && entryType != DT_LNK;
+        if (typeKnown) info.type = entryType == DT_DIR ? FileType::Directory : FileType::File;
+
+        if (needStat || ((fields & FieldType) && !typeKnown)) {
+            struct stat st;
+            if (fstatat(dirFd, info.name.c_str(), &st, 0) == 0 ||
+                fstatat(dirFd, info.name.c_str(), &st, AT_SYMLINK_NOFOLLOW) == 0) {
+                info.type = S_ISDIR(st.st_mode) ? FileType::Directory : FileType::File;
+                if (fields & FieldSize) info.size = info.type == FileType::File ? static_cast<uintmax_t>(st.st_size) : 0;
+                if (fields & FieldModifyTime) info.modifyTime = toFileTime(st.st_mtim);
+                if (fields & FieldOwner) {
+                    info.uid = st.st_uid;
+                    info.gid = st.st_gid;
+                }
+                if (fields & FieldMode) info.mode = st.st_mode;
+                if (fields & FieldBlocks) info.blocks = static_cast<uint64_t>(st.st_blocks);
             }
-
-            outFiles.push_back(info);
         }
-    } catch (const fs::filesystem_error& e) {
-        return Status::Error(StatusCode::PermissionDenied, "Permission denied: " + std::string(e.what()));
-    }
+        if ((fields & FieldDirTotalSize) && info.type == FileType::Directory) {
+            info.dirTotalSize = calculateDirTotalSize(info.path);
+        }
+    };
+    // 需要 stat 时并行，网络文件系统上 stat 的延迟可以重叠
+    bool expensive = needStat || (fields & FieldDirTotalSize);
+    parallelFor(outFiles.size(), fill, expensive && outFiles.size() >= kParallelListThreshold ? 0 : 1);
+    closedir(dir);
 
     // 根据排序模式排序
     switch (sortMode) {
@@ -169,7 +286,7 @@ Status FileManager::getFileStat(const std::string& targetName, FileInfo& outInfo
 
     fs::path targetPath = currentPath / targetName;
     if (!fs::exists(targetPath)) {
-        return Status::Error(StatusCode::PathNotFound, "Target not found: " + targetName);
+        return Status::Error(StatusCode::PathNotFound, "Target not found", targetName);
     }
 
     // 填充文件信息
@@ -194,18 +311,29 @@ Status FileManager::getFileStat(const std::string& targetName, FileInfo& outInfo
 
 // 计算文件夹总大小（du 命令，自动适配 KB/MB）
 Status FileManager::calculateDirSize(const Path& dirPath, uintmax_t& outSize) const {
+    return calculateDirSize(dirPath, WalkOptions(), outSize);
+}
+
+// 计算文件夹总大小（指定剪枝选项）
+Status FileManager::calculateDirSize(const Path& dirPath, const WalkOptions& options, uintmax_t& outSize) const {
+    AllocScope resultScope(AllocCategory::Results);
     fs::path targetPath = dirPath.is_absolute() ? dirPath : currentPath / dirPath;
 
     // 校验目录合法性
     if (!fs::exists(targetPath)) {
-        return Status::Error(StatusCode::PathNotFound, "Directory not found: " + targetPath.string());
+        return Status::Error(StatusCode::PathNotFound, "Directory not found", std::move(targetPath));
     }
     if (!fs::is_directory(targetPath)) {
-        return Status::Error(StatusCode::NotADirectory, "Not a directory: " + targetPath.string());
+        return Status::Error(StatusCode::NotADirectory, "Not a directory", std::move(targetPath));
     }
 
-    // 递归计算总大小
-    outSize = calculateDirTotalSize(targetPath);
+    // 先校验排除规则，再递归计算总大小
+    TreeWalker walker;
+    Status status = walker.setOptions(options);
+    if (!status.ok()) {
+        return status;
+    }
+    outSize = calculateDirTotalSize(targetPath, options);
     return Status::Success();
 }
 
@@ -222,16 +350,18 @@ Status FileManager::createFile(const std::string& filename) {
 
     fs::path filePath = currentPath / filename;
     if (pathExists(filePath)) {
-        return Status::Error(StatusCode::PathAlreadyExists, "File already exists: " + filename);
+        return Status::Error(StatusCode::PathAlreadyExists, "File already exists", filename);
     }
 
     // 创建空文件
     std::ofstream file(filePath);
     if (!file.is_open()) {
-        return Status::Error(StatusCode::PermissionDenied, "Permission denied: Cannot create file " + filename);
+        return Status::Error(StatusCode::PermissionDenied, "Permission denied: Cannot create file", filename);
     }
     file.close();
 
+    invalidateCaches(filePath);
+
     return Status::Success();
 }
 
@@ -239,7 +369,7 @@ Status FileManager::createFile(const std::string& filename) {
 Status FileManager::createFile(const Path& filePath) {
     fs::path targetPath = filePath.is_absolute() ? filePath : currentPath / filePath;
     if (pathExists(targetPath)) {
-        return Status::Error(StatusCode::PathAlreadyExists, "File already exists: " + targetPath.string());
+        return Status::Error(StatusCode::PathAlreadyExists, "File already exists", std::move(targetPath));
     }
 
     // 创建父目录（如果不存在）
@@ -251,10 +381,12 @@ Status FileManager::createFile(const Path& filePath) {
     // 创建空文件
     std::ofstream file(targetPath);
     if (!file.is_open()) {
-        return Status::Error(StatusCode::PermissionDenied, "Permission denied: Cannot create file " + targetPath.string());
+        return Status::Error(StatusCode::PermissionDenied, "Permission denied: Cannot create file", std::move(targetPath));
     }
     file.close();
 
+    invalidateCaches(targetPath);
+
     return Status::Success();
 }
 
@@ -266,16 +398,18 @@ Status FileManager::createDirectory(const std::string& dirname) {
 
     fs::path dirPath = currentPath / dirname;
     if (pathExists(dirPath)) {
-        return Status::Error(StatusCode::PathAlreadyExists, "Directory already exists: " + dirname);
+        return Status::Error(StatusCode::PathAlreadyExists, "Directory already exists", dirname);
     }
 
     // 创建文件夹
     try {
         fs::create_directory(dirPath);
     } catch (const fs::filesystem_error& e) {
-        return Status::Error(StatusCode::PermissionDenied, "Permission denied: Cannot create directory " + dirname);
+        return Status::Error(StatusCode::PermissionDenied, "Permission denied: Cannot create directory", dirname);
     }
 
+    invalidateCaches(dirPath);
+
     return Status::Success();
 }
 
@@ -283,16 +417,18 @@ Status FileManager::createDirectory(const std::string& dirname) {
 Status FileManager::createDirectory(const Path& dirPath) {
     fs::path targetPath = dirPath.is_absolute() ? dirPath : currentPath / dirPath;
     if (pathExists(targetPath)) {
-        return Status::Error(StatusCode::PathAlreadyExists, "Directory already exists: " + targetPath.string());
+        return Status::Error(StatusCode::PathAlreadyExists, "Directory already exists", std::move(targetPath));
     }
 
     // 创建文件夹（递归创建父目录）
     try {
         fs::create_directories(targetPath);
     } catch (const fs::filesystem_error& e) {
-        return Status::Error(StatusCode::PermissionDenied, "Permission denied: Cannot create directory " + targetPath.string());
+        return Status::Error(StatusCode::PermissionDenied, "Permission denied: Cannot create directory", std::move(targetPath));
     }
 
+    invalidateCaches(targetPath);
+
     return Status::Success();
 }
 
@@ -304,39 +440,38 @@ Status FileManager::removePath(const std::string& targetName) {
 
     fs::path targetPath = currentPath / targetName;
     if (!fs::exists(targetPath)) {
-        return Status::Error(StatusCode::PathNotFound, "Target not found: " + targetName);
+        return Status::Error(StatusCode::PathNotFound, "Target not found", targetName);
     }
 
     // 区分文件和目录
     if (fs::is_regular_file(targetPath)) {
         // 删除文件：二次确认
-        std::cout << "Are you sure to delete " << targetName << "? (y/n) ";
-        char choice;
-        std::cin >> choice;
-        if (choice != 'y' && choice != 'Y') {
+        if (!askConfirm("Are you sure to delete " + targetName + "?")) {
             return Status::Success("Delete cancelled");
         }
 
         try {
             fs::remove(targetPath);
         } catch (const fs::filesystem_error& e) {
-            return Status::Error(StatusCode::PermissionDenied, "Permission denied: Cannot delete file " + targetName);
+            return Status::Error(StatusCode::PermissionDenied, "Permission denied: Cannot delete file", targetName);
         }
     } else if (fs::is_directory(targetPath)) {
         // 删除目录：仅允许空目录（rmdir 逻辑）
         if (!fs::is_empty(targetPath)) {
-            return Status::Error(StatusCode::NotEmpty, "Directory not empty: " + targetName);
+            return Status::Error(StatusCode::NotEmpty, "Directory not empty", targetName);
         }
 
         try {
             fs::remove(targetPath);
         } catch (const fs::filesystem_error& e) {
-            return Status::Error(StatusCode::PermissionDenied, "Permission denied: Cannot delete directory " + targetName);
+            return Status::Error(StatusCode::PermissionDenied, "Permission denied: Cannot delete directory", targetName);
         }
     } else {
-        return Status::Error(StatusCode::UnknownError, "Unsupported target type: " + targetName);
+        return Status::Error(StatusCode::UnknownError, "Unsupported target type", targetName);
     }
 
+    invalidateCaches(targetPath);
+
     return Status::Success("Delete successfully");
 }
 
@@ -344,37 +479,36 @@ Status FileManager::removePath(const std::string& targetName) {
 Status FileManager::removePath(const Path& targetPath) {
     fs::path absPath = targetPath.is_absolute() ? targetPath : currentPath / targetPath;
     if (!fs::exists(absPath)) {
-        return Status::Error(StatusCode::PathNotFound, "Target not found: " + absPath.string());
+        return Status::Error(StatusCode::PathNotFound, "Target not found", std::move(absPath));
     }
 
     if (fs::is_regular_file(absPath)) {
         // 删除文件：二次确认
-        std::cout << "Are you sure to delete " << absPath.filename().string() << "? (y/n) ";
-        char choice;
-        std::cin >> choice;
-        if (choice != 'y' && choice != 'Y') {
+        if (!askConfirm("Are you sure to delete " + absPath.filename().string() + "?")) {
             return Status::Success("Delete cancelled");
         }
 
         try {
             fs::remove(absPath);
         } catch (const fs::filesystem_error& e) {
-            return Status::Error(StatusCode::PermissionDenied, "Permission denied: Cannot delete file " + absPath.string());
+            return Status::Error(StatusCode::PermissionDenied, "Permission denied: Cannot delete file", std::move(absPath));
         }
     } else if (fs::is_directory(absPath)) {
         if (!fs::is_empty(absPath)) {
-            return Status::Error(StatusCode::NotEmpty, "Directory not empty: " + absPath.string());
+            return Status::Error(StatusCode::NotEmpty, "Directory not empty", std::move(absPath));
         }
 
         try {
             fs::remove(absPath);
         } catch (const fs::filesystem_error& e) {
-            return Status::Error(StatusCode::PermissionDenied, "Permission denied: Cannot delete directory " + absPath.string());
+            return Status::Error(StatusCode::PermissionDenied, "Permission denied: Cannot delete directory", std::move(absPath));
         }
     } else {
-        return Status::Error(StatusCode::UnknownError, "Unsupported target type: " + absPath.string());
+        return Status::Error(StatusCode::UnknownError, "Unsupported target type", std::move(absPath));
     }
 
+    invalidateCaches(absPath);
+
     return Status::Success("Delete successfully");
 }
 
@@ -386,7 +520,7 @@ Status FileManager::copyItem(const Path& src, const Path& dst) {
 
     // 校验源路径存在
     if (!fs::exists(srcPath)) {
-        return Status::Error(StatusCode::PathNotFound, "Source not found: " + srcPath.string());
+        return Status::Error(StatusCode::PathNotFound, "Source not found", std::move(srcPath));
     }
 
     // 处理目标路径（如果是目录，自动拼接源文件名）
@@ -396,30 +530,37 @@ Status FileManager::copyItem(const Path& src, const Path& dst) {
 
     // 目标文件已存在：询问是否覆盖
     if (fs::exists(dstPath)) {
-        std::cout << "File exists in target: Overwrite? (y/n) ";
-        char choice;
-        std::cin >> choice;
-        if (choice != 'y' && choice != 'Y') {
+        std::error_code ec;
+        if (fs::equivalent(srcPath, dstPath, ec)) {
+            return Status::Error(StatusCode::InvalidArguments, "Source and destination are the same file", std::move(dstPath));
+        }
+        if (!askConfirm("File exists in target: Overwrite?")) {
             return Status::Success("Copy cancelled");
         }
     }
 
     // 执行复制（文件）
+    // 先写同目录下的临时文件再 rename，复制失败时原有的目标保持不变
     if (fs::is_regular_file(srcPath)) {
-        try {
-            fs::copy(srcPath, dstPath, fs::copy_options::overwrite_existing);
-        } catch (const fs::filesystem_error& e) {
-            return Status::Error(StatusCode::CopyFailed, "Copy failed: " + std::string(e.what()));
+        std::string to = dstPath.string();
+        std::string tmp = (dstPath.parent_path() / ("." + dstPath.filename().string() + ".mfecopy")).string();
+        int err = copyRegularFile(srcPath.string(), tmp);
+        if (err == 0 && rename(tmp.c_str(), to.c_str()) != 0) err = errno;
+        if (err != 0) {
+            unlink(tmp.c_str());
+            return Status::SystemError(StatusCode::CopyFailed, "Copy failed", std::move(srcPath), err);
         }
     } else {
         // 复制目录（递归）
         try {
             fs::copy(srcPath, dstPath, fs::copy_options::recursive | fs::copy_options::overwrite_existing);
         } catch (const fs::filesystem_error& e) {
-            return Status::Error(StatusCode::CopyFailed, "Copy directory failed: " + std::string(e.what()));
+            return Status::SystemError(StatusCode::CopyFailed, "Copy directory failed", e.path1(), e.code().value());
         }
     }
 
+    invalidateCaches(dstPath);
+
     return Status::Success("Copy successfully");
 }
 
@@ -430,7 +571,7 @@ Status FileManager::moveItem(const Path& src, const Path& dst) {
 
     // 校验源路径存在
     if (!fs::exists(srcPath)) {
-        return Status::Error(StatusCode::PathNotFound, "Source not found: " + srcPath.string());
+        return Status::Error(StatusCode::PathNotFound, "Source not found", std::move(srcPath));
     }
 
     // 处理目标路径（目录则拼接源文件名）
@@ -440,10 +581,7 @@ Status FileManager::moveItem(const Path& src, const Path& dst) {
 
     // 目标已存在：询问是否覆盖
     if (fs::exists(dstPath)) {
-        std::cout << "Target exists: Overwrite? (y/n) ";
-        char choice;
-        std::cin >> choice;
-        if (choice != 'y' && choice != 'Y') {
+        if (!askConfirm("Target exists: Overwrite?")) {
             return Status::Success("Move cancelled");
         }
         // 先删除目标（避免重命名失败）
@@ -463,10 +601,13 @@ Status FileManager::moveItem(const Path& src, const Path& dst) {
             }
             fs::remove_all(srcPath);
         } catch (const fs::filesystem_error& e2) {
-            return Status::Error(StatusCode::MoveFailed, "Move failed: " + std::string(e2.what()));
+            return Status::SystemError(StatusCode::MoveFailed, "Move failed", e2.path1(), e2.code().value());
         }
     }
 
+    invalidateCaches(srcPath);
+    invalidateCaches(dstPath);
+
     return Status::Success("Move successfully");
 }
 
@@ -477,39 +618,230 @@ Status FileManager::search(const std::string& keyword, std::vector<FileInfo>& ou
 
 // 搜索文件/目录（指定目录重载）
 Status FileManager::search(const Path& dirPath, const std::string& keyword, std::vector<FileInfo>& outResults) const {
-    outResults.clear();
     if (keyword.empty()) {
+        outResults.clear();
         return Status::Error(StatusCode::InvalidArguments, "Missing keyword: Please enter 'search [keyword]'");
     }
+    SearchOptions options;
+    options.pattern = keyword;
+    return search(dirPath, options, outResults);
+}
 
-    fs::path targetDir = dirPath.is_absolute() ? dirPath : currentPath / dirPath;
+// 搜索文件/目录（指定匹配方式）
+Status FileManager::search(const Path& dirPath, const SearchOptions& options, std::vector<FileInfo>& outResults) const {
+    AllocScope resultScope(AllocCategory::Results);
+    outResults.clear();
+
+    fs::path targetDir = resolvePath(dirPath);
     if (!fs::exists(targetDir) || !fs::is_directory(targetDir)) {
-        return Status::Error(StatusCode::PathNotFound, "Invalid directory: " + targetDir.string());
+        return Status::Error(StatusCode::PathNotFound, "Invalid directory", std::move(targetDir));
     }
 
-    // 递归遍历目录，不区分大小写匹配关键词
-    std::string lowerKeyword = keyword;
-    std::transform(lowerKeyword.begin(), lowerKeyword.end(), lowerKeyword.begin(), ::tolower);
+    // 模式只编译一次，遍历中逐个文件名匹配，不产生分配
+    bool matchAll = options.pattern.empty();
+    if (matchAll && !options.hasFilters()) {
+        return Status::Error(StatusCode::InvalidArguments, "Missing keyword: Please enter 'search [keyword]'");
+    }
+    NameMatcher matcher;
+    if (!matchAll) {
+        Status compiled = NameMatcher::compile(options.mode, options.pattern, matcher);
+        if (!compiled.ok()) {
+            return compiled;
+        }
+    }
 
-    try {
-        for (const auto& entry : fs::recursive_directory_iterator(targetDir)) {
-            std::string filename = entry.path().filename().string();
-            std::string lowerFilename = filename;
-            std::transform(lowerFilename.begin(), lowerFilename.end(), lowerFilename.begin(), ::tolower);
-
-            // 关键词匹配
-            if (lowerFilename.find(lowerKeyword) != std::string::npos) {
-                FileInfo info;
-                info.name = filename;
-                info.path = entry.path();
-                info.type = entry.is_directory() ? FileType::Directory : FileType::File;
-                info.modifyTime = entry.last_write_time();
-                outResults.push_back(info);
-            }
+    // 过滤按代价从低到高求值：名称 -> d_type -> stat
+    const bool needsStat = options.needsStat();
+    TreeWalker walker;
+    Status walkStatus = walker.setOptions(options.walk);
+    if (!walkStatus.ok()) {
+        return walkStatus;
+    }
+    int err = walker.walk(targetDir, [&](WalkEntry& entry) {
+        if (!matchAll && !matcher.matches(entry.name)) return WalkAction::Continue;
+        if (options.type && entry.type != *options.type) return WalkAction::Continue;
+
+        FileInfo info;
+        if (needsStat) {
+            const struct stat* st = entry.stat();
+            if (!st) return WalkAction::Continue;
+            uintmax_t size = static_cast<uintmax_t>(st->st_size);
+            bool isDir = entry.type == FileType::Directory;
+            if (options.minSize && (isDir || size < *options.minSize)) return WalkAction::Continue;
+            if (options.maxSize && (isDir || size > *options.maxSize)) return WalkAction::Continue;
+
+            fs::file_time_type mtime = toFileTime(st->st_mtim);
+            if (options.modifiedBefore && mtime >= *options.modifiedBefore) return WalkAction::Continue;
+            if (options.modifiedAfter && mtime <= *options.modifiedAfter) return WalkAction::Continue;
+            info.size = isDir ? 0 : size;
+            info.modifyTime = mtime;
         }
-    } catch (const fs::filesystem_error& e) {
-        return Status::Error(StatusCode::PermissionDenied, "Search failed: Permission denied - " + std::string(e.what()));
+
+        info.name = std::string(entry.name);
+        info.path = Path(entry.path);
+        info.type = entry.type;
+        outResults.push_back(std::move(info));
+        return WalkAction::Continue;
+    });
+    if (err != 0) {
+        return Status::Error(StatusCode::PermissionDenied, "Search failed: Permission denied", std::move(targetDir));
+    }
+
+    return Status::Success();
+}
+
+// 构建或查询目录占用树（du --tree 命令）
+Status FileManager::diskUsageTree(const Path& dirPath, bool rescan, const WalkOptions& options,
+                                  DiskUsageEntry& outRoot, std::vector<DiskUsageEntry>& outChildren) {
+    AllocScope resultScope(AllocCategory::Results);
+    outChildren.clear();
+    fs::path targetPath = resolvePath(dirPath).lexically_normal();
+    if (!targetPath.has_filename() && targetPath != targetPath.root_path()) {
+        targetPath = targetPath.parent_path();
+    }
+
+    if (!fs::exists(targetPath)) {
+        return Status::Error(StatusCode::PathNotFound, "Directory not found", std::move(targetPath));
+    }
+    if (!fs::is_directory(targetPath)) {
+        return Status::Error(StatusCode::NotADirectory, "Not a directory", std::move(targetPath));
+    }
+
+    TreeWalker walker;
+    Status status = walker.setOptions(options);
+    if (!status.ok()) {
+        return status;
+    }
+
+    // 已有以相同选项构建、覆盖该目录的占用树时直接复用，否则以该目录为根重新构建
+    std::shared_ptr<const DuTree> duTree = rescan ? nullptr : loadDuTree();
+    if (duTree && duTree->walkOptions() != options) duTree = nullptr;
+    uint32_t node = duTree ? duTree->find(targetPath) : DuTree::kNoNode;
+    if (node == DuTree::kNoNode) {
+        auto tree = std::make_shared<DuTree>();
+        int err = tree->build(targetPath, options);
+        if (err != 0) {
+            return Status::SystemError(StatusCode::PermissionDenied, "Cannot open directory", std::move(targetPath), err);
+        }
+        duTree = std::move(tree);
+        node = 0;
+        std::lock_guard<std::mutex> lock(caches->mutex);
+        caches->duTree = duTree;
+    }
+
+    const DuTree::Node& rootNode = duTree->node(node);
+    outRoot = {targetPath.filename().string(), targetPath, rootNode.totalSize, rootNode.fileCount};
+    for (uint32_t child : duTree->children(node)) {
+        const DuTree::Node& childNode = duTree->node(child);
+        std::string name(duTree->name(child));
+        outChildren.push_back({name, targetPath / name, childNode.totalSize, childNode.fileCount});
+    }
+    std::sort(outChildren.begin(), outChildren.end(), [](const DiskUsageEntry& a, const DiskUsageEntry& b) {
+        if (a.totalSize != b.totalSize) return a.totalSize > b.totalSize;
+        return a.name < b.name;
+    });
+
+    return Status::Success();
+}
+
+// 设置 I/O 限制（throttle 命令）
+Status FileManager::setIoLimits(const IoLimits& limits) {
+    IoThrottle::instance().setLimits(limits);
+    return Status::Success();
+}
+
+// 获取当前 I/O 限制
+Status FileManager::getIoLimits(IoLimits& outLimits) const {
+    outLimits = IoThrottle::instance().limits();
+    return Status::Success();
+}
+
+// 移入回收站（rm 命令）
+Status FileManager::trashPath(const Path& targetPath, TrashEntry& outEntry) {
+    if (targetPath.empty()) {
+        return Status::Error(StatusCode::InvalidArguments, "Missing target: Please enter 'rm [path]'");
+    }
+    fs::path absPath = resolvePath(targetPath).lexically_normal();
+    if (!absPath.has_filename()) absPath = absPath.parent_path();
+
+    std::error_code ec;
+    if (!fs::exists(fs::symlink_status(absPath, ec))) {
+        return Status::Error(StatusCode::PathNotFound, "Target not found", std::move(absPath));
+    }
+    // 不能删除当前工作目录及其上级
+    fs::path rel = currentPath.lexically_normal().lexically_relative(absPath);
+    if (absPath == absPath.root_path() || (!rel.empty() && *rel.begin() != "..")) {
+        return Status::Error(StatusCode::InvalidArguments, "Cannot remove the current directory or its parent", std::move(absPath));
+    }
+
+    Status status = trash->moveToTrash(absPath, outEntry);
+    if (!status.ok()) {
+        return status;
+    }
+    trashHistory.push_back(outEntry.id);
+    invalidateCaches(absPath);
+    return Status::Success();
+}
+
+// 撤销最近一次 rm（undo 命令）
+Status FileManager::undoRemove(TrashEntry& outEntry) {
+    while (!trashHistory.empty()) {
+        Status status = trash->restore(trashHistory.back(), outEntry);
+        // 已被清除的条目无法恢复，继续尝试更早的；其他错误保留记录，解决后可再次 undo
+        if (status.code == StatusCode::PathNotFound) {
+            trashHistory.pop_back();
+            continue;
+        }
+        if (status.ok()) {
+            trashHistory.pop_back();
+            invalidateCaches(outEntry.originalPath);
+        }
+        return status;
     }
+    return Status::Error(StatusCode::InvalidArguments, "Nothing to undo");
+}
 
+// 恢复回收站条目（trash restore 命令）
+Status FileManager::restoreTrash(const std::string& item, TrashEntry& outEntry) {
+    if (item.empty()) {
+        return undoRemove(outEntry);
+    }
+
+    // 先按 id 查找，再按原路径查找最近的一次删除
+    std::string id = item;
+    std::vector<TrashEntry> entries;
+    trash->list(entries);
+    if (std::none_of(entries.begin(), entries.end(), [&](const TrashEntry& e) { return e.id == item; })) {
+        fs::path original = resolvePath(item).lexically_normal();
+        if (!original.has_filename()) original = original.parent_path();
+        auto it = std::find_if(entries.rbegin(), entries.rend(), [&](const TrashEntry& e) { return e.originalPath == original; });
+        if (it == entries.rend()) {
+            return Status::Error(StatusCode::PathNotFound, "No such item in trash", item);
+        }
+        id = it->id;
+    }
+
+    Status status = trash->restore(id, outEntry);
+    if (status.ok()) {
+        std::erase(trashHistory, id);
+        invalidateCaches(outEntry.originalPath);
+    }
+    return status;
+}
+
+// 列出回收站（trash list 命令）
+Status FileManager::listTrash(std::vector<TrashEntry>& outEntries) const {
+    trash->list(outEntries);
+    return Status::Success();
+}
+
+// 清空回收站（trash empty 命令）
+Status FileManager::emptyTrash(uintmax_t& outCount) {
+    outCount = 0;
+    if (!askConfirm("Permanently delete everything in the trash?")) {
+        return Status::Success("Empty trash cancelled");
+    }
+    trash->purgeAll(outCount);
+    trashHistory.clear();
     return Status::Success();
-}
\ No newline at end of file
+}
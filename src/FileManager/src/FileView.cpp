@@ -0,0 +1,381 @@
+#include "FileManager.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <memory>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+// head / tail / view 只通过 pread 读取需要的窗口，而不是映射整个文件：
+// 日志在被读取时可能被截断，映射区域越过文件末尾的访问会触发 SIGBUS
+
+namespace {
+
+constexpr size_t kBlockSize = 64 * 1024;            // 向前 / 向后扫描的块大小
+constexpr size_t kFollowChunkSize = size_t(1) << 20; // 跟随时每次读取的上限
+constexpr size_t kMaxPageBytes = size_t(1) << 20;   // 一页的字节上限
+constexpr size_t kBinaryProbeSize = 8192;
+
+bool looksBinary(const char* data, size_t len) {
+    return std::memchr(data, '\0', std::min(len, kBinaryProbeSize)) != nullptr;
+}
+
+// 只读打开的普通文件
+class TextFile {
+public:
+    ~TextFile() { if (fd >= 0) ::close(fd); }
+
+    Status open(const fs::path& path) {
+        fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return Status::SystemError(Status::codeFromErrno(errno), "Cannot open file", path, errno);
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            return Status::SystemError(StatusCode::UnknownError, "Cannot stat file", path, errno);
+        }
+        if (!S_ISREG(st.st_mode)) {
+            return Status::Error(StatusCode::NotAFile, "Not a regular file", path);
+        }
+        size = static_cast<uintmax_t>(st.st_size);
+        return Status::Success();
+    }
+
+    // 从 offset 处读取最多 len 字节，返回读到的字节数，出错时返回 -1
+    ssize_t read(char* buffer, size_t len, uintmax_t offset) const {
+        size_t done = 0;
+        while (done < len) {
+            ssize_t n = pread(fd, buffer + done, len - done, static_cast<off_t>(offset + done));
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) return -1;
+            if (n == 0) break;
+            done += static_cast<size_t>(n);
+        }
+        return static_cast<ssize_t>(done);
+    }
+
+    // 将 [offset, end) 分块传给 onData，回调返回 false 时停止
+    // 返回实际输出到的位置
+    uintmax_t emit(uintmax_t offset, uintmax_t end, char* buffer, size_t bufferSize,
+                   const std::function<bool(std::string_view)>& onData) const {
+        while (offset < end) {
+            size_t len = static_cast<size_t>(std::min<uintmax_t>(bufferSize, end - offset));
+            ssize_t n = read(buffer, len, offset);
+            if (n <= 0) break;
+            offset += static_cast<uintmax_t>(n);
+            if (!onData(std::string_view(buffer, static_cast<size_t>(n)))) break;
+        }
+        return offset;
+    }
+
+    int fd = -1;
+    uintmax_t size = 0;
+};
+
+// 查找 offset 之后 (含) 第 count 个换行符，返回其后一个字节的偏移，不足 count 个时返回 limit
+uintmax_t skipLines(const TextFile& file, uintmax_t offset, uintmax_t count, uintmax_t limit, char* buffer) {
+    while (count > 0 && offset < limit) {
+        size_t len = static_cast<size_t>(std::min<uintmax_t>(kBlockSize, limit - offset));
+        ssize_t n = file.read(buffer, len, offset);
+        if (n <= 0) return limit;
+        const char* p = buffer;
+        const char* end = buffer + n;
+        while (count > 0) {
+            const void* nl = std::memchr(p, '\n', static_cast<size_t>(end - p));
+            if (!nl) break;
+            p = static_cast<const char*>(nl) + 1;
+            --count;
+        }
+        offset += count == 0 ? static_cast<uintmax_t>(p - buffer) : static_cast<uintmax_t>(n);
+    }
+    return std::min(offset, limit);
+}
+
+// 跟随期间把 SIGINT 转为 eventfd 可读，结束后恢复原来的处理方式
+class InterruptSource {
+public:
+    InterruptSource() {
+        fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (fd < 0) return;
+        signalFd.store(fd);
+        struct sigaction action{};
+        action.sa_handler = &InterruptSource::onSignal;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, &previous);
+    }
+
+    ~InterruptSource() {
+        if (fd < 0) return;
+        sigaction(SIGINT, &previous, nullptr);
+        signalFd.store(-1);
+        ::close(fd);
+    }
+
+    int fd = -1;
+
+private:
+    static void onSignal(int) {
+        int target = signalFd.load();
+        if (target >= 0) {
+            uint64_t one = 1;
+            [[maybe_unused]] ssize_t n = ::write(target, &one, sizeof(one));
+        }
+    }
+
+    static inline std::atomic<int> signalFd{-1};
+    struct sigaction previous{};
+};
+
+} // namespace
+
+Status FileManager::headFile(const Path& filePath, size_t lineCount,
+                             const std::function<bool(std::string_view)>& onData) const {
+    fs::path target = resolvePath(filePath);
+    TextFile file;
+    Status status = file.open(target);
+    if (!status.ok()) return status;
+
+    auto buffer = std::make_unique<char[]>(kBlockSize);
+    uintmax_t offset = 0;
+    size_t remaining = lineCount;
+    while (remaining > 0 && offset < file.size) {
+        size_t len = static_cast<size_t>(std::min<uintmax_t>(kBlockSize, file.size - offset));
+        ssize_t n = file.read(buffer.get(), len, offset);
+        if (n < 0) return Status::SystemError(StatusCode::UnknownError, "Cannot read file", std::move(target), errno);
+        if (n == 0) break;
+        if (offset == 0 && looksBinary(buffer.get(), static_cast<size_t>(n))) {
+            return Status::Error(StatusCode::NotAFile, "Binary file", std::move(target));
+        }
+
+        const char* p = buffer.get();
+        const char* end = p + n;
+        while (remaining > 0) {
+            const void* nl = std::memchr(p, '\n', static_cast<size_t>(end - p));
+            if (!nl) break;
+            p = static_cast<const char*>(nl) + 1;
+            --remaining;
+        }
+        size_t used = remaining == 0 ? static_cast<size_t>(p - buffer.get()) : static_cast<size_t>(n);
+        if (!onData(std::string_view(buffer.get(), used))) break;
+        offset += static_cast<uintmax_t>(n);
+    }
+    return Status::Success();
+}
+
+Status FileManager::tailFile(const Path& filePath, size_t lineCount,
+                             const std::function<bool(std::string_view)>& onData, uintmax_t& outEndOffset) const {
+    outEndOffset = 0;
+    fs::path target = resolvePath(filePath);
+    TextFile file;
+    Status status = file.open(target);
+    if (!status.ok()) return status;
+
+    const uintmax_t size = file.size;
+    outEndOffset = size;
+    if (lineCount == 0 || size == 0) return Status::Success();
+
+    // 从末尾向前逐块查找换行符，文件末尾的换行符属于最后一行，不作为分隔
+    auto buffer = std::make_unique<char[]>(kBlockSize);
+    uintmax_t start = 0;
+    size_t found = 0;
+    uintmax_t pos = size;
+    while (pos > 0) {
+        size_t len = static_cast<size_t>(std::min<uintmax_t>(kBlockSize, pos));
+        pos -= len;
+        ssize_t n = file.read(buffer.get(), len, pos);
+        if (n < 0) return Status::SystemError(StatusCode::UnknownError, "Cannot read file", std::move(target), errno);
+        if (static_cast<size_t>(n) < len) len = static_cast<size_t>(n); // 读取期间被截断
+
+        size_t end = len;
+        bool done = false;
+        while (end > 0) {
+            const void* nl = memrchr(buffer.get(), '\n', end);
+            if (!nl) break;
+            end = static_cast<size_t>(static_cast<const char*>(nl) - buffer.get());
+            if (pos + end == size - 1) continue;
+            if (++found == lineCount) {
+                start = pos + end + 1;
+                done = true;
+                break;
+            }
+        }
+        if (done) break;
+    }
+
+    ssize_t probe = file.read(buffer.get(), static_cast<size_t>(std::min<uintmax_t>(kBinaryProbeSize, size - start)), start);
+    if (probe > 0 && looksBinary(buffer.get(), static_cast<size_t>(probe))) {
+        return Status::Error(StatusCode::NotAFile, "Binary file", std::move(target));
+    }
+
+    file.emit(start, size, buffer.get(), kBlockSize, onData);
+    return Status::Success();
+}
+
+Status FileManager::followFile(const Path& filePath, uintmax_t offset,
+                               const std::function<bool(std::string_view)>& onData) const {
+    fs::path target = resolvePath(filePath);
+    auto file = std::make_unique<TextFile>();
+    Status status = file->open(target);
+    if (!status.ok()) return status;
+
+    int inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0) {
+        return Status::SystemError(StatusCode::UnknownError, "Cannot watch file", std::move(target), errno);
+    }
+    struct InotifyGuard {
+        int fd;
+        ~InotifyGuard() { ::close(fd); }
+    } inotifyGuard{inotifyFd};
+
+    // 监视文件本身的写入和截断，以及所在目录中同名文件的重建 (日志轮转)
+    constexpr uint32_t kFileEvents = IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF;
+    int fileWatch = inotify_add_watch(inotifyFd, target.c_str(), kFileEvents);
+    int dirWatch = inotify_add_watch(inotifyFd, target.parent_path().c_str(), IN_CREATE | IN_MOVED_TO);
+    if (fileWatch < 0) {
+        return Status::SystemError(StatusCode::UnknownError, "Cannot watch file", std::move(target), errno);
+    }
+    const std::string fileName = target.filename().string();
+
+    std::unique_ptr<InterruptSource> interrupt;
+    int stopFd = cancelFd;
+    if (stopFd < 0) {
+        interrupt = std::make_unique<InterruptSource>();
+        stopFd = interrupt->fd;
+    }
+
+    auto buffer = std::make_unique<char[]>(kFollowChunkSize);
+    bool keepGoing = true;
+    auto callback = [&](std::string_view data) {
+        keepGoing = onData(data);
+        return keepGoing;
+    };
+
+    // 输出 offset 之后新增的内容，文件变短说明被截断，从头开始
+    auto drain = [&]() {
+        struct stat st;
+        if (fstat(file->fd, &st) != 0) return;
+        uintmax_t size = static_cast<uintmax_t>(st.st_size);
+        if (size < offset) offset = 0;
+        offset = file->emit(offset, size, buffer.get(), kFollowChunkSize, callback);
+    };
+
+    // 同名文件被重建：先读完旧文件剩余的内容，再从头读新文件
+    auto reopen = [&]() {
+        drain();
+        auto next = std::make_unique<TextFile>();
+        if (!next->open(target).ok()) return;
+        if (fileWatch >= 0) inotify_rm_watch(inotifyFd, fileWatch);
+        fileWatch = inotify_add_watch(inotifyFd, target.c_str(), kFileEvents);
+        file = std::move(next);
+        offset = 0;
+    };
+
+    alignas(inotify_event) char events[4096];
+    drain();
+    while (keepGoing) {
+        pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {stopFd, POLLIN | POLLRDHUP, 0}};
+        int ready = poll(fds, stopFd >= 0 ? 2 : 1, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (stopFd >= 0 && fds[1].revents != 0) break;
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        bool replaced = false;
+        ssize_t len;
+        while ((len = ::read(inotifyFd, events, sizeof(events))) > 0) {
+            for (char* p = events; p < events + len;) {
+                auto* event = reinterpret_cast<inotify_event*>(p);
+                if (event->wd == dirWatch && event->len > 0 && fileName == event->name) replaced = true;
+                if (event->wd == fileWatch && (event->mask & IN_IGNORED)) fileWatch = -1;
+                p += sizeof(inotify_event) + event->len;
+            }
+        }
+        if (replaced && dirWatch >= 0) reopen();
+        else drain();
+    }
+    return Status::Success();
+}
+
+Status FileManager::readPage(const Path& filePath, uintmax_t offset, size_t lineCount, bool alignToLine,
+                             TextPage& outPage) const {
+    outPage = TextPage();
+    fs::path target = resolvePath(filePath);
+    TextFile file;
+    Status status = file.open(target);
+    if (!status.ok()) return status;
+
+    auto buffer = std::make_unique<char[]>(kBlockSize);
+    offset = std::min(offset, file.size);
+    if (alignToLine && offset > 0 && offset < file.size) {
+        char previous = '\n';
+        file.read(&previous, 1, offset - 1);
+        if (previous != '\n') {
+            // 最多向后找一页的长度，找不到换行 (超长行或无换行的数据) 时就从 offset 开始
+            uintmax_t limit = std::min<uintmax_t>(file.size, offset + kMaxPageBytes);
+            uintmax_t next = skipLines(file, offset, 1, limit, buffer.get());
+            if (next < limit || limit == file.size) offset = next;
+        }
+    }
+
+    outPage.offset = offset;
+    outPage.fileSize = file.size;
+    uintmax_t pos = offset;
+    while (outPage.lines < lineCount && pos < file.size && outPage.text.size() < kMaxPageBytes) {
+        size_t want = std::min(kBlockSize, kMaxPageBytes - outPage.text.size());
+        size_t len = static_cast<size_t>(std::min<uintmax_t>(want, file.size - pos));
+        ssize_t n = file.read(buffer.get(), len, pos);
+        if (n < 0) return Status::SystemError(StatusCode::UnknownError, "Cannot read file", std::move(target), errno);
+        if (n == 0) break;
+
+        const char* p = buffer.get();
+        const char* end = p + n;
+        while (outPage.lines < lineCount) {
+            const void* nl = std::memchr(p, '\n', static_cast<size_t>(end - p));
+            if (!nl) break;
+            p = static_cast<const char*>(nl) + 1;
+            ++outPage.lines;
+        }
+        size_t used = outPage.lines == lineCount ? static_cast<size_t>(p - buffer.get()) : static_cast<size_t>(n);
+        outPage.text.append(buffer.get(), used);
+        pos += used;
+    }
+    // 不以换行结尾的内容 (末行或被截断的长行) 也算一行
+    if (!outPage.text.empty() && outPage.text.back() != '\n' && outPage.lines < lineCount) ++outPage.lines;
+    outPage.nextOffset = pos;
+
+    if (looksBinary(outPage.text.data(), outPage.text.size())) {
+        outPage = TextPage();
+        return Status::Error(StatusCode::NotAFile, "Binary file", std::move(target));
+    }
+    return Status::Success();
+}
+
+Status FileManager::findLine(const Path& filePath, uintmax_t lineNumber, uintmax_t& outOffset) const {
+    outOffset = 0;
+    if (lineNumber == 0) {
+        return Status::Error(StatusCode::InvalidArguments, "Line numbers start at 1");
+    }
+    fs::path target = resolvePath(filePath);
+    TextFile file;
+    Status status = file.open(target);
+    if (!status.ok()) return status;
+
+    auto buffer = std::make_unique<char[]>(kBlockSize);
+    uintmax_t offset = skipLines(file, 0, lineNumber - 1, file.size, buffer.get());
+    if (offset >= file.size && lineNumber > 1) {
+        // 恰好以第 lineNumber - 1 行的换行结尾时，该行不存在
+        return Status::Error(StatusCode::InvalidArguments, "Line number beyond end of file", std::move(target));
+    }
+    outOffset = offset;
+    return Status::Success();
+}
@@ -0,0 +1,184 @@
+#include "FileManager.h"
+#include "AllocTracker.h"
+#include "TreeWalker.h"
+#include "Parallel.h"
+#include "WorkQueue.h"
+#include "ByteSearch.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t kBinaryProbeSize = 8192;          // 二进制检测的探测长度
+constexpr size_t kStreamChunkSize = size_t(1) << 20;
+
+// 命中行在缓冲区中的位置
+struct LineHit {
+    uintmax_t lineNumber;
+    size_t offset;
+    size_t length;
+};
+
+bool looksBinary(const uint8_t* data, size_t len) {
+    return std::memchr(data, '\0', std::min(len, kBinaryProbeSize)) != nullptr;
+}
+
+// 扫描 [data, data + len) 中的完整行，记录命中行
+// firstLine 为缓冲区首行的行号，返回缓冲区之后下一行的行号
+uintmax_t scanLines(const LiteralMatcher& matcher, const uint8_t* data, size_t len,
+                    uintmax_t firstLine, std::vector<LineHit>& hits) {
+    const uint8_t* end = data + len;
+    const uint8_t* p = data;        // 始终位于某行行首
+    const uint8_t* counted = data;  // 已统计换行符的位置
+    uintmax_t line = firstLine;
+
+    while (p < end) {
+        const uint8_t* hit = matcher.find(p, end);
+        if (hit == end) break;
+
+        const void* prevNl = memrchr(p, '\n', static_cast<size_t>(hit - p));
+        const uint8_t* lineStart = prevNl ? static_cast<const uint8_t*>(prevNl) + 1 : p;
+        line += static_cast<uintmax_t>(std::count(counted, lineStart, '\n'));
+        counted = lineStart;
+
+        const void* nextNl = std::memchr(hit, '\n', static_cast<size_t>(end - hit));
+        const uint8_t* lineEnd = nextNl ? static_cast<const uint8_t*>(nextNl) : end;
+        hits.push_back({line, static_cast<size_t>(lineStart - data), static_cast<size_t>(lineEnd - lineStart)});
+
+        // 每行只报告一次，从下一行继续查找
+        p = lineEnd < end ? lineEnd + 1 : end;
+    }
+    return line + static_cast<uintmax_t>(std::count(counted, end, '\n'));
+}
+
+// 将一批命中交给回调，调用方需持有输出锁
+void emitHits(const std::function<void(const GrepMatch&)>& onMatch, std::string_view path,
+              const uint8_t* base, const std::vector<LineHit>& hits) {
+    for (const LineHit& hit : hits) {
+        size_t length = hit.length;
+        if (length > 0 && base[hit.offset + length - 1] == '\r') --length;
+        onMatch({path, hit.lineNumber,
+                 std::string_view(reinterpret_cast<const char*>(base + hit.offset), length)});
+    }
+}
+
+} // namespace
+
+Status FileManager::grep(const Path& targetPath, const std::string& pattern,
+                         const std::function<void(const GrepMatch&)>& onMatch, uintmax_t& outMatchCount) const {
+    AllocScope resultScope(AllocCategory::Results);
+    outMatchCount = 0;
+    if (pattern.empty()) {
+        return Status::Error(StatusCode::InvalidArguments, "Missing pattern: Please enter 'grep [pattern] [dir]'");
+    }
+
+    fs::path target = resolvePath(targetPath);
+    if (!fs::exists(target)) {
+        return Status::Error(StatusCode::PathNotFound, "Target not found", std::move(target));
+    }
+
+    const LiteralMatcher matcher(pattern);
+    std::mutex outputMutex;
+    std::atomic<uintmax_t> matchCount{0};
+
+    // 处理单个文件，hits 与 chunk 由调用线程复用
+    auto grepFile = [&](const std::string& path, std::vector<LineHit>& hits, std::vector<uint8_t>& chunk) {
+        hits.clear();
+        // 按块读取，仅处理完整行，残行留到下一块
+        // 不映射文件：文件在读取时可能被其他进程截断，访问映射区域越过文件末尾会触发 SIGBUS
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return;
+        struct FdGuard {
+            int fd;
+            ~FdGuard() { ::close(fd); }
+        } fdGuard{fd};
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) return;
+
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        chunk.resize(kStreamChunkSize);
+        size_t carried = 0;
+        uintmax_t line = 1;
+        bool first = true;
+        while (true) {
+            if (chunk.size() - carried < kStreamChunkSize / 2) chunk.resize(chunk.size() * 2);
+            ssize_t n = read(fd, chunk.data() + carried, chunk.size() - carried);
+            if (n < 0 && errno == EINTR) continue;
+            bool eof = (n <= 0);
+            size_t filled = carried + (n > 0 ? static_cast<size_t>(n) : 0);
+            if (first) {
+                if (looksBinary(chunk.data(), filled)) return;
+                first = false;
+            }
+
+            size_t complete = filled;
+            if (!eof) {
+                const void* lastNl = memrchr(chunk.data(), '\n', filled);
+                if (!lastNl) {
+                    carried = filled; // 单行超过缓冲区，继续扩充
+                    continue;
+                }
+                complete = static_cast<size_t>(static_cast<const uint8_t*>(lastNl) - chunk.data()) + 1;
+            }
+
+            hits.clear();
+            line = scanLines(matcher, chunk.data(), complete, line, hits);
+            if (!hits.empty()) {
+                matchCount.fetch_add(hits.size(), std::memory_order_relaxed);
+                std::lock_guard<std::mutex> lock(outputMutex);
+                emitHits(onMatch, path, chunk.data(), hits);
+            }
+
+            if (eof) break;
+            carried = filled - complete;
+            std::memmove(chunk.data(), chunk.data() + complete, carried);
+        }
+    };
+
+    if (!fs::is_directory(target)) {
+        std::vector<LineHit> hits;
+        std::vector<uint8_t> chunk;
+        grepFile(target.string(), hits, chunk);
+        outMatchCount = matchCount.load();
+        return Status::Success();
+    }
+
+    // 遍历线程产生文件路径，工作线程并行匹配
+    WorkQueue<std::string> queue;
+    unsigned threads = defaultThreadCount();
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            std::vector<LineHit> hits;
+            std::vector<uint8_t> chunk;
+            while (auto path = queue.pop()) {
+                grepFile(*path, hits, chunk);
+            }
+        });
+    }
+
+    TreeWalker walker;
+    int err = walker.walk(target, [&](WalkEntry& entry) {
+        if (entry.type == FileType::File) {
+            queue.push(std::string(entry.path));
+        }
+        return WalkAction::Continue;
+    });
+    queue.close();
+    for (auto& worker : workers) worker.join();
+
+    if (err != 0) {
+        return Status::SystemError(StatusCode::PermissionDenied, "Cannot open directory", std::move(target), err);
+    }
+
+    outMatchCount = matchCount.load();
+    return Status::Success();
+}
@@ -0,0 +1,153 @@
+#include "IgnoreRules.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kMaxGitignoreSize = size_t(1) << 20;
+
+bool isRegexSpecial(char c) {
+    return c == '.' || c == '+' || c == '(' || c == ')' || c == '|' || c == '{' || c == '}' ||
+           c == '^' || c == '$' || c == '*' || c == '?' || c == '[' || c == ']' || c == '\\';
+}
+
+// 将路径 glob 转换为锚定的正则，交给 NameMatcher 编译成 DFA
+// * 和 ? 不匹配 '/'，** 匹配任意层目录
+std::string pathGlobToRegex(std::string_view glob) {
+    std::string regex = "^";
+    size_t i = 0;
+    while (i < glob.size()) {
+        char c = glob[i];
+        if (c == '*' && i + 1 < glob.size() && glob[i + 1] == '*') {
+            bool atSegmentStart = i == 0 || glob[i - 1] == '/';
+            size_t after = i + 2;
+            if (atSegmentStart && after < glob.size() && glob[after] == '/') {
+                regex += "(.*/)?"; // "**/"：零或多层目录
+                i = after + 1;
+                continue;
+            }
+            if (atSegmentStart && after == glob.size()) {
+                regex += ".*"; // 结尾的 "/**"：目录下的一切
+                i = after;
+                continue;
+            }
+            regex += "[^/]*"; // 其他位置的 ** 与 * 相同
+            i = after;
+            continue;
+        }
+        switch (c) {
+            case '*': regex += "[^/]*"; break;
+            case '?': regex += "[^/]"; break;
+            case '[': {
+                // 字符类原样复制，[!...] 改写为 [^...]
+                size_t close = i + 1;
+                if (close < glob.size() && (glob[close] == '!' || glob[close] == '^')) ++close;
+                if (close < glob.size() && glob[close] == ']') ++close;
+                while (close < glob.size() && glob[close] != ']') ++close;
+                if (close == glob.size()) {
+                    regex += "\\[";
+                    break;
+                }
+                regex += '[';
+                size_t body = i + 1;
+                if (glob[body] == '!') {
+                    regex += '^';
+                    ++body;
+                }
+                regex.append(glob.substr(body, close - body));
+                regex += ']';
+                i = close;
+                break;
+            }
+            case '\\':
+                if (i + 1 < glob.size()) c = glob[++i];
+                [[fallthrough]];
+            default:
+                if (isRegexSpecial(c)) regex += '\\';
+                regex += c;
+                break;
+        }
+        ++i;
+    }
+    regex += '$';
+    return regex;
+}
+
+} // namespace
+
+Status IgnoreRules::add(std::string_view line, size_t baseLen) {
+    // 去掉行尾空白 (未转义的) 和 CR
+    while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t')) {
+        if (line.back() == ' ' && line.size() > 1 && line[line.size() - 2] == '\\') break;
+        line.remove_suffix(1);
+    }
+    if (line.empty() || line.front() == '#') return Status::Success();
+
+    Rule rule;
+    rule.baseLen = baseLen;
+    rule.negate = line.front() == '!';
+    if (rule.negate) line.remove_prefix(1);
+    if (!line.empty() && line.front() == '\\') line.remove_prefix(1); // "\#" "\!" 表示字面量
+    rule.dirOnly = !line.empty() && line.back() == '/';
+    if (rule.dirOnly) line.remove_suffix(1);
+    if (line.empty()) return Status::Success();
+
+    // 中间或开头有 '/' 的规则相对所在目录匹配路径
+    rule.pathRule = line.find('/') != std::string_view::npos;
+    if (!line.empty() && line.front() == '/') line.remove_prefix(1);
+    if (line.starts_with("**/") && line.find('/', 3) == std::string_view::npos) {
+        // "**/name" 等价于不含 '/' 的 "name"
+        line.remove_prefix(3);
+        rule.pathRule = false;
+    }
+
+    Status status = rule.pathRule
+        ? NameMatcher::compile(MatchMode::Regex, pathGlobToRegex(line), rule.nameMatcher)
+        : NameMatcher::compile(MatchMode::Glob, std::string(line), rule.nameMatcher);
+    if (!status.ok()) return status;
+
+    rules.push_back(std::move(rule));
+    return Status::Success();
+}
+
+void IgnoreRules::loadGitignore(int dirFd, size_t baseLen) {
+    int fd = openat(dirFd, ".gitignore", O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+    if (fd < 0) return;
+
+    std::string content;
+    char chunk[8192];
+    while (content.size() < kMaxGitignoreSize) {
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        content.append(chunk, static_cast<size_t>(n));
+    }
+    close(fd);
+
+    std::string_view rest(content);
+    while (!rest.empty()) {
+        size_t end = rest.find('\n');
+        std::string_view line = rest.substr(0, end);
+        rest = end == std::string_view::npos ? std::string_view() : rest.substr(end + 1);
+        add(line, baseLen);
+    }
+}
+
+bool IgnoreRules::ignored(std::string_view relPath, std::string_view name, bool isDir) const {
+    // 从后往前找第一条匹配的规则
+    for (size_t i = rules.size(); i-- > 0;) {
+        const Rule& rule = rules[i];
+        if (rule.dirOnly && !isDir) continue;
+        bool matched;
+        if (rule.pathRule) {
+            // 规则只在其所在目录之内生效，这里的 relPath 一定以该目录开头
+            std::string_view local = relPath.substr(rule.baseLen == 0 ? 0 : rule.baseLen + 1);
+            matched = rule.nameMatcher.matches(local);
+        } else {
+            matched = rule.nameMatcher.matches(name);
+        }
+        if (matched) return !rule.negate;
+    }
+    return false;
+}
@@ -0,0 +1,112 @@
+#include "IoThrottle.h"
+#include <chrono>
+#include <thread>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+// linux/ioprio.h 在部分发行版中不可用，这里直接定义所需的常量
+constexpr int kIoprioWhoProcess = 1;
+constexpr int kIoprioClassShift = 13;
+constexpr int kIoprioClassBestEffort = 2;
+constexpr int kIoprioClassIdle = 3;
+
+// 允许的突发量：落后于当前时刻超过该值的配额不再累积
+constexpr int64_t kBurstNs = 100'000'000;
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+thread_local uint32_t appliedGeneration = 0;
+
+} // namespace
+
+IoThrottle& IoThrottle::instance() {
+    static IoThrottle throttle;
+    return throttle;
+}
+
+void IoThrottle::setLimits(const IoLimits& limits) {
+    bytesPerSecond.store(limits.bytesPerSecond, std::memory_order_relaxed);
+    opsPerSecond.store(limits.opsPerSecond, std::memory_order_relaxed);
+    // 丢弃按旧速率预订的配额，新限制立即生效
+    nextByteSlot.store(0, std::memory_order_relaxed);
+    nextOpSlot.store(0, std::memory_order_relaxed);
+    if (idlePriority.exchange(limits.idlePriority) != limits.idlePriority) {
+        priorityGeneration.fetch_add(1);
+    }
+    {
+        std::lock_guard<std::mutex> lock(inFlightMutex);
+        maxInFlight.store(limits.maxInFlight, std::memory_order_relaxed);
+    }
+    inFlightFreed.notify_all();
+}
+
+IoLimits IoThrottle::limits() const {
+    IoLimits limits;
+    limits.bytesPerSecond = bytesPerSecond.load(std::memory_order_relaxed);
+    limits.opsPerSecond = opsPerSecond.load(std::memory_order_relaxed);
+    limits.maxInFlight = maxInFlight.load(std::memory_order_relaxed);
+    limits.idlePriority = idlePriority.load(std::memory_order_relaxed);
+    return limits;
+}
+
+// 预订一段配额：nextFree 推后 costNs，然后休眠到预订的起点
+void IoThrottle::waitFor(std::atomic<int64_t>& nextFree, uint64_t costNs) {
+    int64_t now = nowNs();
+    int64_t start = nextFree.load(std::memory_order_relaxed);
+    int64_t begin;
+    do {
+        begin = std::max(start, now - kBurstNs);
+    } while (!nextFree.compare_exchange_weak(start, begin + static_cast<int64_t>(costNs), std::memory_order_relaxed));
+    if (begin > now) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(begin - now));
+    }
+}
+
+void IoThrottle::acquire(uint64_t bytes) {
+    if (appliedGeneration != priorityGeneration.load(std::memory_order_relaxed)) {
+        applyPriority();
+    }
+
+    uint64_t ops = opsPerSecond.load(std::memory_order_relaxed);
+    if (ops != 0) {
+        waitFor(nextOpSlot, 1'000'000'000 / ops);
+    }
+    uint64_t rate = bytesPerSecond.load(std::memory_order_relaxed);
+    if (rate != 0 && bytes != 0) {
+        // 以 long double 计算，避免大块复制时溢出
+        waitFor(nextByteSlot, static_cast<uint64_t>(static_cast<long double>(bytes) * 1e9L / rate));
+    }
+}
+
+void IoThrottle::applyPriority() {
+    appliedGeneration = priorityGeneration.load();
+    int ioClass = idlePriority.load() ? kIoprioClassIdle : kIoprioClassBestEffort;
+    int value = (ioClass << kIoprioClassShift) | (ioClass == kIoprioClassIdle ? 0 : 4);
+    // who = 0 表示调用线程
+    syscall(SYS_ioprio_set, kIoprioWhoProcess, 0, value);
+}
+
+IoThrottle::Slot::Slot(IoThrottle& throttle) : throttle(throttle) {
+    if (throttle.maxInFlight.load(std::memory_order_relaxed) == 0) return;
+    std::unique_lock<std::mutex> lock(throttle.inFlightMutex);
+    throttle.inFlightFreed.wait(lock, [&] {
+        unsigned limit = throttle.maxInFlight.load(std::memory_order_relaxed);
+        return limit == 0 || throttle.inFlight < limit;
+    });
+    ++throttle.inFlight;
+    held = true;
+}
+
+IoThrottle::Slot::~Slot() {
+    if (!held) return;
+    {
+        std::lock_guard<std::mutex> lock(throttle.inFlightMutex);
+        --throttle.inFlight;
+    }
+    throttle.inFlightFreed.notify_one();
+}
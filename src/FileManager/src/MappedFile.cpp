@@ -0,0 +1,79 @@
+#include "MappedFile.h"
+#include <cerrno>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : fileFd(std::exchange(other.fileFd, -1)),
+      mapData(std::exchange(other.mapData, nullptr)),
+      mapSize(std::exchange(other.mapSize, 0))
+{}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        fileFd = std::exchange(other.fileFd, -1);
+        mapData = std::exchange(other.mapData, nullptr);
+        mapSize = std::exchange(other.mapSize, 0);
+    }
+    return *this;
+}
+
+int MappedFile::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return errno;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int err = errno;
+        ::close(fd);
+        return err;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return EINVAL;
+    }
+
+    return open(fd, static_cast<size_t>(st.st_size));
+}
+
+int MappedFile::open(int fd, size_t size) {
+    close();
+    fileFd = fd;
+    if (size == 0) return 0;
+
+    void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        int err = errno;
+        close();
+        return err;
+    }
+    mapData = static_cast<uint8_t*>(addr);
+    mapSize = size;
+    return 0;
+}
+
+void MappedFile::close() {
+    if (mapData) {
+        munmap(mapData, mapSize);
+        mapData = nullptr;
+        mapSize = 0;
+    }
+    if (fileFd >= 0) {
+        ::close(fileFd);
+        fileFd = -1;
+    }
+}
+
+void MappedFile::advise(int advice) const {
+    if (mapData) madvise(mapData, mapSize, advice);
+}
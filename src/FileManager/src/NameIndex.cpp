@@ -0,0 +1,185 @@
+#include "NameIndex.h"
+#include "FileManager.h"
+#include "AllocTracker.h"
+#include "ByteSearch.h"
+#include "Parallel.h"
+#include "TreeWalker.h"
+#include <algorithm>
+#include <cerrno>
+#include <numeric>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 超过此数量的条目按块并行筛选，块内保持顺序，块之间按编号拼接
+constexpr size_t kChunkEntries = size_t(64) << 10;
+
+char asciiLower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// 每个遍历线程独占的收集缓冲区
+struct alignas(64) Collected {
+    std::vector<NameIndex::Entry> entries; // 偏移相对于本线程的 paths
+    std::string paths;
+};
+
+// 分块执行 fn(begin, end, out)，按块的顺序拼接结果
+template <typename Fn>
+void filterChunks(size_t count, std::vector<uint32_t>& outIds, Fn&& fn) {
+    if (count == 0) return;
+    if (count <= kChunkEntries) {
+        fn(size_t(0), count, outIds);
+        return;
+    }
+    const size_t chunks = (count + kChunkEntries - 1) / kChunkEntries;
+    std::vector<std::vector<uint32_t>> found(chunks);
+    parallelFor(chunks, [&](size_t index, unsigned) {
+        size_t begin = index * kChunkEntries;
+        fn(begin, std::min(count, begin + kChunkEntries), found[index]);
+    });
+    size_t total = 0;
+    for (const auto& part : found) total += part.size();
+    outIds.reserve(total);
+    for (const auto& part : found) outIds.insert(outIds.end(), part.begin(), part.end());
+}
+
+} // namespace
+
+int NameIndex::build(const Path& rootDir, const WalkOptions& walkOptions) {
+    root = rootDir;
+    entries.clear();
+    paths.clear();
+    names.clear();
+
+    ParallelWalker walker;
+    if (!walker.setOptions(walkOptions).ok()) return EINVAL;
+    std::vector<Collected> collected(walker.threadCount());
+    const size_t rootLen = root.string().size();
+
+    int err = walker.walk(root, [&](WalkEntry& entry, unsigned worker) {
+        std::string_view rel = entry.path.substr(rootLen);
+        if (!rel.empty() && rel.front() == '/') rel.remove_prefix(1);
+        Collected& out = collected[worker];
+        out.entries.push_back({out.paths.size(), 0, static_cast<uint32_t>(rel.size()),
+                               static_cast<uint32_t>(entry.name.size()), entry.type});
+        out.paths.append(rel);
+        return WalkAction::Continue;
+    });
+    if (err != 0) return err;
+
+    // 各线程的结果按相对路径归并排序，再按排序后的顺序重建字符串池
+    struct Ref {
+        std::string_view path;
+        const Collected* source;
+        uint32_t index;
+    };
+    std::vector<Ref> refs;
+    size_t pathBytes = 0;
+    size_t nameBytes = 0;
+    for (const Collected& part : collected) {
+        pathBytes += part.paths.size();
+        for (size_t i = 0; i < part.entries.size(); ++i) {
+            const Entry& e = part.entries[i];
+            refs.push_back({std::string_view(part.paths).substr(e.pathOffset, e.pathLen), &part,
+                            static_cast<uint32_t>(i)});
+            nameBytes += e.nameLen + 1;
+        }
+    }
+    std::sort(refs.begin(), refs.end(), [](const Ref& a, const Ref& b) { return a.path < b.path; });
+
+    entries.reserve(refs.size());
+    paths.reserve(pathBytes);
+    names.reserve(nameBytes);
+    for (const Ref& ref : refs) {
+        const Entry& e = ref.source->entries[ref.index];
+        entries.push_back({paths.size(), names.size(), e.pathLen, e.nameLen, e.type});
+        paths.append(ref.path);
+        // 名称是相对路径的最后一段
+        for (char c : ref.path.substr(ref.path.size() - e.nameLen)) names.push_back(asciiLower(c));
+        names.push_back('\0');
+    }
+    return 0;
+}
+
+std::string_view NameIndex::path(uint32_t id) const {
+    const Entry& e = entries[id];
+    return std::string_view(paths).substr(e.pathOffset, e.pathLen);
+}
+
+void NameIndex::search(std::string_view lowerKeyword, std::vector<uint32_t>& outIds) const {
+    outIds.clear();
+    if (entries.empty()) return;
+    if (lowerKeyword.empty()) {
+        outIds.resize(entries.size());
+        std::iota(outIds.begin(), outIds.end(), 0u);
+        return;
+    }
+
+    // 关键词不含 '\0'，命中不会跨越两个名称
+    // 每次命中后二分定位所属条目，并跳到下一个名称继续查找
+    const LiteralMatcher matcher{std::string(lowerKeyword)};
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(names.data());
+    filterChunks(entries.size(), outIds, [&](size_t begin, size_t end, std::vector<uint32_t>& out) {
+        const uint8_t* p = base + entries[begin].nameOffset;
+        const uint8_t* limit = base + (end < entries.size() ? entries[end].nameOffset : names.size());
+        auto first = entries.begin() + static_cast<ptrdiff_t>(begin);
+        auto last = entries.begin() + static_cast<ptrdiff_t>(end);
+        while (p < limit) {
+            const uint8_t* hit = matcher.find(p, limit);
+            if (hit == limit) break;
+            uint64_t offset = static_cast<uint64_t>(hit - base);
+            first = std::upper_bound(first, last, offset,
+                [](uint64_t value, const Entry& e) { return value < e.nameOffset; }) - 1;
+            out.push_back(static_cast<uint32_t>(first - entries.begin()));
+            p = base + first->nameOffset + first->nameLen + 1;
+        }
+    });
+}
+
+void NameIndex::narrow(const std::vector<uint32_t>& candidates, std::string_view lowerKeyword,
+                       std::vector<uint32_t>& outIds) const {
+    outIds.clear();
+    const LiteralMatcher matcher{std::string(lowerKeyword)};
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(names.data());
+    filterChunks(candidates.size(), outIds, [&](size_t begin, size_t end, std::vector<uint32_t>& out) {
+        for (size_t i = begin; i < end; ++i) {
+            const Entry& e = entries[candidates[i]];
+            const uint8_t* name = base + e.nameOffset;
+            if (matcher.find(name, name + e.nameLen) != name + e.nameLen) out.push_back(candidates[i]);
+        }
+    });
+}
+
+const std::vector<uint32_t>& IncrementalSearch::update(std::string_view keyword) {
+    AllocScope resultScope(AllocCategory::Results);
+    std::string lower;
+    lower.reserve(keyword.size());
+    for (char c : keyword) lower.push_back(asciiLower(c));
+
+    // 丢弃关键词不再被包含的层，剩下的栈顶是当前关键词可用的最小候选集
+    while (!levels.empty() && lower.find(levels.back().keyword) == std::string::npos) levels.pop_back();
+    if (!levels.empty() && levels.back().keyword == lower) return levels.back().ids;
+
+    Level level;
+    level.keyword = std::move(lower);
+    // 候选集为全部条目时整池查找比逐条筛选快
+    if (levels.empty() || levels.back().keyword.empty()) index.search(level.keyword, level.ids);
+    else index.narrow(levels.back().ids, level.keyword, level.ids);
+    levels.push_back(std::move(level));
+    return levels.back().ids;
+}
+
+Status FileManager::buildNameIndex(const Path& dirPath, const WalkOptions& options, NameIndex& outIndex) const {
+    AllocScope resultScope(AllocCategory::Results);
+    fs::path target = resolvePath(dirPath).lexically_normal();
+    if (!target.has_filename() && target.has_parent_path() && target != target.root_path()) target = target.parent_path();
+
+    int err = outIndex.build(target, options);
+    if (err == EINVAL) return Status::Error(StatusCode::InvalidArguments, "Invalid exclude pattern");
+    if (err != 0) {
+        return Status::SystemError(Status::codeFromErrno(err), "Cannot open directory", std::move(target), err);
+    }
+    return Status::Success();
+}
@@ -0,0 +1,606 @@
+#include "NameMatcher.h"
+#include <algorithm>
+#include <bitset>
+#include <cctype>
+#include <cstdint>
+#include <map>
+#include <utility>
+
+namespace {
+
+using ByteSet = std::bitset<256>;
+
+constexpr size_t kMaxDfaStates = 4096; // DFA 状态数上限，防止病态模式撑爆内存
+constexpr int kMaxRepeat = 255;        // {m,n} 重复次数上限
+
+// 模式语法树节点，子节点以下标引用，同一子树可被多处引用
+struct AstNode {
+    enum class Kind { Set, Concat, Alt, Star, Plus, Quest, Empty };
+    Kind kind;
+    ByteSet set;
+    std::vector<int> children;
+};
+
+// NFA 状态：要么带一个字节集合转移，要么只有 ε 转移
+struct NfaState {
+    ByteSet set;
+    bool hasSet = false;
+    int next = -1;
+    std::vector<int> eps;
+};
+
+inline char asciiLower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool containsIgnoreCase(std::string_view haystack, std::string_view lowerNeedle) {
+    const size_t n = lowerNeedle.size();
+    if (n > haystack.size()) return false;
+    const size_t last = haystack.size() - n;
+    for (size_t i = 0; i <= last; ++i) {
+        size_t j = 0;
+        while (j < n && asciiLower(haystack[i + j]) == lowerNeedle[j]) ++j;
+        if (j == n) return true;
+    }
+    return false;
+}
+
+ByteSet singleByte(unsigned char c) {
+    ByteSet s;
+    s.set(c);
+    return s;
+}
+
+ByteSet byteRange(unsigned char lo, unsigned char hi) {
+    ByteSet s;
+    for (int c = lo; c <= hi; ++c) s.set(static_cast<size_t>(c));
+    return s;
+}
+
+} // namespace
+
+// 模式编译器：解析 glob / 正则为语法树，再经 NFA 构造 DFA
+class PatternCompiler {
+public:
+    std::vector<AstNode> nodes;
+    const char* error = nullptr;
+    bool anchoredStart = false;
+    bool anchoredEnd = false;
+
+    // 正则解析
+    int parseRegex(const std::string& pattern) {
+        src = &pattern;
+        pos = 0;
+        size_t end = pattern.size();
+        if (end > 0 && pattern[0] == '^') {
+            anchoredStart = true;
+            pos = 1;
+        }
+        // 末尾未被转义的 '$' 视为结尾锚点
+        if (end > pos && pattern[end - 1] == '$') {
+            size_t backslashes = 0;
+            for (size_t i = end - 1; i > pos && pattern[i - 1] == '\\'; --i) ++backslashes;
+            if (backslashes % 2 == 0) {
+                anchoredEnd = true;
+                --end;
+            }
+        }
+        limit = end;
+
+        int root = parseAlt();
+        if (root < 0) return -1;
+        if (pos != limit) return fail("Unmatched ')' in pattern");
+        return root;
+    }
+
+    // glob 解析：* 任意串，? 任意字符，[...] 字符类 ([!...] / [^...] 取反)，\ 转义
+    int parseGlob(const std::string& pattern) {
+        anchoredStart = true;
+        anchoredEnd = true;
+        src = &pattern;
+        pos = 0;
+        limit = pattern.size();
+
+        std::vector<int> parts;
+        while (pos < limit) {
+            char c = pattern[pos++];
+            if (c == '*') {
+                // 连续的 * 等价于一个
+                if (!parts.empty() && nodes[parts.back()].kind == AstNode::Kind::Star) continue;
+                parts.push_back(addUnary(AstNode::Kind::Star, addSet(ByteSet().set())));
+            } else if (c == '?') {
+                parts.push_back(addSet(ByteSet().set()));
+            } else if (c == '[') {
+                ByteSet set;
+                if (!parseClass(set, true)) return -1;
+                parts.push_back(addSet(set));
+            } else if (c == '\\' && pos < limit) {
+                parts.push_back(addSet(singleByte(static_cast<unsigned char>(pattern[pos++]))));
+            } else {
+                parts.push_back(addSet(singleByte(static_cast<unsigned char>(c))));
+            }
+        }
+        return addList(AstNode::Kind::Concat, std::move(parts));
+    }
+
+    // 由语法树构造 DFA，写入 matcher
+    bool buildDfa(int root, NameMatcher& m) {
+        auto [patStart, patEnd] = emit(root);
+        int acceptState = patEnd;
+        int start = patStart;
+
+        // 未锚定开头：等价于在模式前加 .*
+        if (!anchoredStart) {
+            int s0 = newState();
+            int loop = newState();
+            nfa[loop].set.set();
+            nfa[loop].hasSet = true;
+            nfa[loop].next = s0;
+            nfa[s0].eps = {patStart, loop};
+            start = s0;
+        }
+
+        // 计算字节等价类：对所有转移集合不可区分的字节归为一类
+        std::array<int, 256> cls{};
+        int count = 1;
+        for (const NfaState& st : nfa) {
+            if (!st.hasSet) continue;
+            std::vector<int> remap(static_cast<size_t>(count) * 2, -1);
+            int newCount = 0;
+            std::array<int, 256> next{};
+            for (int b = 0; b < 256; ++b) {
+                int key = cls[b] * 2 + (st.set[static_cast<size_t>(b)] ? 1 : 0);
+                if (remap[key] < 0) remap[key] = newCount++;
+                next[b] = remap[key];
+            }
+            cls = next;
+            count = newCount;
+        }
+        std::vector<int> representative(static_cast<size_t>(count), -1);
+        for (int b = 0; b < 256; ++b) {
+            m.byteClass[b] = static_cast<uint8_t>(cls[b]);
+            if (representative[cls[b]] < 0) representative[cls[b]] = b;
+        }
+        m.classCount = static_cast<uint32_t>(count);
+
+        // 子集构造，状态 0 为死状态 (空集)
+        std::map<std::vector<int>, uint32_t> ids;
+        std::vector<std::vector<int>> sets;
+        auto intern = [&](std::vector<int> set) -> int64_t {
+            auto it = ids.find(set);
+            if (it != ids.end()) return it->second;
+            if (sets.size() >= kMaxDfaStates) return -1;
+            uint32_t id = static_cast<uint32_t>(sets.size());
+            ids.emplace(set, id);
+            sets.push_back(std::move(set));
+            return id;
+        };
+
+        intern({});
+        int64_t startId = intern(closure({start}));
+        if (startId < 0) return failBool("Pattern too complex");
+        m.startState = static_cast<uint32_t>(startId);
+
+        for (size_t id = 0; id < sets.size(); ++id) {
+            m.transitions.resize((id + 1) * m.classCount, NameMatcher::kDeadState);
+            m.accepting.push_back(std::binary_search(sets[id].begin(), sets[id].end(), acceptState) ? 1 : 0);
+            if (sets[id].empty()) continue;
+
+            for (uint32_t c = 0; c < m.classCount; ++c) {
+                size_t byte = static_cast<size_t>(representative[c]);
+                std::vector<int> moved;
+                for (int s : sets[id]) {
+                    if (nfa[s].hasSet && nfa[s].set[byte]) moved.push_back(nfa[s].next);
+                }
+                int64_t target = moved.empty() ? NameMatcher::kDeadState : intern(closure(moved));
+                if (target < 0) return failBool("Pattern too complex");
+                // sets 可能在 intern 中扩容，这里只按下标访问
+                m.transitions[id * m.classCount + c] = static_cast<uint32_t>(target);
+            }
+        }
+        return true;
+    }
+
+    // 提取快速排除用的字面量前缀 / 后缀 / 必含子串和最短长度
+    void extractLiterals(int root, NameMatcher& m) const {
+        m.minLength = minLength(root);
+
+        std::vector<int> parts;
+        if (nodes[root].kind == AstNode::Kind::Concat) {
+            parts = nodes[root].children;
+        } else {
+            parts.push_back(root);
+        }
+        auto literalChar = [&](int idx, char& out) {
+            const AstNode& n = nodes[idx];
+            if (n.kind != AstNode::Kind::Set || n.set.count() != 1) return false;
+            for (int b = 0; b < 256; ++b) {
+                if (n.set[static_cast<size_t>(b)]) out = static_cast<char>(b);
+            }
+            return true;
+        };
+
+        char c = 0;
+        if (anchoredStart) {
+            for (size_t i = 0; i < parts.size() && literalChar(parts[i], c); ++i) m.prefix.push_back(c);
+        }
+        if (anchoredEnd) {
+            for (size_t i = parts.size(); i > 0 && literalChar(parts[i - 1], c); --i) m.suffix.insert(m.suffix.begin(), c);
+        }
+
+        std::string run;
+        std::string best;
+        for (int part : parts) {
+            if (literalChar(part, c)) {
+                run.push_back(c);
+                if (run.size() > best.size()) best = run;
+            } else {
+                run.clear();
+            }
+        }
+        if (best.size() > std::max(m.prefix.size(), m.suffix.size())) m.required = best;
+    }
+
+private:
+    const std::string* src = nullptr;
+    size_t pos = 0;
+    size_t limit = 0;
+    std::vector<NfaState> nfa;
+
+    int fail(const char* message) {
+        if (!error) error = message;
+        return -1;
+    }
+
+    bool failBool(const char* message) {
+        fail(message);
+        return false;
+    }
+
+    int addNode(AstNode node) {
+        nodes.push_back(std::move(node));
+        return static_cast<int>(nodes.size()) - 1;
+    }
+
+    int addSet(const ByteSet& set) {
+        return addNode({AstNode::Kind::Set, set, {}});
+    }
+
+    int addUnary(AstNode::Kind kind, int child) {
+        return addNode({kind, {}, {child}});
+    }
+
+    int addList(AstNode::Kind kind, std::vector<int> children) {
+        if (children.empty()) return addNode({AstNode::Kind::Empty, {}, {}});
+        if (children.size() == 1) return children[0];
+        return addNode({kind, {}, std::move(children)});
+    }
+
+    char peek() const { return pos < limit ? (*src)[pos] : '\0'; }
+
+    int parseAlt() {
+        std::vector<int> branches;
+        int first = parseConcat();
+        if (first < 0) return -1;
+        branches.push_back(first);
+        while (pos < limit && peek() == '|') {
+            ++pos;
+            int branch = parseConcat();
+            if (branch < 0) return -1;
+            branches.push_back(branch);
+        }
+        return addList(AstNode::Kind::Alt, std::move(branches));
+    }
+
+    int parseConcat() {
+        std::vector<int> parts;
+        while (pos < limit && peek() != '|' && peek() != ')') {
+            int part = parseRepeat();
+            if (part < 0) return -1;
+            parts.push_back(part);
+        }
+        return addList(AstNode::Kind::Concat, std::move(parts));
+    }
+
+    int parseRepeat() {
+        int atom = parseAtom();
+        if (atom < 0) return -1;
+        while (pos < limit) {
+            char c = peek();
+            if (c == '*') {
+                ++pos;
+                atom = addUnary(AstNode::Kind::Star, atom);
+            } else if (c == '+') {
+                ++pos;
+                atom = addUnary(AstNode::Kind::Plus, atom);
+            } else if (c == '?') {
+                ++pos;
+                atom = addUnary(AstNode::Kind::Quest, atom);
+            } else if (c == '{' && pos + 1 < limit && std::isdigit(static_cast<unsigned char>((*src)[pos + 1]))) {
+                atom = parseCounted(atom);
+                if (atom < 0) return -1;
+            } else {
+                break;
+            }
+        }
+        return atom;
+    }
+
+    // {m} / {m,} / {m,n}：通过重复引用同一子树展开
+    int parseCounted(int atom) {
+        ++pos; // '{'
+        auto readNumber = [&]() {
+            int value = 0;
+            while (pos < limit && std::isdigit(static_cast<unsigned char>(peek()))) {
+                value = std::min(value * 10 + (peek() - '0'), kMaxRepeat + 1);
+                ++pos;
+            }
+            return value;
+        };
+        int lo = readNumber();
+        int hi = lo;
+        if (peek() == ',') {
+            ++pos;
+            hi = std::isdigit(static_cast<unsigned char>(peek())) ? readNumber() : -1;
+        }
+        if (peek() != '}') return fail("Missing '}' in repetition");
+        ++pos;
+        if (lo > kMaxRepeat || hi > kMaxRepeat || (hi >= 0 && hi < lo)) {
+            return fail("Invalid repetition count");
+        }
+
+        std::vector<int> parts(static_cast<size_t>(lo), atom);
+        if (hi < 0) {
+            parts.push_back(addUnary(AstNode::Kind::Star, atom));
+        } else {
+            for (int i = lo; i < hi; ++i) parts.push_back(addUnary(AstNode::Kind::Quest, atom));
+        }
+        return addList(AstNode::Kind::Concat, std::move(parts));
+    }
+
+    int parseAtom() {
+        char c = (*src)[pos++];
+        switch (c) {
+            case '(': {
+                if (pos + 1 < limit && peek() == '?' && (*src)[pos + 1] == ':') pos += 2;
+                int inner = parseAlt();
+                if (inner < 0) return -1;
+                if (peek() != ')' || pos >= limit) return fail("Missing ')' in pattern");
+                ++pos;
+                return inner;
+            }
+            case '[': {
+                ByteSet set;
+                if (!parseClass(set, false)) return -1;
+                return addSet(set);
+            }
+            case '.':
+                return addSet(ByteSet().set());
+            case '\\': {
+                if (pos >= limit) return fail("Trailing '\\' in pattern");
+                return addSet(parseEscape((*src)[pos++]));
+            }
+            case '*':
+            case '+':
+            case '?':
+                return fail("Nothing to repeat");
+            case '^':
+            case '$':
+                return fail("Anchors are only supported at the start or end of the pattern");
+            default:
+                return addSet(singleByte(static_cast<unsigned char>(c)));
+        }
+    }
+
+    static ByteSet parseEscape(char c) {
+        ByteSet set;
+        switch (c) {
+            case 'd': return byteRange('0', '9');
+            case 'D': return ~byteRange('0', '9');
+            case 'w':
+                set = byteRange('a', 'z') | byteRange('A', 'Z') | byteRange('0', '9');
+                set.set('_');
+                return set;
+            case 'W':
+                set = byteRange('a', 'z') | byteRange('A', 'Z') | byteRange('0', '9');
+                set.set('_');
+                return ~set;
+            case 's':
+            case 'S':
+                for (char ws : {' ', '\t', '\n', '\r', '\f', '\v'}) set.set(static_cast<unsigned char>(ws));
+                return c == 's' ? set : ~set;
+            case 't': return singleByte('\t');
+            case 'n': return singleByte('\n');
+            case 'r': return singleByte('\r');
+            default: return singleByte(static_cast<unsigned char>(c));
+        }
+    }
+
+    // 解析字符类，调用时 '[' 已被消费
+    bool parseClass(ByteSet& out, bool glob) {
+        bool negate = false;
+        if (pos < limit && (peek() == '^' || (glob && peek() == '!'))) {
+            negate = true;
+            ++pos;
+        }
+        bool first = true;
+        while (pos < limit && (first || peek() != ']')) {
+            first = false;
+            char c = (*src)[pos++];
+            ByteSet item;
+            unsigned char lo = static_cast<unsigned char>(c);
+            if (c == '\\' && pos < limit) {
+                char e = (*src)[pos++];
+                item = glob ? singleByte(static_cast<unsigned char>(e)) : parseEscape(e);
+                if (item.count() != 1) {
+                    out |= item;
+                    continue;
+                }
+                lo = static_cast<unsigned char>(e);
+            }
+            // 区间 a-z
+            if (pos + 1 < limit && peek() == '-' && (*src)[pos + 1] != ']') {
+                ++pos;
+                char h = (*src)[pos++];
+                if (h == '\\' && pos < limit) h = (*src)[pos++];
+                unsigned char hi = static_cast<unsigned char>(h);
+                if (hi < lo) {
+                    fail("Invalid range in character class");
+                    return false;
+                }
+                out |= byteRange(lo, hi);
+            } else {
+                out.set(lo);
+            }
+        }
+        if (pos >= limit) {
+            fail("Missing ']' in pattern");
+            return false;
+        }
+        ++pos; // ']'
+        if (negate) out.flip();
+        return true;
+    }
+
+    int newState() {
+        nfa.emplace_back();
+        return static_cast<int>(nfa.size()) - 1;
+    }
+
+    // Thompson 构造，返回片段的 (入口, 出口)
+    std::pair<int, int> emit(int idx) {
+        const AstNode& node = nodes[idx];
+        switch (node.kind) {
+            case AstNode::Kind::Set: {
+                int s = newState();
+                int e = newState();
+                nfa[s].set = node.set;
+                nfa[s].hasSet = true;
+                nfa[s].next = e;
+                return {s, e};
+            }
+            case AstNode::Kind::Concat: {
+                std::vector<int> children = node.children;
+                auto [start, end] = emit(children[0]);
+                for (size_t i = 1; i < children.size(); ++i) {
+                    auto [s, e] = emit(children[i]);
+                    nfa[end].eps.push_back(s);
+                    end = e;
+                }
+                return {start, end};
+            }
+            case AstNode::Kind::Alt: {
+                std::vector<int> children = node.children;
+                int s = newState();
+                int e = newState();
+                for (int child : children) {
+                    auto [cs, ce] = emit(child);
+                    nfa[s].eps.push_back(cs);
+                    nfa[ce].eps.push_back(e);
+                }
+                return {s, e};
+            }
+            case AstNode::Kind::Star:
+            case AstNode::Kind::Plus:
+            case AstNode::Kind::Quest: {
+                AstNode::Kind kind = node.kind;
+                int child = node.children[0];
+                int s = newState();
+                int e = newState();
+                auto [cs, ce] = emit(child);
+                nfa[s].eps.push_back(cs);
+                if (kind != AstNode::Kind::Plus) nfa[s].eps.push_back(e);
+                nfa[ce].eps.push_back(e);
+                if (kind != AstNode::Kind::Quest) nfa[ce].eps.push_back(cs);
+                return {s, e};
+            }
+            case AstNode::Kind::Empty:
+            default: {
+                int s = newState();
+                return {s, s};
+            }
+        }
+    }
+
+    // ε 闭包，返回有序状态集合
+    std::vector<int> closure(const std::vector<int>& seeds) const {
+        std::vector<char> seen(nfa.size(), 0);
+        std::vector<int> stack(seeds);
+        std::vector<int> result;
+        while (!stack.empty()) {
+            int s = stack.back();
+            stack.pop_back();
+            if (seen[s]) continue;
+            seen[s] = 1;
+            result.push_back(s);
+            for (int t : nfa[s].eps) {
+                if (!seen[t]) stack.push_back(t);
+            }
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    size_t minLength(int idx) const {
+        const AstNode& node = nodes[idx];
+        switch (node.kind) {
+            case AstNode::Kind::Set: return 1;
+            case AstNode::Kind::Plus: return minLength(node.children[0]);
+            case AstNode::Kind::Concat: {
+                size_t total = 0;
+                for (int child : node.children) total += minLength(child);
+                return total;
+            }
+            case AstNode::Kind::Alt: {
+                size_t best = SIZE_MAX;
+                for (int child : node.children) best = std::min(best, minLength(child));
+                return best;
+            }
+            default: return 0;
+        }
+    }
+};
+
+Status NameMatcher::compile(MatchMode mode, const std::string& pattern, NameMatcher& outMatcher) {
+    outMatcher = NameMatcher();
+    outMatcher.mode = mode;
+    if (pattern.empty()) {
+        return Status::Error(StatusCode::InvalidArguments, "Empty pattern");
+    }
+
+    if (mode == MatchMode::Substring) {
+        outMatcher.lowerKeyword.reserve(pattern.size());
+        for (char c : pattern) outMatcher.lowerKeyword.push_back(asciiLower(c));
+        return Status::Success();
+    }
+
+    PatternCompiler compiler;
+    int root = (mode == MatchMode::Glob) ? compiler.parseGlob(pattern) : compiler.parseRegex(pattern);
+    if (root < 0 || !compiler.buildDfa(root, outMatcher)) {
+        return Status::Error(StatusCode::InvalidArguments, compiler.error ? compiler.error : "Invalid pattern", pattern);
+    }
+    outMatcher.anchoredEnd = compiler.anchoredEnd;
+    compiler.extractLiterals(root, outMatcher);
+    return Status::Success();
+}
+
+bool NameMatcher::matches(std::string_view name) const {
+    if (mode == MatchMode::Substring) {
+        return containsIgnoreCase(name, lowerKeyword);
+    }
+
+    // 字面量快速排除
+    if (name.size() < minLength) return false;
+    if (!prefix.empty() && !name.starts_with(prefix)) return false;
+    if (!suffix.empty() && !name.ends_with(suffix)) return false;
+    if (!required.empty() && name.find(required) == std::string_view::npos) return false;
+
+    uint32_t state = startState;
+    if (!anchoredEnd && accepting[state]) return true;
+    for (unsigned char c : name) {
+        state = transitions[state * classCount + byteClass[c]];
+        if (state == kDeadState) return false;
+        if (!anchoredEnd && accepting[state]) return true;
+    }
+    return accepting[state] != 0;
+}
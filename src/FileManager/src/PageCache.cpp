@@ -0,0 +1,162 @@
+#include "FileManager.h"
+#include "AllocTracker.h"
+#include "TreeWalker.h"
+#include "IoThrottle.h"
+#include "Parallel.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t kMincoreWindow = size_t(1) << 30; // mincore 每次查询的范围，限制结果向量的大小
+constexpr uint64_t kWarmChunk = uint64_t(8) << 20;  // 预读时单次 readahead 的长度
+
+uint64_t pageSize() {
+    static const uint64_t size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+uint64_t pageCount(uint64_t bytes) {
+    return (bytes + pageSize() - 1) / pageSize();
+}
+
+// 映射区域中驻留在页缓存中的页数
+uint64_t residentPages(const MappedFile& file, std::vector<unsigned char>& vec) {
+    uint64_t resident = 0;
+    for (size_t begin = 0; begin < file.size(); begin += kMincoreWindow) {
+        size_t len = std::min(kMincoreWindow, file.size() - begin);
+        vec.resize(pageCount(len));
+        if (mincore(const_cast<uint8_t*>(file.data()) + begin, len, vec.data()) != 0) break;
+        for (unsigned char state : vec) resident += state & 1;
+    }
+    return resident;
+}
+
+// 分块读入页缓存：先对下一块发出 readahead，再读取当前块
+// readahead 只提交 I/O 而不等待完成，读取当前块使命令返回时数据确实已在页缓存中，
+// 同时下一块的 I/O 已在进行；每块之前向限流器申请配额
+void warmFile(int fd, uint64_t size, std::vector<char>& buffer) {
+    IoThrottle& throttle = IoThrottle::instance();
+    buffer.resize(kWarmChunk);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    for (uint64_t offset = 0; offset < size;) {
+        uint64_t chunk = std::min({kWarmChunk, size - offset, throttle.maxChunk()});
+        IoThrottle::Slot slot(throttle);
+        throttle.acquire(chunk);
+        uint64_t next = offset + chunk;
+        if (next < size) readahead(fd, static_cast<off64_t>(next), static_cast<size_t>(std::min(kWarmChunk, size - next)));
+        ssize_t n = pread(fd, buffer.data(), static_cast<size_t>(chunk), static_cast<off_t>(offset));
+        if (n <= 0) return;
+        offset += static_cast<uint64_t>(n);
+    }
+}
+
+// 对目标下的每个普通文件调用 fn(path, worker)，worker ∈ [0, threads)
+// 目标是目录时以 threads 个线程遍历，fn 会在多个线程上并发执行
+template <typename Fn>
+Status forEachFile(const fs::path& target, const WalkOptions& options, unsigned threads, Fn&& fn) {
+    std::error_code ec;
+    fs::file_status status = fs::status(target, ec);
+    if (!fs::exists(status)) return Status::Error(StatusCode::PathNotFound, "Target not found", target);
+    if (fs::is_regular_file(status)) {
+        fn(target.string(), 0u);
+        return Status::Success();
+    }
+    if (!fs::is_directory(status)) return Status::Error(StatusCode::NotAFile, "Not a regular file", target);
+
+    ParallelWalker walker(threads);
+    Status result = walker.setOptions(options);
+    if (!result.ok()) return result;
+    int err = walker.walk(target, [&](WalkEntry& entry, unsigned worker) {
+        if (entry.type == FileType::File) fn(std::string(entry.path), worker);
+        return WalkAction::Continue;
+    });
+    if (err != 0) return Status::SystemError(StatusCode::PermissionDenied, "Cannot open directory", target, err);
+    return Status::Success();
+}
+
+} // namespace
+
+Status FileManager::cacheStatus(const Path& targetPath, const WalkOptions& options,
+                                std::vector<CacheResidency>& outFiles, CacheResidency& outTotal) const {
+    AllocScope resultScope(AllocCategory::Results);
+    outFiles.clear();
+    outTotal = CacheResidency();
+    fs::path target = resolvePath(targetPath);
+
+    // 每个线程的结果与 mincore 缓冲区，遍历结束后合并
+    struct alignas(64) WorkerState {
+        std::vector<CacheResidency> files;
+        std::vector<unsigned char> vec;
+    };
+    std::vector<WorkerState> workers(defaultThreadCount());
+    Status status = forEachFile(target, options, static_cast<unsigned>(workers.size()), [&](std::string path, unsigned worker) {
+        MappedFile file;
+        if (file.open(path) != 0) return;
+        WorkerState& state = workers[worker];
+        CacheResidency residency;
+        residency.path = std::move(path);
+        residency.files = 1;
+        residency.bytes = file.size();
+        residency.pages = pageCount(file.size());
+        residency.residentPages = residentPages(file, state.vec);
+        state.files.push_back(std::move(residency));
+    });
+    if (!status.ok()) return status;
+
+    for (auto& state : workers) {
+        std::move(state.files.begin(), state.files.end(), std::back_inserter(outFiles));
+    }
+    std::sort(outFiles.begin(), outFiles.end(),
+              [](const CacheResidency& a, const CacheResidency& b) { return a.path < b.path; });
+    outTotal.path = target.string();
+    for (const auto& file : outFiles) {
+        outTotal.files += 1;
+        outTotal.bytes += file.bytes;
+        outTotal.pages += file.pages;
+        outTotal.residentPages += file.residentPages;
+    }
+    return Status::Success();
+}
+
+Status FileManager::adviseCache(const Path& targetPath, CacheAction action, const WalkOptions& options,
+                                CacheResidency& outTotal) const {
+    outTotal = CacheResidency();
+    fs::path target = resolvePath(targetPath);
+
+    struct alignas(64) WorkerTotal {
+        uintmax_t files = 0;
+        uintmax_t bytes = 0;
+        uintmax_t pages = 0;
+        std::vector<char> buffer; // 预读时的读取缓冲区
+    };
+    std::vector<WorkerTotal> totals(defaultThreadCount());
+    Status status = forEachFile(target, options, static_cast<unsigned>(totals.size()), [&](const std::string& path, unsigned worker) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            uint64_t size = static_cast<uint64_t>(st.st_size);
+            if (action == CacheAction::Warm) warmFile(fd, size, totals[worker].buffer);
+            else posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            totals[worker].files += 1;
+            totals[worker].bytes += size;
+            totals[worker].pages += pageCount(size);
+        }
+        close(fd);
+    });
+    if (!status.ok()) return status;
+
+    outTotal.path = target.string();
+    for (const auto& total : totals) {
+        outTotal.files += total.files;
+        outTotal.bytes += total.bytes;
+        outTotal.pages += total.pages;
+    }
+    return Status::Success();
+}
@@ -0,0 +1,295 @@
+#include "Snapshot.h"
+#include "FileManager.h"
+#include "AllocTracker.h"
+#include "TreeWalker.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr char kMagic[8] = {'M', 'F', 'E', 'S', 'N', 'A', 'P', '1'};
+constexpr uint32_t kVersion = 1;
+
+uint64_t alignUp(uint64_t value) {
+    return (value + 7) & ~uint64_t(7);
+}
+
+struct InodeKey {
+    uint64_t dev;
+    uint64_t inode;
+    bool operator==(const InodeKey& other) const { return dev == other.dev && inode == other.inode; }
+};
+
+struct InodeKeyHash {
+    size_t operator()(const InodeKey& key) const {
+        return std::hash<uint64_t>()(key.inode * 0x9E3779B97F4A7C15ULL ^ key.dev);
+    }
+};
+
+std::string_view parentOf(std::string_view path) {
+    size_t slash = path.rfind('/');
+    return slash == std::string_view::npos ? std::string_view() : path.substr(0, slash);
+}
+
+std::string_view baseName(std::string_view path) {
+    size_t slash = path.rfind('/');
+    return slash == std::string_view::npos ? path : path.substr(slash + 1);
+}
+
+} // namespace
+
+namespace fs = std::filesystem;
+
+Status SnapshotReader::open(const std::string& path) {
+    int err = file.open(path);
+    if (err != 0) {
+        return Status::SystemError(StatusCode::PathNotFound, "Cannot open snapshot", path, err);
+    }
+
+    const uint8_t* base = file.data();
+    size_t total = file.size();
+    if (total < sizeof(SnapshotHeader)) {
+        return Status::Error(StatusCode::InvalidArguments, "Not a snapshot file", path);
+    }
+
+    SnapshotHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.recordSize != sizeof(SnapshotRecord)) {
+        return Status::Error(StatusCode::InvalidArguments, "Not a snapshot file or unsupported version", path);
+    }
+
+    // 长度字段来自文件内容，先逐段确认不超出文件再计算偏移，避免回绕
+    if (header.rootLen > total - sizeof(SnapshotHeader)) {
+        return Status::Error(StatusCode::InvalidArguments, "Corrupted snapshot file", path);
+    }
+    uint64_t recordsOffset = alignUp(sizeof(SnapshotHeader) + header.rootLen);
+    if (recordsOffset > total || header.entryCount > (total - recordsOffset) / sizeof(SnapshotRecord)) {
+        return Status::Error(StatusCode::InvalidArguments, "Corrupted snapshot file", path);
+    }
+    uint64_t stringsOffset = recordsOffset + header.entryCount * sizeof(SnapshotRecord);
+    if (header.stringBytes != total - stringsOffset) {
+        return Status::Error(StatusCode::InvalidArguments, "Corrupted snapshot file", path);
+    }
+
+    records = reinterpret_cast<const SnapshotRecord*>(base + recordsOffset);
+    strings = reinterpret_cast<const char*>(base + stringsOffset);
+    count = header.entryCount;
+    created = header.createdAt;
+    rootPath = std::string_view(reinterpret_cast<const char*>(base + sizeof(SnapshotHeader)), header.rootLen);
+
+    for (uint64_t i = 0; i < count; ++i) {
+        if (records[i].pathLen > header.stringBytes || records[i].pathOffset > header.stringBytes - records[i].pathLen) {
+            return Status::Error(StatusCode::InvalidArguments, "Corrupted snapshot file", path);
+        }
+    }
+    return Status::Success();
+}
+
+Result<uint64_t> writeSnapshot(const Path& root, const std::string& file) {
+    std::string pool;
+    std::vector<SnapshotRecord> records;
+    const size_t rootLen = root.string().size();
+
+    TreeWalker walker;
+    int err = walker.walk(root, [&](WalkEntry& entry) {
+        const struct stat* st = entry.stat();
+        if (!st) return WalkAction::Continue;
+
+        // 路径相对于根目录存放
+        std::string_view rel = entry.path.substr(rootLen);
+        if (!rel.empty() && rel.front() == '/') rel.remove_prefix(1);
+
+        SnapshotRecord rec{};
+        rec.pathOffset = pool.size();
+        rec.pathLen = static_cast<uint32_t>(rel.size());
+        rec.type = static_cast<uint8_t>(entry.type);
+        rec.size = entry.type == FileType::Directory ? 0 : static_cast<uint64_t>(st->st_size);
+        rec.mtimeNs = static_cast<int64_t>(st->st_mtim.tv_sec) * 1000000000LL + st->st_mtim.tv_nsec;
+        rec.inode = st->st_ino;
+        rec.dev = st->st_dev;
+        pool.append(rel);
+        records.push_back(rec);
+        return WalkAction::Continue;
+    });
+    if (err != 0) {
+        return std::unexpected(Status::SystemError(StatusCode::PermissionDenied, "Cannot open directory", root, err));
+    }
+
+    auto pathOf = [&](const SnapshotRecord& r) { return std::string_view(pool).substr(r.pathOffset, r.pathLen); };
+    std::sort(records.begin(), records.end(),
+        [&](const SnapshotRecord& a, const SnapshotRecord& b) { return pathOf(a) < pathOf(b); });
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.recordSize = sizeof(SnapshotRecord);
+    header.entryCount = records.size();
+    header.stringBytes = pool.size();
+    header.createdAt = static_cast<int64_t>(std::time(nullptr));
+    header.rootLen = rootLen;
+
+    // 先写临时文件，成功后再替换，避免留下半个快照
+    std::string tmpFile = file + ".tmp";
+    std::FILE* out = std::fopen(tmpFile.c_str(), "wb");
+    if (!out) {
+        return std::unexpected(Status::SystemError(StatusCode::PermissionDenied, "Cannot write snapshot", file, errno));
+    }
+    std::setvbuf(out, nullptr, _IOFBF, 1 << 20);
+
+    const std::string rootStr = root.string();
+    const char padding[8] = {};
+    size_t padLen = alignUp(sizeof(header) + rootLen) - (sizeof(header) + rootLen);
+    bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1 &&
+              std::fwrite(rootStr.data(), 1, rootLen, out) == rootLen &&
+              std::fwrite(padding, 1, padLen, out) == padLen &&
+              std::fwrite(records.data(), sizeof(SnapshotRecord), records.size(), out) == records.size() &&
+              std::fwrite(pool.data(), 1, pool.size(), out) == pool.size();
+    ok = (std::fclose(out) == 0) && ok;
+    if (!ok || std::rename(tmpFile.c_str(), file.c_str()) != 0) {
+        int writeErr = errno;
+        std::remove(tmpFile.c_str());
+        return std::unexpected(Status::SystemError(StatusCode::PermissionDenied, "Cannot write snapshot", file, writeErr));
+    }
+
+    return records.size();
+}
+
+void compareSnapshots(const SnapshotReader& before, const SnapshotReader& after, std::vector<SnapshotChange>& outChanges) {
+    outChanges.clear();
+    std::vector<uint64_t> removed;
+    std::vector<uint64_t> added;
+
+    // 两个快照都按路径有序，线性归并
+    uint64_t i = 0;
+    uint64_t j = 0;
+    while (i < before.size() || j < after.size()) {
+        int cmp;
+        if (i == before.size()) cmp = 1;
+        else if (j == after.size()) cmp = -1;
+        else {
+            std::string_view a = before.path(i);
+            std::string_view b = after.path(j);
+            cmp = a < b ? -1 : (b < a ? 1 : 0);
+        }
+
+        if (cmp < 0) {
+            removed.push_back(i++);
+        } else if (cmp > 0) {
+            added.push_back(j++);
+        } else {
+            const SnapshotRecord& a = before.record(i);
+            const SnapshotRecord& b = after.record(j);
+            bool changed = a.type != b.type ||
+                           (a.type != static_cast<uint8_t>(FileType::Directory) &&
+                            (a.size != b.size || a.mtimeNs != b.mtimeNs || a.inode != b.inode));
+            if (changed) {
+                outChanges.push_back({ChangeKind::Modified, std::string(before.path(i)), {},
+                                      static_cast<FileType>(b.type), a.size, b.size});
+            }
+            ++i;
+            ++j;
+        }
+    }
+
+    // 用 (dev, inode) 匹配消失与新增的条目，识别移动
+    std::unordered_map<InodeKey, size_t, InodeKeyHash> removedByInode; // -> removed 中的下标
+    removedByInode.reserve(removed.size());
+    for (size_t k = 0; k < removed.size(); ++k) {
+        const SnapshotRecord& r = before.record(removed[k]);
+        removedByInode.emplace(InodeKey{r.dev, r.inode}, k);
+    }
+
+    std::unordered_map<std::string_view, std::string_view> movedTo; // 旧路径 -> 新路径
+    std::vector<char> removedConsumed(removed.size(), 0);
+    std::vector<std::pair<uint64_t, uint64_t>> moves;
+    std::vector<uint64_t> trulyAdded;
+    for (uint64_t idx : added) {
+        const SnapshotRecord& r = after.record(idx);
+        auto it = removedByInode.find(InodeKey{r.dev, r.inode});
+        // rename 不改变文件的大小和修改时间，据此排除 inode 被复用的情况
+        bool sameObject = false;
+        if (it != removedByInode.end()) {
+            const SnapshotRecord& old = before.record(removed[it->second]);
+            sameObject = old.type == r.type &&
+                         (r.type == static_cast<uint8_t>(FileType::Directory) ||
+                          (old.size == r.size && old.mtimeNs == r.mtimeNs));
+        }
+        if (sameObject) {
+            uint64_t oldIdx = removed[it->second];
+            moves.emplace_back(oldIdx, idx);
+            movedTo.emplace(before.path(oldIdx), after.path(idx));
+            removedConsumed[it->second] = 1;
+            removedByInode.erase(it);
+        } else {
+            trulyAdded.push_back(idx);
+        }
+    }
+
+    for (size_t k = 0; k < removed.size(); ++k) {
+        if (removedConsumed[k]) continue;
+        const SnapshotRecord& r = before.record(removed[k]);
+        outChanges.push_back({ChangeKind::Removed, std::string(before.path(removed[k])), {},
+                              static_cast<FileType>(r.type), r.size, 0});
+    }
+    for (uint64_t idx : trulyAdded) {
+        const SnapshotRecord& r = after.record(idx);
+        outChanges.push_back({ChangeKind::Added, std::string(after.path(idx)), {},
+                              static_cast<FileType>(r.type), 0, r.size});
+    }
+
+    // 目录整体移动时，只报告最上层的移动
+    for (const auto& [oldIdx, newIdx] : moves) {
+        std::string_view oldPath = before.path(oldIdx);
+        std::string_view newPath = after.path(newIdx);
+        auto parent = movedTo.find(parentOf(oldPath));
+        if (parent != movedTo.end() && parent->second == parentOf(newPath) && baseName(oldPath) == baseName(newPath)) {
+            continue;
+        }
+        const SnapshotRecord& r = after.record(newIdx);
+        outChanges.push_back({ChangeKind::Moved, std::string(oldPath), std::string(newPath),
+                              static_cast<FileType>(r.type), before.record(oldIdx).size, r.size});
+    }
+
+    std::sort(outChanges.begin(), outChanges.end(),
+        [](const SnapshotChange& a, const SnapshotChange& b) { return a.path < b.path; });
+}
+
+Status FileManager::saveSnapshot(const Path& dirPath, const Path& snapshotFile, uintmax_t& outEntries) {
+    AllocScope resultScope(AllocCategory::Results);
+    outEntries = 0;
+    fs::path targetDir = resolvePath(dirPath);
+    if (!fs::exists(targetDir) || !fs::is_directory(targetDir)) {
+        return Status::Error(StatusCode::PathNotFound, "Invalid directory", std::move(targetDir));
+    }
+
+    fs::path outFile = resolvePath(snapshotFile);
+    Result<uint64_t> entries = writeSnapshot(targetDir, outFile.string());
+    if (!entries) {
+        return std::move(entries.error());
+    }
+    invalidateCaches(outFile);
+
+    outEntries = *entries;
+    return Status::Success();
+}
+
+Status FileManager::diffSnapshots(const Path& beforeFile, const Path& afterFile, std::vector<SnapshotChange>& outChanges) const {
+    AllocScope resultScope(AllocCategory::Results);
+    outChanges.clear();
+    SnapshotReader before;
+    SnapshotReader after;
+    Status status = before.open(resolvePath(beforeFile).string());
+    if (status.ok()) status = after.open(resolvePath(afterFile).string());
+    if (!status.ok()) {
+        return status;
+    }
+
+    compareSnapshots(before, after, outChanges);
+    return Status::Success();
+}
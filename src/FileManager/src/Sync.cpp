@@ -0,0 +1,309 @@
+#include "FileManager.h"
+#include "AllocTracker.h"
+#include "TreeWalker.h"
+#include "Parallel.h"
+#include "WorkQueue.h"
+#include "FileCopy.h"
+#include "StringHash.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr unsigned kMaxCopyThreads = 8;
+constexpr size_t kCompareBufferSize = size_t(1) << 20;
+
+// 逐字节比较两个文件，遇到第一个差异立即返回
+bool sameContent(const std::string& a, const std::string& b, std::vector<char>& bufA, std::vector<char>& bufB) {
+    int fa = open(a.c_str(), O_RDONLY | O_CLOEXEC);
+    int fb = open(b.c_str(), O_RDONLY | O_CLOEXEC);
+    bool same = fa >= 0 && fb >= 0;
+    while (same) {
+        ssize_t na = read(fa, bufA.data(), bufA.size());
+        ssize_t nb = read(fb, bufB.data(), bufB.size());
+        if (na < 0 || nb < 0 || na != nb) {
+            same = false;
+            break;
+        }
+        if (na == 0) break;
+        same = std::memcmp(bufA.data(), bufB.data(), static_cast<size_t>(na)) == 0;
+    }
+    if (fa >= 0) close(fa);
+    if (fb >= 0) close(fb);
+    return same;
+}
+
+bool sameLinkTarget(const Path& a, const Path& b) {
+    std::error_code ecA;
+    std::error_code ecB;
+    Path targetA = std::filesystem::read_symlink(a, ecA);
+    Path targetB = std::filesystem::read_symlink(b, ecB);
+    return !ecA && !ecB && targetA == targetB;
+}
+
+bool isWithin(const Path& inner, const Path& outer) {
+    Path rel = inner.lexically_relative(outer);
+    return !rel.empty() && *rel.begin() != "..";
+}
+
+enum class SyncJobKind { Copy, CompareThenCopy, Symlink };
+
+struct SyncJob {
+    SyncJobKind kind;
+    std::string rel;
+    uint64_t size;
+};
+
+} // namespace
+
+Status FileManager::syncTree(const Path& src, const Path& dst, const SyncOptions& options, SyncReport& outReport) {
+    AllocScope resultScope(AllocCategory::Results);
+    outReport = SyncReport();
+    fs::path srcRoot = resolvePath(src).lexically_normal();
+    fs::path dstRoot = resolvePath(dst).lexically_normal();
+    if (!srcRoot.has_filename()) srcRoot = srcRoot.parent_path();
+    if (!dstRoot.has_filename()) dstRoot = dstRoot.parent_path();
+
+    if (!fs::exists(srcRoot)) {
+        return Status::Error(StatusCode::PathNotFound, "Source not found", std::move(srcRoot));
+    }
+    if (!fs::is_directory(srcRoot)) {
+        return Status::Error(StatusCode::NotADirectory, "Not a directory", std::move(srcRoot));
+    }
+    // 按解析符号链接与 .. 之后的真实路径判断两棵树是否重叠
+    // 源在目标内时，--delete 会把源当作目标独有的条目删除
+    std::error_code canonicalError;
+    fs::path srcReal = fs::weakly_canonical(srcRoot, canonicalError);
+    if (canonicalError) srcReal = srcRoot;
+    fs::path dstReal = fs::weakly_canonical(dstRoot, canonicalError);
+    if (canonicalError) dstReal = dstRoot;
+    if (srcRoot == dstRoot || isWithin(dstRoot, srcRoot) || srcReal == dstReal || isWithin(dstReal, srcReal)) {
+        return Status::Error(StatusCode::InvalidArguments, "Invalid target path: destination is inside the source");
+    }
+    if (isWithin(srcRoot, dstRoot) || isWithin(srcReal, dstReal)) {
+        return Status::Error(StatusCode::InvalidArguments, "Invalid target path: source is inside the destination");
+    }
+    if (fs::exists(dstRoot) && !fs::is_directory(dstRoot)) {
+        return Status::Error(StatusCode::NotADirectory, "Not a directory", std::move(dstRoot));
+    }
+    if (!fs::exists(dstRoot) && !options.dryRun) {
+        std::error_code ec;
+        fs::create_directories(dstRoot, ec);
+        if (ec) {
+            return Status::SystemError(StatusCode::PermissionDenied, "Cannot create directory", std::move(dstRoot), ec.value());
+        }
+    }
+
+    // 两棵树同时遍历
+    TreeListing srcList;
+    TreeListing dstList;
+    std::thread dstWalker([&]() {
+        if (fs::exists(dstRoot)) listTree(dstRoot, dstList);
+    });
+    listTree(srcRoot, srcList);
+    dstWalker.join();
+    if (srcList.err != 0) {
+        return Status::SystemError(StatusCode::PermissionDenied, "Cannot open directory", std::move(srcRoot), srcList.err);
+    }
+    // 目标存在却无法列出时不能当作空目录，否则会全部重新复制，--delete 也不会删除任何条目
+    if (dstList.err != 0) {
+        return Status::SystemError(Status::codeFromErrno(dstList.err), "Cannot open directory", std::move(dstRoot), dstList.err);
+    }
+
+    std::mutex reportMutex;
+    auto recordError = [&](const char* what, std::string_view rel, int err) {
+        std::lock_guard<std::mutex> lock(reportMutex);
+        outReport.errors.add(StatusCode::CopyFailed, what, rel, err);
+    };
+
+    // 复制线程：与下面的比较循环构成流水线
+    std::atomic<uintmax_t> filesCopied{0};
+    std::atomic<uintmax_t> bytesCopied{0};
+    std::atomic<uintmax_t> filesUnchanged{0};
+    WorkQueue<SyncJob> queue;
+    std::vector<std::thread> workers;
+    unsigned threads = options.dryRun ? 0 : std::min(defaultThreadCount(), kMaxCopyThreads);
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            std::vector<char> bufA(kCompareBufferSize);
+            std::vector<char> bufB(kCompareBufferSize);
+            while (auto job = queue.pop()) {
+                std::string from = (srcRoot / job->rel).string();
+                std::string to = (dstRoot / job->rel).string();
+
+                if (job->kind == SyncJobKind::Symlink) {
+                    std::error_code ec;
+                    fs::path target = fs::read_symlink(from, ec);
+                    if (!ec) fs::remove(to, ec);
+                    if (!ec) fs::create_symlink(target, to, ec);
+                    if (ec) recordError("Cannot create link", job->rel, ec.value());
+                    continue;
+                }
+
+                if (job->kind == SyncJobKind::CompareThenCopy && sameContent(from, to, bufA, bufB)) {
+                    filesUnchanged.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+
+                // 先写同目录下的临时文件再 rename，目标要么是旧版本要么是完整的新版本
+                fs::path toPath(to);
+                std::string tmp = (toPath.parent_path() / ("." + toPath.filename().string() + ".mfesync")).string();
+                int err = copyRegularFile(from, tmp);
+                if (err == 0 && rename(tmp.c_str(), to.c_str()) != 0) err = errno;
+                if (err != 0) {
+                    unlink(tmp.c_str());
+                    recordError("Cannot copy", job->rel, err);
+                    continue;
+                }
+                filesCopied.fetch_add(1, std::memory_order_relaxed);
+                bytesCopied.fetch_add(job->size, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    auto schedule = [&](SyncJobKind kind, std::string_view rel, uint64_t size) {
+        if (options.dryRun) {
+            const char* verb = kind == SyncJobKind::Symlink ? "link   " : kind == SyncJobKind::Copy ? "copy   " : "verify ";
+            outReport.plannedActions.push_back(verb + std::string(rel));
+            if (kind == SyncJobKind::Copy) {
+                // 预演时按将要复制的量统计
+                filesCopied.fetch_add(1, std::memory_order_relaxed);
+                bytesCopied.fetch_add(size, std::memory_order_relaxed);
+            }
+            return;
+        }
+        queue.push({kind, std::string(rel), size});
+    };
+
+    // 目标条目本身 (不跟随条目自身的链接) 是源或包含源时不删除，防止经挂载点等途径绕过上面的检查
+    auto containsSource = [&](std::string_view rel) {
+        fs::path entry = dstRoot / rel;
+        std::error_code ec;
+        fs::path parent = fs::weakly_canonical(entry.parent_path(), ec);
+        if (ec) return false;
+        fs::path real = parent / entry.filename();
+        return real == srcReal || isWithin(srcReal, real);
+    };
+
+    auto removeEntry = [&](std::string_view rel) {
+        if (containsSource(rel)) {
+            std::lock_guard<std::mutex> lock(reportMutex);
+            outReport.errors.add(StatusCode::InvalidArguments, "Refusing to remove the source", (dstRoot / rel).native());
+            return false;
+        }
+        if (options.dryRun) {
+            outReport.plannedActions.push_back("delete " + std::string(rel));
+            return true;
+        }
+        std::error_code ec;
+        fs::remove_all(dstRoot / rel, ec);
+        if (ec) {
+            recordError("Cannot remove", rel, ec.value());
+            return false;
+        }
+        return true;
+    };
+
+    // 归并比较两个有序列表
+    // 已删除的目标目录，其子项无需再处理
+    // 子项不一定紧跟在目录之后 ("x-1" 排在 "x" 与 "x/..." 之间)，因此逐级检查所有上级目录
+    std::unordered_set<std::string, StringHash, std::equal_to<>> deletedDirs;
+    auto underDeleted = [&](std::string_view rel) {
+        if (deletedDirs.empty()) return false;
+        for (size_t slash = rel.rfind('/'); slash != std::string_view::npos; slash = rel.rfind('/')) {
+            rel = rel.substr(0, slash);
+            if (deletedDirs.find(rel) != deletedDirs.end()) return true;
+        }
+        return false;
+    };
+
+    size_t i = 0;
+    size_t j = 0;
+    while (i < srcList.entries.size() || j < dstList.entries.size()) {
+        int cmp;
+        if (i == srcList.entries.size()) cmp = 1;
+        else if (j == dstList.entries.size()) cmp = -1;
+        else {
+            std::string_view a = srcList.path(srcList.entries[i]);
+            std::string_view b = dstList.path(dstList.entries[j]);
+            cmp = a < b ? -1 : (b < a ? 1 : 0);
+        }
+
+        if (cmp > 0) {
+            // 仅存在于目标
+            const auto& d = dstList.entries[j++];
+            std::string_view rel = dstList.path(d);
+            if (options.deleteExtras && !underDeleted(rel) && removeEntry(rel)) {
+                outReport.entriesDeleted++;
+                if (d.type == FileType::Directory) deletedDirs.emplace(rel);
+            }
+            continue;
+        }
+
+        const auto& s = srcList.entries[i++];
+        std::string_view rel = srcList.path(s);
+        const TreeListing::Entry* d = nullptr;
+        if (cmp == 0) d = &dstList.entries[j++];
+
+        // 类型不同：先移除目标上的旧条目
+        if (d && d->type != s.type) {
+            if (!removeEntry(rel)) continue;
+            if (d->type == FileType::Directory) deletedDirs.emplace(rel);
+            d = nullptr;
+        }
+
+        switch (s.type) {
+            case FileType::Directory:
+                if (!d) {
+                    if (options.dryRun) {
+                        outReport.plannedActions.push_back("mkdir  " + std::string(rel));
+                    } else {
+                        std::error_code ec;
+                        fs::create_directory(dstRoot / rel, ec);
+                        if (ec) {
+                            recordError("Cannot create directory", rel, ec.value());
+                            break;
+                        }
+                    }
+                    outReport.dirsCreated++;
+                }
+                break;
+            case FileType::File:
+                if (!d || d->size != s.size || d->mtimeSec != s.mtimeSec) {
+                    schedule(SyncJobKind::Copy, rel, s.size);
+                } else if (options.checksum) {
+                    schedule(SyncJobKind::CompareThenCopy, rel, s.size);
+                } else {
+                    filesUnchanged.fetch_add(1, std::memory_order_relaxed);
+                }
+                break;
+            case FileType::Symlink:
+                // 新建的链接无法保留修改时间，按指向的目标比较
+                if (!d || d->size != s.size || !sameLinkTarget(srcRoot / rel, dstRoot / rel)) {
+                    schedule(SyncJobKind::Symlink, rel, 0);
+                } else {
+                    filesUnchanged.fetch_add(1, std::memory_order_relaxed);
+                }
+                break;
+            default:
+                break; // 设备文件、套接字等不同步
+        }
+    }
+
+    queue.close();
+    for (auto& worker : workers) worker.join();
+
+    outReport.filesCopied = filesCopied.load();
+    outReport.bytesCopied = bytesCopied.load();
+    outReport.filesUnchanged = filesUnchanged.load();
+    if (!options.dryRun) invalidateCaches(dstRoot);
+    return Status::Success();
+}
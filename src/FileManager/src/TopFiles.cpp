@@ -0,0 +1,103 @@
+#include "FileManager.h"
+#include "AllocTracker.h"
+#include "TreeWalker.h"
+#include <algorithm>
+#include <string_view>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 候选文件，key 越大越靠前 (更大或更旧)
+struct Candidate {
+    std::pair<int64_t, int64_t> key;
+    std::string path;
+    uintmax_t size = 0;
+    struct timespec mtime {};
+};
+
+// a 是否排在 b 之前，key 相同时按路径排序使结果稳定
+bool ranksBefore(const std::pair<int64_t, int64_t>& keyA, std::string_view pathA,
+                 const std::pair<int64_t, int64_t>& keyB, std::string_view pathB) {
+    if (keyA != keyB) return keyA > keyB;
+    return pathA < pathB;
+}
+
+// 堆顶为当前保留的最靠后的候选
+struct WorseFirst {
+    bool operator()(const Candidate& a, const Candidate& b) const {
+        return ranksBefore(a.key, a.path, b.key, b.path);
+    }
+};
+
+// 每个遍历线程独占的有界堆
+struct alignas(64) TopHeap {
+    std::vector<Candidate> heap;
+};
+
+} // namespace
+
+Status FileManager::topFiles(const Path& dirPath, const TopOptions& options, std::vector<FileInfo>& outFiles) const {
+    AllocScope resultScope(AllocCategory::Results);
+    outFiles.clear();
+    if (options.count == 0) {
+        return Status::Error(StatusCode::InvalidArguments, "Count must be at least 1");
+    }
+    if (options.by != SortMode::BySize && options.by != SortMode::ByTime) {
+        return Status::Error(StatusCode::InvalidArguments, "Unsupported sort key");
+    }
+    const size_t count = options.count;
+    const bool bySize = options.by == SortMode::BySize;
+    fs::path target = resolvePath(dirPath);
+
+    ParallelWalker walker;
+    Status status = walker.setOptions(options.walk);
+    if (!status.ok()) return status;
+    std::vector<TopHeap> heaps(walker.threadCount());
+
+    int err = walker.walk(target, [&](WalkEntry& entry, unsigned worker) {
+        if (entry.type != FileType::File) return WalkAction::Continue;
+        const struct stat* st = entry.stat();
+        if (!st) return WalkAction::Continue;
+
+        std::pair<int64_t, int64_t> key = bySize
+            ? std::pair<int64_t, int64_t>(st->st_size, 0)
+            : std::pair<int64_t, int64_t>(-static_cast<int64_t>(st->st_mtim.tv_sec), -static_cast<int64_t>(st->st_mtim.tv_nsec));
+        auto& heap = heaps[worker].heap;
+        // 堆满时先与堆顶比较，未入选的条目不复制路径
+        if (heap.size() == count) {
+            if (!ranksBefore(key, entry.path, heap.front().key, heap.front().path)) return WalkAction::Continue;
+            std::pop_heap(heap.begin(), heap.end(), WorseFirst());
+            heap.pop_back();
+        }
+        heap.push_back({key, std::string(entry.path), static_cast<uintmax_t>(st->st_size), st->st_mtim});
+        std::push_heap(heap.begin(), heap.end(), WorseFirst());
+        return WalkAction::Continue;
+    });
+    if (err != 0) {
+        return Status::SystemError(Status::codeFromErrno(err), "Cannot open directory", std::move(target), err);
+    }
+
+    // 合并各线程的堆，每个堆至多 count 项
+    std::vector<Candidate> merged;
+    for (auto& top : heaps) {
+        std::move(top.heap.begin(), top.heap.end(), std::back_inserter(merged));
+        top.heap = std::vector<Candidate>();
+    }
+    size_t keep = std::min(count, merged.size());
+    std::partial_sort(merged.begin(), merged.begin() + keep, merged.end(), WorseFirst());
+    merged.resize(keep);
+
+    outFiles.reserve(keep);
+    for (auto& candidate : merged) {
+        FileInfo info;
+        info.path = std::move(candidate.path);
+        info.name = info.path.filename().string();
+        info.type = FileType::File;
+        info.size = candidate.size;
+        info.modifyTime = toFileTime(candidate.mtime);
+        outFiles.push_back(std::move(info));
+    }
+    return Status::Success();
+}
@@ -0,0 +1,364 @@
+#include "TrashManager.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr auto kScanInterval = std::chrono::seconds(60);
+
+int64_t unixNow() {
+    return static_cast<int64_t>(std::time(nullptr));
+}
+
+// 创建回收站目录及其子目录，并确认它属于当前用户、位于期望的文件系统
+bool prepareTrashDir(const Path& dir, dev_t dev) {
+    for (const char* sub : {"", "files", "info", "purging"}) {
+        Path p = *sub ? dir / sub : dir;
+        if (mkdir(p.c_str(), 0700) != 0 && errno != EEXIST) {
+            if (errno != ENOENT) return false;
+            std::error_code ec;
+            fs::create_directories(p, ec);
+            if (ec) return false;
+            chmod(p.c_str(), 0700);
+        }
+    }
+    struct stat st;
+    return lstat(dir.c_str(), &st) == 0 && S_ISDIR(st.st_mode) && st.st_uid == getuid() && st.st_dev == dev;
+}
+
+// info 文件：第一行删除时间，其余为原路径 (路径中可以包含换行)
+bool writeInfo(const Path& file, int64_t deletedAt, const Path& originalPath) {
+    int fd = open(file.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd < 0) return false;
+    std::string content = std::to_string(deletedAt) + "\n" + originalPath.string();
+    bool ok = write(fd, content.data(), content.size()) == static_cast<ssize_t>(content.size());
+    ok = close(fd) == 0 && ok;
+    if (!ok) unlink(file.c_str());
+    return ok;
+}
+
+bool readInfo(const Path& file, int64_t& outDeletedAt, Path& outOriginalPath) {
+    int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    std::string content;
+    char chunk[4096];
+    ssize_t n;
+    while ((n = read(fd, chunk, sizeof(chunk))) > 0) content.append(chunk, static_cast<size_t>(n));
+    close(fd);
+
+    size_t newline = content.find('\n');
+    if (newline == std::string::npos || newline + 1 == content.size()) return false;
+    outDeletedAt = std::strtoll(content.c_str(), nullptr, 10);
+    outOriginalPath = content.substr(newline + 1);
+    return true;
+}
+
+bool entryExists(const Path& path) {
+    struct stat st;
+    return lstat(path.c_str(), &st) == 0;
+}
+
+std::vector<std::string> listNames(const Path& dir) {
+    std::vector<std::string> names;
+    DIR* d = opendir(dir.c_str());
+    if (!d) return names;
+    while (struct dirent* ent = readdir(d)) {
+        const char* name = ent->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+        names.emplace_back(name);
+    }
+    closedir(d);
+    return names;
+}
+
+// 按固定速率放行删除操作，避免清理回收站时占满磁盘带宽
+class Pacer {
+public:
+    explicit Pacer(unsigned opsPerSecond) : interval(std::chrono::nanoseconds(1000000000 / opsPerSecond)) {}
+
+    void tick() {
+        if (++ops % kBatch != 0) return;
+        auto due = start + interval * ops;
+        auto now = std::chrono::steady_clock::now();
+        if (due > now) std::this_thread::sleep_for(due - now);
+    }
+
+private:
+    static constexpr uint64_t kBatch = 64;
+    std::chrono::nanoseconds interval;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint64_t ops = 0;
+};
+
+// 后序删除一棵树；stop 置位时中途返回，剩余部分留到下次
+bool removeTree(int parentFd, const char* name, Pacer& pacer, const std::atomic<bool>& stop) {
+    if (unlinkat(parentFd, name, 0) == 0) {
+        pacer.tick();
+        return true;
+    }
+    if (errno == ENOENT) return true;
+    if (errno != EISDIR && errno != EPERM) return false;
+
+    int fd = openat(parentFd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0 && errno == EACCES && fchmodat(parentFd, name, 0700, 0) == 0) {
+        fd = openat(parentFd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    }
+    if (fd < 0) return false;
+    fchmod(fd, 0700); // 只读目录中的子项也要能删除
+    DIR* dir = fdopendir(fd);
+    if (!dir) {
+        close(fd);
+        return false;
+    }
+
+    std::vector<std::string> children;
+    while (struct dirent* ent = readdir(dir)) {
+        const char* child = ent->d_name;
+        if (child[0] == '.' && (child[1] == '\0' || (child[1] == '.' && child[2] == '\0'))) continue;
+        children.emplace_back(child);
+    }
+    bool ok = true;
+    for (const std::string& child : children) {
+        if (stop.load(std::memory_order_relaxed)) {
+            ok = false;
+            break;
+        }
+        ok = removeTree(dirfd(dir), child.c_str(), pacer, stop) && ok;
+    }
+    closedir(dir);
+
+    if (!ok) return false;
+    bool removed = unlinkat(parentFd, name, AT_REMOVEDIR) == 0;
+    pacer.tick();
+    return removed;
+}
+
+} // namespace
+
+TrashManager::TrashManager() {
+    // 上次运行留在家目录回收站中的条目同样可以恢复，并由后台线程按期清除
+    if (const char* home = std::getenv("HOME")) {
+        Path homeTrash = Path(home) / ".local/share/mfe-trash";
+        struct stat st;
+        if (lstat(homeTrash.c_str(), &st) == 0 && S_ISDIR(st.st_mode) && st.st_uid == getuid()) {
+            trashDirs.emplace(st.st_dev, homeTrash);
+            purger = std::thread(&TrashManager::purgeLoop, this);
+        }
+    }
+}
+
+TrashManager::~TrashManager() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    if (purger.joinable()) purger.join();
+}
+
+std::vector<Path> TrashManager::trashDirsFor(const Path& target) {
+    std::vector<Path> candidates;
+    struct stat st;
+    if (lstat(target.parent_path().c_str(), &st) != 0) return candidates;
+    const dev_t dev = st.st_dev;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = trashDirs.find(dev);
+        if (it != trashDirs.end()) candidates.push_back(it->second);
+    }
+
+    // 家目录所在的文件系统使用家目录下的回收站
+    if (const char* home = std::getenv("HOME")) {
+        struct stat homeSt;
+        if (stat(home, &homeSt) == 0 && homeSt.st_dev == dev) {
+            candidates.push_back(Path(home) / ".local/share/mfe-trash");
+        }
+    }
+
+    // 其他文件系统使用挂载点下的回收站
+    Path mountRoot = target.parent_path();
+    while (mountRoot != mountRoot.root_path()) {
+        struct stat upSt;
+        if (stat(mountRoot.parent_path().c_str(), &upSt) != 0 || upSt.st_dev != dev) break;
+        mountRoot = mountRoot.parent_path();
+    }
+    candidates.push_back(mountRoot / (".mfe-trash-" + std::to_string(getuid())));
+
+    std::vector<Path> usable;
+    for (const Path& dir : candidates) {
+        if (std::find(usable.begin(), usable.end(), dir) == usable.end() && prepareTrashDir(dir, dev)) {
+            usable.push_back(dir);
+        }
+    }
+    return usable;
+}
+
+Status TrashManager::moveToTrash(const Path& target, TrashEntry& outEntry) {
+    std::vector<Path> dirs = trashDirsFor(target);
+    if (dirs.empty()) {
+        return Status::Error(StatusCode::PermissionDenied, "No usable trash directory on this file system", target);
+    }
+
+    int lastErr = 0;
+    for (const Path& dir : dirs) {
+        Path inside = target.lexically_relative(dir);
+        if (target == dir || (!inside.empty() && *inside.begin() != "..")) {
+            return Status::Error(StatusCode::InvalidArguments, "Cannot move the trash into itself", target);
+        }
+
+        // 持锁完成 info 写入和 rename，后台线程不会看到只有一半的条目
+        std::lock_guard<std::mutex> lock(mutex);
+        TrashEntry entry;
+        entry.deletedAt = unixNow();
+        entry.id = std::to_string(entry.deletedAt) + "." + std::to_string(getpid()) + "." + std::to_string(++counter);
+        entry.originalPath = target;
+        entry.trashDir = dir;
+
+        Path info = dir / "info" / entry.id;
+        if (!writeInfo(info, entry.deletedAt, target)) {
+            lastErr = errno;
+            continue;
+        }
+        if (rename(target.c_str(), (dir / "files" / entry.id).c_str()) != 0) {
+            lastErr = errno;
+            unlink(info.c_str());
+            if (lastErr == EXDEV) continue; // 同一设备号但跨挂载 (bind mount)，换下一个回收站
+            return Status::SystemError(StatusCode::PermissionDenied, "Cannot move to trash", target, lastErr);
+        }
+
+        struct stat st;
+        if (lstat(dir.c_str(), &st) == 0) trashDirs.emplace(st.st_dev, dir);
+        if (!purger.joinable()) purger = std::thread(&TrashManager::purgeLoop, this);
+        outEntry = std::move(entry);
+        return Status::Success();
+    }
+    return Status::SystemError(StatusCode::PermissionDenied, "Cannot move to trash", target, lastErr);
+}
+
+Status TrashManager::restore(const std::string& id, TrashEntry& outEntry) {
+    if (id.empty() || id.find('/') != std::string::npos || id == "." || id == "..") {
+        return Status::Error(StatusCode::InvalidArguments, "Invalid trash item", id);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& [dev, dir] : trashDirs) {
+        Path info = dir / "info" / id;
+        Path item = dir / "files" / id;
+        TrashEntry entry;
+        if (!entryExists(item) || !readInfo(info, entry.deletedAt, entry.originalPath)) continue;
+        entry.id = id;
+        entry.trashDir = dir;
+
+        std::error_code ec;
+        fs::create_directories(entry.originalPath.parent_path(), ec);
+        // 原位置已被占用时不覆盖
+        int rc = renameat2(AT_FDCWD, item.c_str(), AT_FDCWD, entry.originalPath.c_str(), RENAME_NOREPLACE);
+        if (rc != 0 && (errno == EINVAL || errno == ENOSYS)) {
+            rc = entryExists(entry.originalPath) ? (errno = EEXIST, -1) : rename(item.c_str(), entry.originalPath.c_str());
+        }
+        if (rc != 0) {
+            if (errno == EEXIST) {
+                return Status::Error(StatusCode::PathAlreadyExists, "Cannot restore, target already exists", std::move(entry.originalPath));
+            }
+            return Status::SystemError(StatusCode::MoveFailed, "Cannot restore", std::move(entry.originalPath), errno);
+        }
+        unlink(info.c_str());
+        outEntry = std::move(entry);
+        return Status::Success();
+    }
+    return Status::Error(StatusCode::PathNotFound, "No such item in trash (already purged?)", id);
+}
+
+void TrashManager::listDir(const Path& dir, std::vector<TrashEntry>& outEntries) const {
+    for (std::string& id : listNames(dir / "info")) {
+        TrashEntry entry;
+        if (!entryExists(dir / "files" / id) || !readInfo(dir / "info" / id, entry.deletedAt, entry.originalPath)) continue;
+        entry.id = std::move(id);
+        entry.trashDir = dir;
+        outEntries.push_back(std::move(entry));
+    }
+}
+
+void TrashManager::list(std::vector<TrashEntry>& outEntries) {
+    outEntries.clear();
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& [dev, dir] : trashDirs) listDir(dir, outEntries);
+    std::sort(outEntries.begin(), outEntries.end(), [](const TrashEntry& a, const TrashEntry& b) {
+        if (a.deletedAt != b.deletedAt) return a.deletedAt < b.deletedAt;
+        return a.id < b.id;
+    });
+}
+
+void TrashManager::purgeAll(uintmax_t& outCount) {
+    std::vector<TrashEntry> entries;
+    list(entries);
+    outCount = entries.size();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        purgeRequested = true;
+    }
+    wakeUp.notify_all();
+}
+
+void TrashManager::purgeLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        bool all = purgeRequested;
+        purgeRequested = false;
+        std::vector<Path> dirs;
+        for (const auto& [dev, dir] : trashDirs) dirs.push_back(dir);
+
+        lock.unlock();
+        for (const Path& dir : dirs) purgeDir(dir, all);
+        lock.lock();
+
+        wakeUp.wait_for(lock, kScanInterval, [&] { return stopping || purgeRequested; });
+    }
+}
+
+void TrashManager::purgeDir(const Path& dir, bool all) {
+    Pacer pacer(kPurgeOpsPerSecond);
+    const Path purging = dir / "purging";
+    int purgingFd = open(purging.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (purgingFd < 0) return;
+
+    // 挑选要清除的条目：持锁将其移入 purging，之后不可再恢复
+    const int64_t expireBefore = unixNow() - kRetentionSeconds;
+    std::vector<std::string> ids = listNames(dir / "info");
+    std::vector<std::string> files = listNames(dir / "files");
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const std::string& id : ids) {
+            int64_t deletedAt = 0;
+            Path originalPath;
+            Path info = dir / "info" / id;
+            bool valid = readInfo(info, deletedAt, originalPath) && entryExists(dir / "files" / id);
+            if (valid && !all && deletedAt > expireBefore) continue;
+            if (valid) rename((dir / "files" / id).c_str(), (purging / id).c_str());
+            unlink(info.c_str());
+        }
+        // 没有 info 的条目无法恢复，一并清除
+        for (const std::string& id : files) {
+            if (!entryExists(dir / "info" / id)) rename((dir / "files" / id).c_str(), (purging / id).c_str());
+        }
+    }
+
+    // 不持锁逐个删除，包括上次未删完的条目
+    for (const std::string& name : listNames(purging)) {
+        if (stopping.load(std::memory_order_relaxed)) break;
+        removeTree(purgingFd, name.c_str(), pacer, stopping);
+    }
+    close(purgingFd);
+}
@@ -0,0 +1,364 @@
+#include "TreeWalker.h"
+#include "IoThrottle.h"
+#include "Parallel.h"
+#include "AllocTracker.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+// 将 stat 的 st_mode 转换为 FileType
+FileType typeFromMode(mode_t mode) {
+    if (S_ISDIR(mode)) return FileType::Directory;
+    if (S_ISREG(mode)) return FileType::File;
+    if (S_ISLNK(mode)) return FileType::Symlink;
+    return FileType::Unknown;
+}
+
+// 打开目录，返回 DIR*，失败返回 nullptr 并保留 errno
+// 打开目录计为一次 I/O 操作，受 IoThrottle 限制
+// followLink 只用于遍历的根目录：与 recursive_directory_iterator 相同，根目录是指向目录的符号链接时跟随它；
+// 遍历中的子目录一律不跟随
+DIR* openDirAt(int parentFd, const char* name, bool followLink = false) {
+    IoThrottle& throttle = IoThrottle::instance();
+    IoThrottle::Slot slot(throttle);
+    throttle.acquire();
+    int fd = openat(parentFd, name, O_RDONLY | O_DIRECTORY | (followLink ? 0 : O_NOFOLLOW) | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+    DIR* dir = fdopendir(fd);
+    if (!dir) {
+        int err = errno;
+        close(fd);
+        errno = err;
+    }
+    return dir;
+}
+
+} // namespace
+
+const struct stat* WalkEntry::stat() {
+    if (!statDone) {
+        statDone = true;
+        IoThrottle& throttle = IoThrottle::instance();
+        IoThrottle::Slot slot(throttle);
+        throttle.acquire();
+        statOk = fstatat(dirFd, name.data(), &statBuf, AT_SYMLINK_NOFOLLOW) == 0;
+    }
+    return statOk ? &statBuf : nullptr;
+}
+
+Status TreeWalker::setOptions(const WalkOptions& options) {
+    rules = IgnoreRules();
+    for (const std::string& pattern : options.excludes) {
+        Status status = rules.add(pattern);
+        if (!status.ok()) return status;
+    }
+    gitignore = options.gitignore;
+    oneFileSystem = options.oneFileSystem;
+    return Status::Success();
+}
+
+int TreeWalker::walk(const Path& root, const Visitor& visit, const ErrorHandler& onError) {
+    // 遍历器自身的分配记入 Walker，回调中的分配仍记入调用方的分类
+    const AllocCategory callerCategory = AllocScope::current();
+    AllocScope walkerScope(AllocCategory::Walker);
+
+    struct Frame {
+        DIR* dir;
+        size_t pathLen;   // 该目录路径在缓冲区中的长度
+        int depth;
+        size_t ruleCount; // 进入该目录前的规则数，离开时撤销该目录的 .gitignore
+    };
+
+    std::string pathBuf = root.string();
+    DIR* rootDir = openDirAt(AT_FDCWD, pathBuf.c_str(), true);
+    if (!rootDir) return errno;
+
+    // 相对路径在缓冲区中的起始位置，供路径规则匹配
+    const size_t relStart = pathBuf.size() + (!pathBuf.empty() && pathBuf.back() == '/' ? 0 : 1);
+    const size_t baseRuleCount = rules.size();
+    const bool pruning = !rules.empty() || gitignore;
+
+    dev_t rootDev = 0;
+    if (oneFileSystem) {
+        struct stat st;
+        if (fstat(dirfd(rootDir), &st) == 0) rootDev = st.st_dev;
+    }
+    if (gitignore) rules.loadGitignore(dirfd(rootDir), 0);
+
+    std::vector<Frame> stack;
+    stack.push_back({rootDir, pathBuf.size(), 0, baseRuleCount});
+    bool stopped = false;
+
+    while (!stack.empty() && !stopped) {
+        Frame& frame = stack.back();
+        errno = 0;
+        struct dirent* ent = readdir(frame.dir);
+        if (!ent) {
+            closedir(frame.dir);
+            rules.truncate(frame.ruleCount);
+            stack.pop_back();
+            continue;
+        }
+
+        const char* name = ent->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+            continue;
+        }
+
+        // 复用路径缓冲区：截断到当前目录后追加文件名
+        pathBuf.resize(frame.pathLen);
+        if (pathBuf.empty() || pathBuf.back() != '/') pathBuf.push_back('/');
+        size_t nameOffset = pathBuf.size();
+        pathBuf.append(name);
+
+        WalkEntry entry;
+        entry.path = pathBuf;
+        entry.name = std::string_view(pathBuf).substr(nameOffset);
+        entry.inode = ent->d_ino;
+        entry.depth = frame.depth;
+        entry.dirFd = dirfd(frame.dir);
+
+        switch (ent->d_type) {
+            case DT_DIR: entry.type = FileType::Directory; break;
+            case DT_REG: entry.type = FileType::File; break;
+            case DT_LNK: entry.type = FileType::Symlink; break;
+            case DT_UNKNOWN: {
+                // 部分文件系统不提供 d_type，此时才 lstat
+                const struct stat* st = entry.stat();
+                entry.type = st ? typeFromMode(st->st_mode) : FileType::Unknown;
+                break;
+            }
+            default: entry.type = FileType::Unknown; break;
+        }
+
+        // 剪枝：被排除的条目不回调，被排除的目录不进入
+        if (pruning) {
+            bool isDir = entry.type == FileType::Directory;
+            if (gitignore && isDir && entry.name == ".git") continue;
+            if (rules.ignored(std::string_view(pathBuf).substr(relStart), entry.name, isDir)) continue;
+        }
+
+        WalkAction action;
+        {
+            AllocScope visitScope(callerCategory);
+            action = visit(entry);
+        }
+        if (action == WalkAction::Stop) {
+            stopped = true;
+            break;
+        }
+        if (entry.type != FileType::Directory || action == WalkAction::Skip) {
+            continue;
+        }
+
+        // 挂载点本身照常回调，但不进入其他文件系统
+        if (oneFileSystem) {
+            const struct stat* st = entry.stat();
+            if (!st || st->st_dev != rootDev) continue;
+        }
+
+        DIR* child = openDirAt(entry.dirFd, name);
+        if (!child) {
+            if (onError) onError(entry.path, errno);
+            continue;
+        }
+        int childDepth = frame.depth + 1;
+        size_t ruleCount = rules.size();
+        if (gitignore) rules.loadGitignore(dirfd(child), pathBuf.size() - relStart);
+        stack.push_back({child, pathBuf.size(), childDepth, ruleCount});
+    }
+
+    for (Frame& frame : stack) {
+        closedir(frame.dir);
+    }
+    rules.truncate(baseRuleCount);
+    return 0;
+}
+
+void listTree(const Path& root, TreeListing& out) {
+    const size_t rootLen = root.string().size();
+    TreeWalker walker;
+    out.err = walker.walk(root, [&](WalkEntry& entry) {
+        const struct stat* st = entry.stat();
+        if (!st) return WalkAction::Continue;
+        std::string_view rel = entry.path.substr(rootLen);
+        if (!rel.empty() && rel.front() == '/') rel.remove_prefix(1);
+
+        out.entries.push_back({out.pool.size(), static_cast<uint32_t>(rel.size()), entry.type,
+                               static_cast<uint64_t>(st->st_size), static_cast<int64_t>(st->st_mtim.tv_sec)});
+        out.pool.append(rel);
+        return WalkAction::Continue;
+    });
+    std::sort(out.entries.begin(), out.entries.end(),
+        [&](const TreeListing::Entry& a, const TreeListing::Entry& b) { return out.path(a) < out.path(b); });
+}
+
+ParallelWalker::ParallelWalker(unsigned threads) : threads(threads == 0 ? defaultThreadCount() : threads) {}
+
+Status ParallelWalker::setOptions(const WalkOptions& options) {
+    auto excludes = std::make_shared<IgnoreRules>();
+    for (const std::string& pattern : options.excludes) {
+        Status status = excludes->add(pattern);
+        if (!status.ok()) return status;
+    }
+    rules = excludes->empty() ? nullptr : std::move(excludes);
+    gitignore = options.gitignore;
+    oneFileSystem = options.oneFileSystem;
+    return Status::Success();
+}
+
+int ParallelWalker::walk(const Path& root, const Visitor& visit, const ErrorHandler& onError) {
+    const AllocCategory callerCategory = AllocScope::current();
+    AllocScope walkerScope(AllocCategory::Walker);
+
+    // 待读取的目录，规则集在目录之间共享，只有带 .gitignore 的目录才生成新的规则集
+    struct DirJob {
+        std::string path;
+        int depth;
+        std::shared_ptr<const IgnoreRules> rules;
+    };
+
+    const std::string rootPath = root.string();
+    DIR* rootDir = openDirAt(AT_FDCWD, rootPath.c_str(), true);
+    if (!rootDir) return errno;
+    const size_t relStart = rootPath.size() + (!rootPath.empty() && rootPath.back() == '/' ? 0 : 1);
+
+    dev_t rootDev = 0;
+    if (oneFileSystem) {
+        struct stat st;
+        if (fstat(dirfd(rootDir), &st) == 0) rootDev = st.st_dev;
+    }
+
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::vector<DirJob> queue;  // 后进先出，接近深度优先，队列长度与树宽而非树的规模相关
+    size_t pending = 1;         // 已入队或正在读取的目录数，为 0 时遍历结束
+    std::atomic<bool> stopped{false};
+
+    // 读取一个目录，dir 为已打开的目录
+    auto readDir = [&](DIR* dir, const DirJob& job, unsigned worker, std::string& pathBuf, std::vector<DirJob>& children) {
+        std::shared_ptr<const IgnoreRules> dirRules = job.rules;
+        if (gitignore) {
+            IgnoreRules local;
+            local.loadGitignore(dirfd(dir), job.path.size() >= relStart ? job.path.size() - relStart : 0);
+            if (!local.empty()) {
+                auto merged = std::make_shared<IgnoreRules>(dirRules ? *dirRules : IgnoreRules());
+                merged->append(local);
+                dirRules = std::move(merged);
+            }
+        }
+
+        while (!stopped.load(std::memory_order_relaxed)) {
+            struct dirent* ent = readdir(dir);
+            if (!ent) break;
+            const char* name = ent->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+
+            pathBuf.assign(job.path);
+            if (pathBuf.empty() || pathBuf.back() != '/') pathBuf.push_back('/');
+            size_t nameOffset = pathBuf.size();
+            pathBuf.append(name);
+
+            WalkEntry entry;
+            entry.path = pathBuf;
+            entry.name = std::string_view(pathBuf).substr(nameOffset);
+            entry.inode = ent->d_ino;
+            entry.depth = job.depth;
+            entry.dirFd = dirfd(dir);
+            switch (ent->d_type) {
+                case DT_DIR: entry.type = FileType::Directory; break;
+                case DT_REG: entry.type = FileType::File; break;
+                case DT_LNK: entry.type = FileType::Symlink; break;
+                case DT_UNKNOWN: {
+                    const struct stat* st = entry.stat();
+                    entry.type = st ? typeFromMode(st->st_mode) : FileType::Unknown;
+                    break;
+                }
+                default: entry.type = FileType::Unknown; break;
+            }
+
+            bool isDir = entry.type == FileType::Directory;
+            if (gitignore && isDir && entry.name == ".git") continue;
+            if (dirRules && dirRules->ignored(std::string_view(pathBuf).substr(relStart), entry.name, isDir)) continue;
+
+            WalkAction action;
+            {
+                AllocScope visitScope(callerCategory);
+                action = visit(entry, worker);
+            }
+            if (action == WalkAction::Stop) {
+                stopped.store(true, std::memory_order_relaxed);
+                break;
+            }
+            if (!isDir || action == WalkAction::Skip) continue;
+            if (oneFileSystem) {
+                const struct stat* st = entry.stat();
+                if (!st || st->st_dev != rootDev) continue;
+            }
+            children.push_back({pathBuf, job.depth + 1, dirRules});
+        }
+    };
+
+    auto worker = [&](unsigned workerId) {
+        AllocScope workerScope(AllocCategory::Walker);
+        std::string pathBuf;
+        std::vector<DirJob> children;
+        while (true) {
+            DirJob job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeUp.wait(lock, [&] { return !queue.empty() || pending == 0; });
+                if (queue.empty()) return;
+                job = std::move(queue.back());
+                queue.pop_back();
+            }
+
+            children.clear();
+            if (!stopped.load(std::memory_order_relaxed)) {
+                DIR* dir = openDirAt(AT_FDCWD, job.path.c_str());
+                if (dir) {
+                    readDir(dir, job, workerId, pathBuf, children);
+                    closedir(dir);
+                } else if (onError) {
+                    onError(job.path, errno);
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            pending += children.size();
+            --pending;
+            for (auto& child : children) queue.push_back(std::move(child));
+            if (pending == 0 || children.size() > 1) wakeUp.notify_all();
+            else if (!children.empty()) wakeUp.notify_one();
+        }
+    };
+
+    // 根目录由调用线程读取，其余目录交给工作线程
+    {
+        std::string pathBuf;
+        std::vector<DirJob> children;
+        DirJob rootJob{rootPath, 0, rules};
+        readDir(rootDir, rootJob, 0, pathBuf, children);
+        closedir(rootDir);
+        pending = children.size();
+        queue = std::move(children);
+    }
+    if (pending == 0) return 0;
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker, t);
+    worker(0);
+    for (auto& th : pool) th.join();
+    return 0;
+}
@@ -0,0 +1,192 @@
+#include "FileManager.h"
+#include "AllocTracker.h"
+#include "TreeWalker.h"
+#include "Parallel.h"
+#include "WorkQueue.h"
+#include "ByteCount.h"
+#include <algorithm>
+#include <cerrno>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+// 文件通过 pread 分窗口读取而不映射：统计期间文件可能被其他进程截断，
+// 访问映射区域越过文件末尾会触发 SIGBUS；截断后只统计实际读到的字节
+
+namespace {
+
+constexpr size_t kChunkSize = size_t(16) << 20;         // 大文件切块的大小
+constexpr size_t kParallelFileSize = size_t(64) << 20;  // 超过此大小的文件切块并行统计
+constexpr size_t kWindowSize = size_t(1) << 20;         // 每次 pread 的字节数
+
+// 只读打开的普通文件
+struct InputFile {
+    int fd = -1;
+    uintmax_t size = 0;
+
+    ~InputFile() { if (fd >= 0) ::close(fd); }
+
+    // 返回 0，不是普通文件时返回 EINVAL，其他失败返回 errno
+    int open(const std::string& path) {
+        fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return errno;
+        struct stat st;
+        if (fstat(fd, &st) != 0) return errno;
+        if (!S_ISREG(st.st_mode)) return EINVAL;
+        size = static_cast<uintmax_t>(st.st_size);
+        return 0;
+    }
+};
+
+// 统计 [begin, begin + len)，返回实际读到的字节数
+// [In] buffer: 读取窗口，由调用者复用
+uintmax_t countRange(int fd, uintmax_t begin, uintmax_t len, bool prevSpace,
+                     std::vector<uint8_t>& buffer, TextCounter& counter) {
+    buffer.resize(kWindowSize);
+    uintmax_t done = 0;
+    while (done < len) {
+        size_t want = static_cast<size_t>(std::min<uintmax_t>(kWindowSize, len - done));
+        ssize_t n = pread(fd, buffer.data(), want, static_cast<off_t>(begin + done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break; // 出错或文件已被截断
+        counter.count(buffer.data(), static_cast<size_t>(n), prevSpace);
+        prevSpace = TextCounter::isSpace(buffer[static_cast<size_t>(n) - 1]);
+        done += static_cast<uintmax_t>(n);
+    }
+    return done;
+}
+
+// 统计整个文件，chunked 为 true 时切块并行
+void countFile(const InputFile& file, bool chunked, std::vector<uint8_t>& buffer, WordCount& outCount) {
+    const uintmax_t size = file.size;
+    if (size == 0) return;
+
+    if (!chunked) {
+        posix_fadvise(file.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        TextCounter counter;
+        outCount.bytes = countRange(file.fd, 0, size, true, buffer, counter);
+        outCount.lines = counter.lines;
+        outCount.words = counter.words;
+        return;
+    }
+
+    // 每块只依赖前一块的最后一个字节是否为空白，各块可独立统计
+    posix_fadvise(file.fd, 0, 0, POSIX_FADV_WILLNEED);
+    const size_t chunks = static_cast<size_t>((size + kChunkSize - 1) / kChunkSize);
+    std::vector<TextCounter> counters(chunks);
+    std::vector<uintmax_t> bytes(chunks);
+    parallelFor(chunks, [&](size_t index, unsigned) {
+        uintmax_t begin = static_cast<uintmax_t>(index) * kChunkSize;
+        uintmax_t len = std::min<uintmax_t>(kChunkSize, size - begin);
+        bool prevSpace = true;
+        if (begin > 0) {
+            uint8_t prev = 0;
+            if (pread(file.fd, &prev, 1, static_cast<off_t>(begin - 1)) != 1) return;
+            prevSpace = TextCounter::isSpace(prev);
+        }
+        std::vector<uint8_t> window;
+        bytes[index] = countRange(file.fd, begin, len, prevSpace, window, counters[index]);
+    });
+    for (size_t i = 0; i < chunks; ++i) {
+        outCount.lines += counters[i].lines;
+        outCount.words += counters[i].words;
+        outCount.bytes += bytes[i];
+    }
+}
+
+} // namespace
+
+Status FileManager::wordCount(const Path& targetPath, std::vector<WordCount>& outFiles, WordCount& outTotal) const {
+    AllocScope resultScope(AllocCategory::Results);
+    outFiles.clear();
+    outTotal = WordCount();
+    fs::path target = resolvePath(targetPath);
+    std::error_code ec;
+    if (!fs::exists(target, ec)) {
+        return Status::Error(StatusCode::PathNotFound, "Target not found", std::move(target));
+    }
+
+    if (!fs::is_directory(target, ec)) {
+        InputFile file;
+        int err = file.open(target.string());
+        if (err == EINVAL) return Status::Error(StatusCode::NotAFile, "Not a regular file", std::move(target));
+        if (err != 0) return Status::SystemError(StatusCode::PermissionDenied, "Cannot read file", std::move(target), err);
+
+        WordCount count;
+        count.path = target.string();
+        std::vector<uint8_t> buffer;
+        countFile(file, file.size > kParallelFileSize, buffer, count);
+        outTotal.lines = count.lines;
+        outTotal.words = count.words;
+        outTotal.bytes = count.bytes;
+        outFiles.push_back(std::move(count));
+        return Status::Success();
+    }
+
+    // 遍历线程产生文件路径，工作线程各自统计整个文件
+    // 大文件留到遍历结束后切块并行统计，避免一个线程拖住整体
+    std::mutex resultMutex;
+    std::vector<std::string> largeFiles;
+    WorkQueue<std::string> queue;
+    unsigned threads = defaultThreadCount();
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            std::vector<WordCount> local;
+            std::vector<uint8_t> buffer;
+            while (auto path = queue.pop()) {
+                InputFile file;
+                if (file.open(*path) != 0) continue;
+                if (file.size > kParallelFileSize) {
+                    std::lock_guard<std::mutex> lock(resultMutex);
+                    largeFiles.push_back(std::move(*path));
+                    continue;
+                }
+                WordCount count;
+                count.path = std::move(*path);
+                countFile(file, false, buffer, count);
+                local.push_back(std::move(count));
+            }
+            std::lock_guard<std::mutex> lock(resultMutex);
+            std::move(local.begin(), local.end(), std::back_inserter(outFiles));
+        });
+    }
+
+    TreeWalker walker;
+    int err = walker.walk(target, [&](WalkEntry& entry) {
+        if (entry.type == FileType::File) {
+            queue.push(std::string(entry.path));
+        }
+        return WalkAction::Continue;
+    });
+    queue.close();
+    for (auto& worker : workers) worker.join();
+
+    if (err != 0) {
+        outFiles.clear();
+        return Status::SystemError(StatusCode::PermissionDenied, "Cannot open directory", std::move(target), err);
+    }
+
+    std::vector<uint8_t> buffer;
+    for (auto& path : largeFiles) {
+        InputFile file;
+        if (file.open(path) != 0) continue;
+        WordCount count;
+        count.path = std::move(path);
+        countFile(file, true, buffer, count);
+        outFiles.push_back(std::move(count));
+    }
+
+    std::sort(outFiles.begin(), outFiles.end(),
+              [](const WordCount& a, const WordCount& b) { return a.path < b.path; });
+    for (const auto& count : outFiles) {
+        outTotal.lines += count.lines;
+        outTotal.words += count.words;
+        outTotal.bytes += count.bytes;
+    }
+    return Status::Success();
+}
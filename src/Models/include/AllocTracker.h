@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 堆分配统计 (memstats 命令)
+// 以 -DMFE_ALLOC_TRACKING=ON 构建时替换全局 operator new / delete，按线程当前的子系统分类计数；
+// 默认构建中 AllocScope 为空类，统计接口返回全 0，没有任何运行时开销
+// 统计是进程范围的：服务模式下多个会话同时执行命令时，各命令的数字会相互包含
+
+// 分配所属的子系统，由 AllocScope 在线程上设置
+enum class AllocCategory : uint8_t {
+    Other,     // 未标记 (启动、后台线程等)
+    Walker,    // 目录遍历器内部 (目录句柄、路径缓冲区、任务队列)
+    Results,   // 命令在 FileManager 中构建的结果
+    Rendering, // 命令解析与输出 (表格、格式化)
+    Count
+};
+
+constexpr size_t kAllocCategoryCount = static_cast<size_t>(AllocCategory::Count);
+
+struct AllocCounters {
+    uint64_t count = 0; // 分配次数
+    uint64_t bytes = 0; // 累计分配的字节数 (含分配器的对齐开销)
+};
+
+// 某一时刻的统计，两次快照相减得到一段时间内的分配量
+struct AllocSnapshot {
+    AllocCounters total;
+    AllocCounters byCategory[kAllocCategoryCount];
+    int64_t live = 0; // 当前存活的字节数
+    int64_t peak = 0; // 上次 resetPeak() 以来存活字节数的峰值
+};
+
+class AllocTracker {
+public:
+    // 是否以 MFE_ALLOC_TRACKING 构建
+    static constexpr bool enabled() {
+#ifdef MFE_ALLOC_TRACKING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static AllocSnapshot snapshot();
+
+    // 将峰值重置为当前存活字节数，用于统计单个命令的峰值
+    static void resetPeak();
+
+    static const char* categoryName(AllocCategory category);
+};
+
+// 在作用域内把当前线程的分配记入 category，离开时恢复之前的分类
+#ifdef MFE_ALLOC_TRACKING
+class AllocScope {
+public:
+    explicit AllocScope(AllocCategory category);
+    ~AllocScope();
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+    // 当前线程的分类，跨线程传递分类时使用
+    static AllocCategory current();
+
+private:
+    AllocCategory previous;
+};
+#else
+class AllocScope {
+public:
+    explicit AllocScope(AllocCategory) {}
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+    static AllocCategory current() { return AllocCategory::Other; }
+};
+#endif
@@ -1,10 +1,13 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cstdint>
 #include <chrono>
 #include <filesystem>
+#include <optional>
+#include "status.h"
 
 using Path = std::filesystem::path;
 
@@ -12,6 +15,7 @@ using Path = std::filesystem::path;
 enum class FileType {
     File,
     Directory,
+    Symlink,
     Unknown
 };
 
@@ -22,14 +26,235 @@ enum class SortMode {
     ByTime
 };
 
+// 文件名匹配方式
+enum class MatchMode {
+    Substring, // 不区分大小写的子串匹配
+    Glob,      // 通配符 (*.log)，整名匹配
+    Regex      // 正则表达式，未用 ^ / $ 锚定时为部分匹配
+};
+
+// 遍历时的剪枝选项 (--exclude / --gitignore / --one-file-system)
+// 被排除的目录在进入之前就被跳过
+struct WalkOptions {
+    std::vector<std::string> excludes; // 排除规则，gitignore 语法，相对遍历根目录
+    bool gitignore = false;            // 读取各级目录的 .gitignore，并跳过 .git 目录
+    bool oneFileSystem = false;        // 不进入挂载在其他文件系统上的目录
+
+    bool operator==(const WalkOptions& other) const = default;
+};
+
+// 搜索条件
+// 过滤条件在遍历中求值：类型只看 d_type，大小 / 时间仅对名称已匹配的条目 stat
+struct SearchOptions {
+    std::string pattern;                    // 模式串，为空时匹配所有名称
+    MatchMode mode = MatchMode::Substring;  // 匹配方式
+    std::optional<FileType> type;           // 类型过滤
+    std::optional<uintmax_t> minSize;       // 最小大小 (字节)，目录不参与大小过滤
+    std::optional<uintmax_t> maxSize;       // 最大大小 (字节)
+    std::optional<std::filesystem::file_time_type> modifiedBefore; // 修改时间早于
+    std::optional<std::filesystem::file_time_type> modifiedAfter;  // 修改时间晚于
+    WalkOptions walk;                       // 剪枝选项
+
+    // 是否需要 stat 才能判断
+    bool needsStat() const { return minSize || maxSize || modifiedBefore || modifiedAfter; }
+    // 是否带有任何过滤条件
+    bool hasFilters() const { return type || needsStat(); }
+};
+
+// top 命令的条件
+struct TopOptions {
+    size_t count = 10;               // 结果数
+    SortMode by = SortMode::BySize;  // BySize 取最大的文件，ByTime 取修改时间最早的文件
+    WalkOptions walk;                // 剪枝选项
+};
+
+// 回收站中的一项 (rm / undo / trash 命令)
+struct TrashEntry {
+    std::string id;        // 回收站内的唯一名称
+    Path originalPath;     // 删除前的绝对路径
+    Path trashDir;         // 所在的回收站目录
+    int64_t deletedAt = 0; // 删除时间 (Unix 秒)
+};
+
+// listFiles 需要获取的元数据 (ls 的列)，按位组合
+// 名称总会获取；类型和 inode 来自目录项本身，其余字段需要 stat
+enum FileField : uint32_t {
+    FieldType         = 1u << 0,
+    FieldSize         = 1u << 1,
+    FieldModifyTime   = 1u << 2,
+    FieldOwner        = 1u << 3, // uid / gid
+    FieldMode         = 1u << 4, // 权限位
+    FieldInode        = 1u << 5,
+    FieldBlocks       = 1u << 6, // 实际占用的 512 字节块数
+    FieldDirTotalSize = 1u << 7, // 目录递归总大小，代价高，按大小排序时自动包含
+};
+
 // 单个文件或文件夹的详细信息
 struct FileInfo {
     std::string name;                           // 文件名
     Path path;                                  // 绝对路径
     FileType type;                              // 类型
-    uintmax_t size;                             // 大小 (字节)，未统计为 0
-    uintmax_t dirTotalSize;                     // 目录总大小 (字节)
+    uintmax_t size = 0;                         // 大小 (字节)，未统计为 0
+    uintmax_t dirTotalSize = 0;                 // 目录总大小 (字节)
     std::filesystem::file_time_type modifyTime; // 修改时间
     std::filesystem::file_time_type createTime; // 创建时间
     std::filesystem::file_time_type accessTime; // 访问时间
+    uint32_t uid = 0;                           // 所有者
+    uint32_t gid = 0;                           // 所属组
+    uint32_t mode = 0;                          // 类型与权限位 (st_mode)
+    uint64_t inode = 0;                         // inode 号
+    uint64_t blocks = 0;                        // 占用的 512 字节块数
+};
+
+// 目录占用树中的单个目录 (du --tree)
+struct DiskUsageEntry {
+    std::string name;     // 目录名
+    Path path;            // 绝对路径
+    uintmax_t totalSize;  // 含所有子孙的文件总大小 (字节)
+    uintmax_t fileCount;  // 子孙文件总数
+};
+
+// 一组内容完全相同的文件 (dupes 命令)
+struct DuplicateGroup {
+    uintmax_t size;          // 单个文件大小 (字节)
+    std::vector<Path> paths; // 内容相同的文件路径，硬链接只保留一个
+};
+
+// 内容搜索的单条命中 (grep 命令)，仅在回调期间有效
+struct GrepMatch {
+    std::string_view path;  // 文件路径
+    uintmax_t lineNumber;   // 行号，从 1 开始
+    std::string_view line;  // 命中行内容 (不含换行符)
+};
+
+// 行数 / 单词数 / 字节数统计 (wc 命令)
+struct WordCount {
+    std::string path;   // 文件路径，合计时为空
+    uintmax_t lines = 0;
+    uintmax_t words = 0;
+    uintmax_t bytes = 0;
+};
+
+// 批量重命名的条件 (rename 命令)
+struct RenameOptions {
+    std::string pattern;     // 默认为 glob，* ? [...] 依次编号为捕获组 #1 #2 ...
+    std::string replacement; // 新名称，#N 引用捕获组 (#0 为整个名称)，## 表示字符 #
+    bool regex = false;      // pattern 为正则表达式 (须匹配整个名称)
+    bool dryRun = false;     // 只生成计划，不执行
+};
+
+// 批量重命名的一项
+struct RenameItem {
+    std::string from;
+    std::string to;
+};
+
+// 直方图的一项 (analyze 命令)
+struct HistogramBucket {
+    std::string label;   // 扩展名或区间，如 ".log"、"1K-4K"、"7-30d"
+    uintmax_t files = 0; // 文件数
+    uintmax_t bytes = 0; // 字节数 (文件大小之和)
+};
+
+// 目录树按类别的统计 (analyze 命令)，只统计普通文件
+struct TreeAnalysis {
+    std::vector<HistogramBucket> byExtension; // 按扩展名 (小写)，按字节数降序
+    std::vector<HistogramBucket> bySize;      // 按大小区间 (每档 4 倍)，从小到大，只含非空的区间
+    std::vector<HistogramBucket> byAge;       // 按修改时间距今的区间，从新到旧，只含非空的区间
+    uintmax_t files = 0;
+    uintmax_t dirs = 0;
+    uintmax_t bytes = 0;
+};
+
+// 文件在页缓存中的驻留情况 (cache 命令)
+struct CacheResidency {
+    std::string path;            // 文件路径，合计时为目标路径
+    uintmax_t files = 0;         // 文件数，单个文件为 1
+    uintmax_t bytes = 0;         // 文件大小之和
+    uintmax_t pages = 0;         // 总页数
+    uintmax_t residentPages = 0; // 在页缓存中的页数
+};
+
+// 对页缓存的操作 (cache warm / cache drop)
+enum class CacheAction {
+    Warm, // 预读进页缓存
+    Drop  // 从页缓存中丢弃 (只能丢弃干净页)
+};
+
+// 两个文件 / 目录树之间的差异类型 (cmp 命令)
+enum class DifferenceKind {
+    OnlyInFirst,    // 只存在于第一个目录树
+    OnlyInSecond,   // 只存在于第二个目录树
+    TypeDiffers,    // 类型不同 (文件 / 目录 / 符号链接)
+    SizeDiffers,    // 大小不同，未比较内容
+    ContentDiffers, // 大小相同但内容不同；符号链接为指向不同
+    Unreadable      // 无法读取，未能比较
+};
+
+struct FileDifference {
+    DifferenceKind kind;
+    std::string path;        // 相对路径，比较两个文件时为空
+    uintmax_t firstSize = 0;
+    uintmax_t secondSize = 0;
+    uintmax_t offset = 0;    // ContentDiffers 时第一个不同字节的偏移
+};
+
+// 快照差异类型
+enum class ChangeKind {
+    Added,
+    Removed,
+    Modified,
+    Moved
+};
+
+// 两个快照之间的单条差异 (snapshot diff)
+struct SnapshotChange {
+    ChangeKind kind;
+    std::string path;     // 相对路径，移动时为旧路径
+    std::string newPath;  // 移动后的新路径
+    FileType type;
+    uintmax_t oldSize;
+    uintmax_t newSize;
+};
+
+// I/O 限制 (throttle 命令)，作用于遍历、复制等重负载操作，0 表示不限制
+struct IoLimits {
+    uint64_t bytesPerSecond = 0; // 数据量速率 (字节 / 秒)
+    uint64_t opsPerSecond = 0;   // 每秒 I/O 操作数 (打开目录、stat、读写块)
+    unsigned maxInFlight = 0;    // 同时进行的 I/O 操作数上限
+    bool idlePriority = false;   // 使用 idle 类 I/O 优先级，磁盘空闲时才被调度
+};
+
+// 增量同步选项 (sync 命令)
+struct SyncOptions {
+    bool checksum = false;      // 大小和修改时间相同时再逐字节比较内容
+    bool deleteExtras = false;  // 删除目标中源里不存在的条目
+    bool dryRun = false;        // 只列出将执行的操作
+};
+
+// 增量同步结果
+struct SyncReport {
+    uintmax_t filesCopied = 0;
+    uintmax_t bytesCopied = 0;
+    uintmax_t filesUnchanged = 0;
+    uintmax_t dirsCreated = 0;
+    uintmax_t entriesDeleted = 0;
+    EntryErrors errors;                      // 单个条目失败不会中断同步
+    std::vector<std::string> plannedActions; // dryRun 时的操作列表
+};
+
+// 打包 / 解包结果 (pack / unpack 命令)
+struct ArchiveReport {
+    uintmax_t entries = 0;            // 写入或解出的条目数
+    uintmax_t bytes = 0;              // 文件数据字节数
+    EntryErrors errors;               // 被跳过的条目
+};
+
+// 文件的一页文本 (view 命令)
+struct TextPage {
+    uintmax_t offset = 0;     // 本页起始字节偏移
+    uintmax_t nextOffset = 0; // 下一页的起始偏移，等于 fileSize 时已到末尾
+    uintmax_t fileSize = 0;   // 读取时的文件大小
+    size_t lines = 0;         // 本页行数
+    std::string text;         // 本页内容，过长的行会被截断，剩余部分留给下一页
 };
@@ -1,5 +1,9 @@
 #pragma once//预处理指令，用于防止头文件被重复包含
+#include <expected>
+#include <filesystem>
 #include <string>
+#include <string_view>
+#include <vector>
 
 enum class StatusCode//show the error information
 {
@@ -21,15 +25,62 @@ enum class StatusCode//show the error information
     MoveFailed//移动失败
 };
 
+// 操作结果
+// 构造时不拼接字符串：说明文字为静态字符串，出错的路径以移动方式挂在结果上，
+// 系统错误只保存 errno，完整信息在 message() 被调用时才格式化
 struct Status
 {
-    StatusCode code;     // 状态码
-    std::string message; // 错误信息
+    StatusCode code;                    // 状态码
+    const char* what;                   // 静态说明文字，可为 nullptr
+    int sysError;                       // 系统错误码 (errno)，0 表示无
+    std::filesystem::path context;      // 出错的路径或输入，可为空
 
-    Status(StatusCode c = StatusCode::Success, std::string msg = "");
+    Status(StatusCode c = StatusCode::Success, const char* what = nullptr,
+           std::filesystem::path context = {}, int sysError = 0);
 
     bool ok() const;
 
-    static Status Success(std::string msg = "");
-    static Status Error(StatusCode c, const std::string &msg);
+    // 格式化为 "<说明>: <上下文> (<系统错误>)"
+    std::string message() const;
+
+    static Status Success(const char* msg = nullptr);
+    static Status Error(StatusCode c, const char* what, std::filesystem::path context = {});
+    static Status SystemError(StatusCode c, const char* what, std::filesystem::path context, int err);
+
+    // 打开路径失败时的 errno 对应的状态码：ENOENT、ENOTDIR 各有对应，其余视为权限不足
+    static StatusCode codeFromErrno(int err);
+};
+
+// 批量操作中各条目的错误 (sync / pack / unpack)
+// 不为每个失败的条目构造 Status：每条只记录状态码、静态说明、errno 和路径在共享字符串池中的位置，
+// 池按倍数增长，记录一条错误通常不分配内存；文字在 message() 被调用时才格式化
+class EntryErrors
+{
+public:
+    struct Entry
+    {
+        StatusCode code;
+        const char* what;   // 静态说明文字
+        int sysError;       // 系统错误码 (errno)，0 表示无
+        size_t pathOffset;  // 路径在池中的位置
+        size_t pathLen;
+    };
+
+    void add(StatusCode code, const char* what, std::string_view path, int sysError = 0);
+
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    const Entry& operator[](size_t index) const { return entries[index]; }
+    std::string_view path(size_t index) const;
+
+    // 格式与 Status::message() 相同
+    std::string message(size_t index) const;
+
+private:
+    std::vector<Entry> entries;
+    std::string paths;
 };
+
+// 带返回值的结果：成功时为 T，失败时为 Status
+template <typename T>
+using Result = std::expected<T, Status>;
@@ -0,0 +1,161 @@
+#include "AllocTracker.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <malloc.h>
+
+const char* AllocTracker::categoryName(AllocCategory category) {
+    switch (category) {
+        case AllocCategory::Walker: return "walker";
+        case AllocCategory::Results: return "results";
+        case AllocCategory::Rendering: return "rendering";
+        default: return "other";
+    }
+}
+
+#ifndef MFE_ALLOC_TRACKING
+
+AllocSnapshot AllocTracker::snapshot() {
+    return AllocSnapshot();
+}
+
+void AllocTracker::resetPeak() {}
+
+#else
+
+namespace {
+
+// 计数按线程分散到多个条带，避免所有线程的每次分配争用同一缓存行
+// 存活字节数需要全局一致才能求峰值，只有它是单个原子变量
+constexpr size_t kStripes = 16;
+
+struct alignas(64) Stripe {
+    std::atomic<uint64_t> count[kAllocCategoryCount];
+    std::atomic<uint64_t> bytes[kAllocCategoryCount];
+};
+
+// 以下变量均为常量初始化，静态初始化之前的分配也能安全计数
+Stripe stripes[kStripes];
+alignas(64) std::atomic<int64_t> liveBytes{0};
+alignas(64) std::atomic<int64_t> peakBytes{0};
+std::atomic<size_t> nextStripe{0};
+
+thread_local AllocCategory currentCategory = AllocCategory::Other;
+thread_local size_t stripeIndex = kStripes; // 首次分配时分配条带
+
+Stripe& threadStripe() {
+    if (stripeIndex == kStripes) stripeIndex = nextStripe.fetch_add(1, std::memory_order_relaxed) % kStripes;
+    return stripes[stripeIndex];
+}
+
+// 按分配器实际给出的大小计数，释放时无需知道申请的大小
+void recordAlloc(void* ptr) {
+    int64_t size = static_cast<int64_t>(malloc_usable_size(ptr));
+    Stripe& stripe = threadStripe();
+    size_t category = static_cast<size_t>(currentCategory);
+    stripe.count[category].fetch_add(1, std::memory_order_relaxed);
+    stripe.bytes[category].fetch_add(static_cast<uint64_t>(size), std::memory_order_relaxed);
+    int64_t live = liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    int64_t peak = peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+}
+
+void release(void* ptr) noexcept {
+    if (!ptr) return;
+    liveBytes.fetch_sub(static_cast<int64_t>(malloc_usable_size(ptr)), std::memory_order_relaxed);
+    std::free(ptr);
+}
+
+void* allocate(size_t size, size_t alignment) {
+    if (size == 0) size = 1;
+    if (alignment <= alignof(std::max_align_t)) return std::malloc(size);
+    void* ptr = nullptr;
+    return posix_memalign(&ptr, alignment, size) == 0 ? ptr : nullptr;
+}
+
+// 与标准 operator new 相同：失败时调用 new_handler 重试，没有 handler 时抛出 bad_alloc
+void* allocateOrThrow(size_t size, size_t alignment) {
+    for (;;) {
+        if (void* ptr = allocate(size, alignment)) {
+            recordAlloc(ptr);
+            return ptr;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* allocateOrNull(size_t size, size_t alignment) noexcept {
+    try {
+        return allocateOrThrow(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+constexpr size_t kDefaultAlignment = alignof(std::max_align_t);
+
+} // namespace
+
+AllocSnapshot AllocTracker::snapshot() {
+    AllocSnapshot result;
+    for (const Stripe& stripe : stripes) {
+        for (size_t i = 0; i < kAllocCategoryCount; ++i) {
+            result.byCategory[i].count += stripe.count[i].load(std::memory_order_relaxed);
+            result.byCategory[i].bytes += stripe.bytes[i].load(std::memory_order_relaxed);
+        }
+    }
+    for (const auto& counters : result.byCategory) {
+        result.total.count += counters.count;
+        result.total.bytes += counters.bytes;
+    }
+    result.live = liveBytes.load(std::memory_order_relaxed);
+    result.peak = peakBytes.load(std::memory_order_relaxed);
+    return result;
+}
+
+void AllocTracker::resetPeak() {
+    peakBytes.store(liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+AllocScope::AllocScope(AllocCategory category) : previous(currentCategory) {
+    currentCategory = category;
+}
+
+AllocScope::~AllocScope() {
+    currentCategory = previous;
+}
+
+AllocCategory AllocScope::current() {
+    return currentCategory;
+}
+
+// 替换全局 operator new / delete
+void* operator new(std::size_t size) { return allocateOrThrow(size, kDefaultAlignment); }
+void* operator new[](std::size_t size) { return allocateOrThrow(size, kDefaultAlignment); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocateOrNull(size, kDefaultAlignment); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocateOrNull(size, kDefaultAlignment); }
+void* operator new(std::size_t size, std::align_val_t align) { return allocateOrThrow(size, static_cast<size_t>(align)); }
+void* operator new[](std::size_t size, std::align_val_t align) { return allocateOrThrow(size, static_cast<size_t>(align)); }
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return allocateOrNull(size, static_cast<size_t>(align));
+}
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return allocateOrNull(size, static_cast<size_t>(align));
+}
+
+void operator delete(void* ptr) noexcept { release(ptr); }
+void operator delete[](void* ptr) noexcept { release(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { release(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { release(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { release(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { release(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { release(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { release(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { release(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { release(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { release(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { release(ptr); }
+
+#endif
@@ -1,7 +1,9 @@
 #include <status.h>
+#include <cerrno>
+#include <cstring>
 
-Status::Status(StatusCode c, std::string msg)
-    : code(c), message(std::move(msg))
+Status::Status(StatusCode c, const char* what, std::filesystem::path context, int sysError)
+    : code(c), what(what), sysError(sysError), context(std::move(context))
 {}
 
 bool Status::ok() const
@@ -9,12 +11,70 @@ bool Status::ok() const
     return code == StatusCode::Success;
 }
 
-Status Status::Success(std::string msg)
+namespace {
+
+std::string formatMessage(const char* what, std::string_view context, int sysError)
+{
+    std::string text = what ? what : "";
+    if (!context.empty()) {
+        if (!text.empty()) text += ": ";
+        text += context;
+    }
+    if (sysError != 0) {
+        if (text.empty()) {
+            text = std::strerror(sysError);
+        } else {
+            text += " (";
+            text += std::strerror(sysError);
+            text += ")";
+        }
+    }
+    return text;
+}
+
+} // namespace
+
+std::string Status::message() const
+{
+    return formatMessage(what, context.native(), sysError);
+}
+
+Status Status::Success(const char* msg)
+{
+    return Status(StatusCode::Success, msg);
+}
+
+Status Status::Error(StatusCode c, const char* what, std::filesystem::path context)
+{
+    return Status(c, what, std::move(context));
+}
+
+Status Status::SystemError(StatusCode c, const char* what, std::filesystem::path context, int err)
+{
+    return Status(c, what, std::move(context), err);
+}
+
+StatusCode Status::codeFromErrno(int err)
+{
+    switch (err) {
+        case ENOENT: return StatusCode::PathNotFound;
+        case ENOTDIR: return StatusCode::NotADirectory;
+        default: return StatusCode::PermissionDenied;
+    }
+}
+
+void EntryErrors::add(StatusCode code, const char* what, std::string_view path, int sysError)
+{
+    entries.push_back({code, what, sysError, paths.size(), path.size()});
+    paths.append(path);
+}
+
+std::string_view EntryErrors::path(size_t index) const
 {
-    return Status(StatusCode::Success, std::move(msg));
+    return std::string_view(paths).substr(entries[index].pathOffset, entries[index].pathLen);
 }
 
-Status Status::Error(StatusCode c, const std::string &msg)
+std::string EntryErrors::message(size_t index) const
 {
-    return Status(c, msg);
-}
\ No newline at end of file
+    return formatMessage(entries[index].what, path(index), entries[index].sysError);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "status.h"
+#include <functional>
+#include <string>
+
+// 服务模式的瘦客户端 (--connect)
+// 把命令行原样发给服务端，并把输出写到标准输出
+class Client {
+public:
+    // 回答服务端提出的确认问题
+    using AskHandler = std::function<std::string(const std::string& question)>;
+
+    Client() = default;
+    ~Client();
+
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    // 连接服务端
+    // [In] socketPath: 服务端的套接字文件
+    Status connect(const std::string& socketPath);
+
+    // 执行一条命令，输出写到标准输出，直到服务端报告命令结束
+    // [In] line: 命令行
+    // [In] ask: 需要确认时的回调
+    Status execute(const std::string& line, const AskHandler& ask);
+
+    // 会话当前目录 (每条命令结束后由服务端更新)
+    const std::string& currentPath() const { return path; }
+
+private:
+    int fd = -1;
+    std::string path;
+
+    Status waitDone(const AskHandler& ask);
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// 服务模式的通信协议
+// 客户端 -> 服务端：以 '\n' 结尾的命令行，或对确认问题的回答
+// 服务端 -> 客户端：帧 [类型 1 字节][内容长度 4 字节，小端][内容]
+enum class FrameType : char {
+    Output = 'O',   // 命令输出
+    Question = 'Q', // 需要用户回答 (y/n) 的问题
+    Done = 'D'      // 命令结束，内容为会话的当前目录
+};
+
+// 完整写出一帧
+// 对端已断开，或发送缓冲区满后超过 30 秒仍不可写时返回 false
+bool writeFrame(int fd, FrameType type, std::string_view payload);
+
+// 读取一帧
+// [Out] outType: 帧类型
+// [Out] outPayload: 帧内容
+// 连接关闭或出错时返回 false
+bool readFrame(int fd, FrameType& outType, std::string& outPayload);
+
+// 写出一行 (自动追加 '\n')
+// 对端已断开，或发送缓冲区满后超过 30 秒仍不可写时返回 false
+bool writeLine(int fd, std::string_view line);
+
+// 从连接中读取一行 (不含 '\n')，多读到的数据留在 buffer 中供下次使用
+// [In]  timeoutMs: 等待数据的最长时间 (毫秒)，-1 表示一直等待
+// 连接关闭、出错或超时返回 false
+bool readLine(int fd, std::string& buffer, std::string& outLine, int timeoutMs = -1);
+
+// 只从 buffer 中取出一行，不读取连接
+bool takeLine(std::string& buffer, std::string& outLine);
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "status.h"
+#include "WorkQueue.h"
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+class FileManager;
+
+// 多客户端服务 (--serve)
+// 在 Unix 域套接字上接受本机连接，每个连接对应一个会话：
+// 会话有独立的工作目录和命令解析器，所有会话共享同一组 FileManager 缓存
+// 命令由线程池执行，只读命令可并行，修改文件系统的命令独占执行
+class Server {
+public:
+    // [In] initPath: 新会话的初始目录，为空时使用进程的工作目录
+    explicit Server(const std::string& initPath = "");
+    ~Server();
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    // 监听 socketPath 并处理请求，直到收到 SIGINT / SIGTERM
+    // [In] socketPath: 套接字文件路径，已存在但无人监听时会被替换
+    Status run(const std::string& socketPath);
+
+private:
+    struct Session;
+
+    std::string initPath;
+    std::shared_ptr<FileManager> sharedFileManager; // 持有共享缓存
+    int epollFd = -1;
+
+    std::shared_mutex fsMutex;                      // 只读命令共享，修改命令独占
+    WorkQueue<Session*> jobs;                       // 有完整命令待执行的会话
+
+    std::mutex sessionsMutex;
+    std::unordered_map<int, std::unique_ptr<Session>> sessions;
+
+    void acceptClients(int listenFd);
+    void onReadable(Session* session);
+    void runSession(Session* session);
+    void execute(Session* session, const std::string& line);
+    void rearm(Session* session);
+    void closeSession(Session* session);
+};
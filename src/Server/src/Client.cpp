@@ -0,0 +1,63 @@
+#include "Client.h"
+#include "Protocol.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+Client::~Client() {
+    if (fd >= 0) close(fd);
+}
+
+Status Client::connect(const std::string& socketPath) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(addr.sun_path)) {
+        return Status::Error(StatusCode::InvalidArguments, "Invalid socket path", socketPath);
+    }
+    std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        return Status::SystemError(StatusCode::PathNotFound, "Cannot connect to server", socketPath, errno);
+    }
+
+    // 服务端在连接建立后发送会话的初始目录
+    return waitDone(nullptr);
+}
+
+Status Client::execute(const std::string& line, const AskHandler& ask) {
+    if (!writeLine(fd, line)) {
+        return Status::Error(StatusCode::UnknownError, "Connection to server lost");
+    }
+    return waitDone(ask);
+}
+
+Status Client::waitDone(const AskHandler& ask) {
+    FrameType type;
+    std::string payload;
+    while (readFrame(fd, type, payload)) {
+        switch (type) {
+            case FrameType::Output:
+                std::fwrite(payload.data(), 1, payload.size(), stdout);
+                std::fflush(stdout); // 服务端已按块发送，tail -f 的输出需要立即显示
+                break;
+            case FrameType::Question: {
+                std::fflush(stdout);
+                std::string answer = ask ? ask(payload) : "n";
+                if (!writeLine(fd, answer)) {
+                    return Status::Error(StatusCode::UnknownError, "Connection to server lost");
+                }
+                break;
+            }
+            case FrameType::Done:
+                path = std::move(payload);
+                std::fflush(stdout);
+                return Status::Success();
+        }
+    }
+    std::fflush(stdout);
+    return Status::Error(StatusCode::UnknownError, "Connection to server lost");
+}
@@ -0,0 +1,97 @@
+#include "Protocol.h"
+#include <cerrno>
+#include <cstdint>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kHeaderSize = 5;
+constexpr uint32_t kMaxFrameSize = 64u << 20;
+constexpr size_t kReadChunk = 4096;
+constexpr int kWriteTimeoutMs = 30 * 1000; // 对端长时间不读取时视为断开
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                pollfd pfd{fd, POLLOUT, 0};
+                int ready = poll(&pfd, 1, kWriteTimeoutMs);
+                if (ready < 0 && errno == EINTR) continue;
+                if (ready <= 0) {
+                    if (ready == 0) errno = ETIMEDOUT;
+                    return false;
+                }
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool readAll(int fd, char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = recv(fd, data, size, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+bool writeFrame(int fd, FrameType type, std::string_view payload) {
+    char header[kHeaderSize];
+    uint32_t len = static_cast<uint32_t>(payload.size());
+    header[0] = static_cast<char>(type);
+    for (int i = 0; i < 4; ++i) header[1 + i] = static_cast<char>((len >> (8 * i)) & 0xff);
+    return writeAll(fd, header, sizeof(header)) && writeAll(fd, payload.data(), payload.size());
+}
+
+bool writeLine(int fd, std::string_view line) {
+    return writeAll(fd, line.data(), line.size()) && writeAll(fd, "\n", 1);
+}
+
+bool readFrame(int fd, FrameType& outType, std::string& outPayload) {
+    char header[kHeaderSize];
+    if (!readAll(fd, header, sizeof(header))) return false;
+    uint32_t len = 0;
+    for (int i = 0; i < 4; ++i) len |= static_cast<uint32_t>(static_cast<unsigned char>(header[1 + i])) << (8 * i);
+    if (len > kMaxFrameSize) return false;
+    outType = static_cast<FrameType>(header[0]);
+    outPayload.resize(len);
+    return readAll(fd, outPayload.data(), len);
+}
+
+bool takeLine(std::string& buffer, std::string& outLine) {
+    size_t newline = buffer.find('\n');
+    if (newline == std::string::npos) return false;
+    size_t end = (newline > 0 && buffer[newline - 1] == '\r') ? newline - 1 : newline;
+    outLine.assign(buffer, 0, end);
+    buffer.erase(0, newline + 1);
+    return true;
+}
+
+bool readLine(int fd, std::string& buffer, std::string& outLine, int timeoutMs) {
+    while (!takeLine(buffer, outLine)) {
+        pollfd pfd{fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, timeoutMs);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready <= 0) return false;
+
+        char chunk[kReadChunk];
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) continue;
+        if (n <= 0) return false;
+        buffer.append(chunk, static_cast<size_t>(n));
+    }
+    return true;
+}
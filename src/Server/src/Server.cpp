@@ -0,0 +1,313 @@
+#include "Server.h"
+#include "Protocol.h"
+#include "Controller.h"
+#include "FileManager.h"
+#include "Parallel.h"
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kOutputBufferSize = 64 * 1024;
+constexpr int kConfirmTimeoutMs = 60 * 1000; // 客户端迟迟不回答确认时按 "否" 处理
+constexpr int kMaxEvents = 64;
+constexpr size_t kReadChunk = 4096;
+
+// 不修改文件系统的命令，可与其他只读命令并行执行
+bool isReadOnlyCommand(const std::string& line) {
+    std::istringstream in(line);
+    std::string command;
+    std::string sub;
+    in >> command >> sub;
+    if (command == "snapshot") return sub == "diff";
+    if (command == "cache") return true; // 只影响页缓存，不修改文件
+    return command == "cd" || command == "ls" || command == "stat" || command == "search" ||
+           command == "du" || command == "dupes" || command == "analyze" || command == "top" || command == "grep" ||
+           command == "wc" || command == "cmp" || command == "head" || command == "tail" || command == "view" ||
+           command == "memstats" || command == "help";
+}
+
+// 不需要等待其他会话的命令结束的命令
+// throttle 需要能在其他会话的大量复制进行中调整限制；tail -f 可能持续很久，不能一直阻塞修改命令
+bool isControlCommand(const std::string& line) {
+    std::istringstream in(line);
+    std::string command;
+    in >> command;
+    if (command == "tail") {
+        std::string arg;
+        while (in >> arg) {
+            if (arg == "--follow" || (arg.size() > 1 && arg[0] == '-' && arg[1] != '-' && arg.find('f') != std::string::npos)) {
+                return true;
+            }
+        }
+    }
+    return command == "throttle";
+}
+
+} // namespace
+
+// 一个客户端连接
+struct Server::Session {
+    int fd = -1;
+    std::string inBuffer;            // 已收到但尚未执行的输入
+    std::FILE* out = nullptr;        // 写入时按帧发送给客户端
+    std::unique_ptr<Controller> controller;
+    std::unique_lock<std::shared_mutex> fsLock; // 执行修改命令期间持有，等待确认时暂时释放
+
+    ~Session() {
+        controller.reset();
+        if (out) std::fclose(out);
+        if (fd >= 0) close(fd);
+    }
+
+    // fopencookie 的写回调，每次刷新缓冲区发送一个输出帧
+    static ssize_t writeOutput(void* cookie, const char* data, size_t size) {
+        auto* session = static_cast<Session*>(cookie);
+        if (!writeFrame(session->fd, FrameType::Output, std::string_view(data, size))) {
+            // 断开连接，后续输出立即失败，不再逐次等待超时
+            shutdown(session->fd, SHUT_RDWR);
+            errno = EPIPE;
+            return -1;
+        }
+        return static_cast<ssize_t>(size);
+    }
+
+    bool sendDone() {
+        Path current;
+        controller->fileManager->getCurrentPath(current);
+        return writeFrame(fd, FrameType::Done, current.string());
+    }
+};
+
+Server::Server(const std::string& initPath) : initPath(initPath) {}
+
+Server::~Server() = default;
+
+Status Server::run(const std::string& socketPath) {
+    try {
+        sharedFileManager = std::make_shared<FileManager>(initPath);
+    } catch (const std::runtime_error&) {
+        return Status::Error(StatusCode::PathNotFound, "Directory not found", initPath);
+    }
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(addr.sun_path)) {
+        return Status::Error(StatusCode::InvalidArguments, "Invalid socket path", socketPath);
+    }
+    std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    int listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (listenFd < 0) {
+        return Status::SystemError(StatusCode::UnknownError, "Cannot create socket", socketPath, errno);
+    }
+
+    // 套接字文件已存在：有服务在监听则拒绝启动，否则视为上次遗留并替换
+    struct stat st;
+    if (lstat(socketPath.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool alive = probe >= 0 && connect(probe, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+        if (probe >= 0) close(probe);
+        if (alive) {
+            close(listenFd);
+            return Status::Error(StatusCode::PathAlreadyExists, "Server already running", socketPath);
+        }
+        unlink(socketPath.c_str());
+    }
+
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        int err = errno;
+        close(listenFd);
+        return Status::SystemError(StatusCode::PermissionDenied, "Cannot bind", socketPath, err);
+    }
+    chmod(socketPath.c_str(), 0600); // 仅允许同一用户连接
+    listen(listenFd, SOMAXCONN);
+
+    // 信号在创建线程前屏蔽，由主循环通过 signalfd 处理
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+    int signalFd = signalfd(-1, &mask, SFD_CLOEXEC);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+    ev.data.ptr = &signalFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, signalFd, &ev);
+
+    std::vector<std::thread> workers;
+    unsigned threads = defaultThreadCount();
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([this]() {
+            while (auto session = jobs.pop()) runSession(*session);
+        });
+    }
+
+    bool running = true;
+    epoll_event events[kMaxEvents];
+    while (running) {
+        int n = epoll_wait(epollFd, events, kMaxEvents, -1);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) break;
+        for (int i = 0; i < n; ++i) {
+            void* tag = events[i].data.ptr;
+            if (tag == nullptr) {
+                acceptClients(listenFd);
+            } else if (tag == &signalFd) {
+                // 读走信号，否则退出时解除屏蔽会再次投递
+                signalfd_siginfo info;
+                if (read(signalFd, &info, sizeof(info)) == sizeof(info)) running = false;
+            } else {
+                onReadable(static_cast<Session*>(tag));
+            }
+        }
+    }
+
+    // 关闭所有连接，让等待客户端确认的命令立即返回
+    close(listenFd);
+    unlink(socketPath.c_str());
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        for (auto& [fd, session] : sessions) shutdown(fd, SHUT_RDWR);
+    }
+    jobs.close();
+    for (auto& worker : workers) worker.join();
+    sessions.clear();
+    close(epollFd);
+    close(signalFd);
+    pthread_sigmask(SIG_UNBLOCK, &mask, nullptr);
+    return Status::Success();
+}
+
+void Server::acceptClients(int listenFd) {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+
+        auto session = std::make_unique<Session>();
+        session->fd = fd;
+        cookie_io_functions_t io{};
+        io.write = &Session::writeOutput;
+        session->out = fopencookie(session.get(), "w", io);
+        if (!session->out) continue; // 析构时关闭 fd
+        std::setvbuf(session->out, nullptr, _IOFBF, kOutputBufferSize);
+
+        // 每个会话有自己的工作目录，缓存与其他会话共享
+        auto fileManager = std::make_shared<FileManager>(initPath, *sharedFileManager);
+        Session* raw = session.get();
+        fileManager->confirm = [raw](const std::string& question) {
+            std::fflush(raw->out);
+            // 等待客户端回答期间不占用文件系统锁，避免一个会话拖住其他所有会话
+            // 回答后重新加锁，命令继续执行时各项操作自行处理期间发生的变化
+            bool locked = raw->fsLock.owns_lock();
+            if (locked) raw->fsLock.unlock();
+            std::string answer;
+            bool answered = writeFrame(raw->fd, FrameType::Question, question) &&
+                            readLine(raw->fd, raw->inBuffer, answer, kConfirmTimeoutMs);
+            if (locked) raw->fsLock.lock();
+            return answered && !answer.empty() && (answer[0] == 'y' || answer[0] == 'Y');
+        };
+        fileManager->cancelFd = fd; // 客户端断开时结束 tail -f
+        session->controller = std::make_unique<Controller>(fileManager, session->out);
+
+        // 连接建立后先发送一次 Done，告知客户端初始目录
+        if (!session->sendDone()) continue;
+        {
+            std::lock_guard<std::mutex> lock(sessionsMutex);
+            sessions.emplace(fd, std::move(session));
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+        ev.data.ptr = raw;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+// 主线程：读取到完整命令后交给线程池
+// EPOLLONESHOT 保证同一会话同一时刻只由一个线程处理
+void Server::onReadable(Session* session) {
+    char chunk[kReadChunk];
+    while (true) {
+        ssize_t n = recv(session->fd, chunk, sizeof(chunk), 0);
+        if (n > 0) {
+            session->inBuffer.append(chunk, static_cast<size_t>(n));
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        closeSession(session); // 对端关闭或出错
+        return;
+    }
+
+    if (session->inBuffer.find('\n') != std::string::npos) {
+        jobs.push(session);
+    } else {
+        rearm(session);
+    }
+}
+
+void Server::runSession(Session* session) {
+    std::string line;
+    while (takeLine(session->inBuffer, line)) {
+        if (line == "exit") {
+            closeSession(session);
+            return;
+        }
+        execute(session, line);
+        if (!session->sendDone()) {
+            closeSession(session);
+            return;
+        }
+    }
+    rearm(session);
+}
+
+void Server::execute(Session* session, const std::string& line) {
+    if (line.empty()) return;
+    if (isControlCommand(line)) {
+        session->controller->parse(line);
+    } else if (isReadOnlyCommand(line)) {
+        std::shared_lock<std::shared_mutex> lock(fsMutex);
+        session->controller->parse(line);
+    } else {
+        session->fsLock = std::unique_lock<std::shared_mutex>(fsMutex);
+        session->controller->parse(line);
+        session->fsLock.unlock();
+    }
+}
+
+void Server::rearm(Session* session) {
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    ev.data.ptr = session;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, session->fd, &ev);
+}
+
+void Server::closeSession(Session* session) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, session->fd, nullptr);
+    std::unique_ptr<Session> owned;
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        auto it = sessions.find(session->fd);
+        if (it == sessions.end()) return;
+        owned = std::move(it->second);
+        sessions.erase(it);
+    }
+}
@@ -1,20 +1,59 @@
+#include <chrono>
 #include <iostream>
 #include <string>
 #include <vector>
+#include <functional>
+#include <memory>
 
 #include "replxx.hxx"
 #include <fmt/core.h>
 #include <fmt/color.h>
 #include "Controller.h"
+#include "NameIndex.h"
+#include "Server.h"
+#include "Client.h"
+
+// Rows of live results shown below the isearch prompt (the first row is the match count)
+constexpr int kIsearchRows = 12;
+constexpr int kDefaultHintRows = 4;
+
+std::string indexedPath(const NameIndex& index, uint32_t id) {
+    std::string path(index.path(id));
+    if (index.entry(id).type == FileType::Directory) path += '/';
+    return path;
+}
 
 int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+
+    // Server mode: serve sessions over a unix socket, no interactive shell
+    if (mode == "--serve") {
+        if (argc < 3) {
+            fmt::print(fg(fmt::color::red), "Usage: {} --serve <socket> [dir]\n", argv[0]);
+            return 1;
+        }
+        Server server(argc > 3 ? argv[3] : "");
+        fmt::print(fg(fmt::color::green), "Serving on {} (Ctrl-C to stop)\n", argv[2]);
+        Status status = server.run(argv[2]);
+        if (!status.ok()) {
+            fmt::print(fg(fmt::color::red), "{}\n", status.message());
+            return 1;
+        }
+        return 0;
+    }
+
     replxx::Replxx rx;
     rx.install_window_change_handler();
 
     // auto-completion keywords
-    std::vector<std::string> keywords = {"cd", "ls", "cp", "mv", "touch", "mkdir", "rm", "rmdir", "stat", "search", "du", "exit"};
+    std::vector<std::string> keywords = {"cd", "ls", "cp", "mv", "touch", "mkdir", "rm", "rmdir", "rename", "undo", "trash", "stat", "search", "isearch", "du", "dupes", "analyze", "top", "grep", "wc", "cmp", "head", "tail", "view", "snapshot", "cache", "sync", "pack", "unpack", "throttle", "memstats", "exit"};
+    // Incremental search (isearch): set while the isearch prompt is active
+    std::unique_ptr<NameIndex> nameIndex;
+    std::unique_ptr<IncrementalSearch> isearch;
+
     rx.set_completion_callback([&](std::string const& context, int& contextLen) {
         replxx::Replxx::completions_t completions;
+        if (isearch) return completions;
         std::string prefix = context.substr(context.find_last_of(" \t") + 1);
         contextLen = prefix.length();
         for (auto const& kw : keywords) {
@@ -23,26 +62,83 @@ int main(int argc, char* argv[]) {
         return completions;
     });
 
+    // While isearch is active, every edit narrows the previous matches and the hint rows show the result
+    // replxx only lists hints below the input line when there are at least two of them
+    rx.set_hint_callback([&](std::string const& context, int& contextLen, replxx::Replxx::Color& color) {
+        replxx::Replxx::hints_t hints;
+        if (!isearch) return hints;
+        const std::vector<uint32_t>& ids = isearch->update(context);
+        contextLen = 0;
+        color = replxx::Replxx::Color::GRAY;
+        hints.push_back(fmt::format("-- {} of {} names --", ids.size(), nameIndex->size()));
+        for (size_t i = 0; i < ids.size() && hints.size() < static_cast<size_t>(kIsearchRows); ++i) {
+            hints.push_back(indexedPath(*nameIndex, ids[i]));
+        }
+        if (hints.size() == 1) hints.emplace_back();
+        return hints;
+    });
+
     int line_count = 1;
     fmt::print(fg(fmt::color::yellow) | fmt::emphasis::bold, "Mini File Explorer Demo\n");
     fmt::print(fg(fmt::color::green) | fmt::emphasis::bold, "Created by LifeCheckpoint, LightningHonor.\n");
 
-    std::string initPath = "";
-    if (argc > 1) {
-        initPath = argv[1];
-    }
-
+    // Commands run either on a local controller or on a server session (--connect)
     std::unique_ptr<Controller> controller;
-    try {
-        controller = std::make_unique<Controller>(initPath);
-    } catch (const std::runtime_error& e) {
-        fmt::print(fg(fmt::color::red), "{}\n", e.what());
-        return 1;
+    std::unique_ptr<Client> client;
+    std::function<Path()> currentDirectory;
+    std::function<bool(const std::string&)> execute;
+
+    if (mode == "--connect") {
+        if (argc < 3) {
+            fmt::print(fg(fmt::color::red), "Usage: {} --connect <socket>\n", argv[0]);
+            return 1;
+        }
+        client = std::make_unique<Client>();
+        Status status = client->connect(argv[2]);
+        if (!status.ok()) {
+            fmt::print(fg(fmt::color::red), "{}\n", status.message());
+            return 1;
+        }
+        currentDirectory = [&]() { return Path(client->currentPath()); };
+        execute = [&](const std::string& line) {
+            Status result = client->execute(line, [](const std::string& question) {
+                fmt::print("{} (y/n) ", question);
+                std::fflush(stdout);
+                std::string answer;
+                std::getline(std::cin, answer);
+                return answer;
+            });
+            if (!result.ok()) {
+                fmt::print(fg(fmt::color::red), "{}\n", result.message());
+                return false;
+            }
+            return true;
+        };
+    } else {
+        std::string initPath = "";
+        if (argc > 1) {
+            initPath = argv[1];
+        }
+
+        try {
+            controller = std::make_unique<Controller>(initPath);
+        } catch (const std::runtime_error& e) {
+            fmt::print(fg(fmt::color::red), "{}\n", e.what());
+            return 1;
+        }
+        currentDirectory = [&]() {
+            Path path;
+            controller->fileManager->getCurrentPath(path);
+            return path;
+        };
+        execute = [&](const std::string& line) {
+            controller->parse(line);
+            return true;
+        };
     }
 
     while (true) {
-        Path cur_path;
-        controller->fileManager->getCurrentPath(cur_path);
+        Path cur_path = currentDirectory();
         fmt::print("Current Directory: {}\n", cur_path.string());
 
         std::string prompt = fmt::format("\033[1;34m[{}]\033[0m {}> ", line_count, cur_path.filename().string()); // Blue
@@ -62,8 +158,45 @@ int main(int argc, char* argv[]) {
             break;
         }
         
+        // Incremental search: index the tree once, then filter on every key press
+        if (val == "isearch" || val.rfind("isearch ", 0) == 0) {
+            if (!controller) {
+                fmt::print(fg(fmt::color::red), "isearch is only available in local mode\n");
+                continue;
+            }
+            std::string dir = val.substr(std::min(val.size(), sizeof("isearch")));
+            dir.erase(0, dir.find_first_not_of(" \t"));
+            dir.erase(dir.find_last_not_of(" \t") + 1);
+
+            auto start = std::chrono::steady_clock::now();
+            auto index = std::make_unique<NameIndex>();
+            Status status = controller->fileManager->buildNameIndex(dir, WalkOptions(), *index);
+            if (!status.ok()) {
+                fmt::print(fg(fmt::color::red), "{}\n", status.message());
+                continue;
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            fmt::print(fg(fmt::color::green), "Indexed {} names under {} in {:.2f}s\n",
+                       index->size(), index->rootPath().string(), seconds);
+            fmt::print("Type to filter, Enter to list all matches, empty line or Ctrl-D to leave\n");
+
+            nameIndex = std::move(index);
+            isearch = std::make_unique<IncrementalSearch>(*nameIndex);
+            rx.set_max_hint_rows(kIsearchRows);
+            while (const char* keyword = rx.input("\033[1;33misearch>\033[0m ")) {
+                if (*keyword == '\0') break;
+                const std::vector<uint32_t>& ids = isearch->update(keyword);
+                for (uint32_t id : ids) fmt::print("{}\n", indexedPath(*nameIndex, id));
+                fmt::print(fg(fmt::color::green), "{} matches\n", ids.size());
+            }
+            rx.set_max_hint_rows(kDefaultHintRows);
+            isearch.reset();
+            nameIndex.reset();
+            continue;
+        }
+
         // Parse commands
-        controller->parse(val);
+        if (!execute(val)) break;
     }
 
     return 0;
@@ -0,0 +1,118 @@
+#include "FileManager.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// unpack 不能写到目标目录之外：".." 路径、经符号链接或硬链接逃逸、残缺的头部
+
+namespace fs = std::filesystem;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::printf("%s: %s\n", condition ? "ok  " : "FAIL", what);
+    if (!condition) ++failures;
+}
+
+// 追加一个 ustar 头部及其数据
+void addMember(std::string& tar, const std::string& name, char typeflag,
+               const std::string& linkName = "", const std::string& data = "") {
+    char header[512] = {};
+    std::snprintf(header, 100, "%s", name.c_str());
+    std::snprintf(header + 100, 8, "%07o", 0644);
+    std::snprintf(header + 108, 8, "%07o", 0);
+    std::snprintf(header + 116, 8, "%07o", 0);
+    std::snprintf(header + 124, 12, "%011o", static_cast<unsigned>(data.size()));
+    std::snprintf(header + 136, 12, "%011o", 0);
+    header[156] = typeflag;
+    std::snprintf(header + 157, 100, "%s", linkName.c_str());
+    std::memcpy(header + 257, "ustar", 6);
+    std::memcpy(header + 263, "00", 2);
+    std::memset(header + 148, ' ', 8);
+    unsigned sum = 0;
+    for (unsigned char c : header) sum += c;
+    std::snprintf(header + 148, 8, "%06o", sum);
+    tar.append(header, sizeof(header));
+    tar.append(data);
+    tar.append((512 - data.size() % 512) % 512, '\0');
+}
+
+void writeFile(const fs::path& path, const std::string& content) {
+    std::ofstream(path, std::ios::binary) << content;
+}
+
+} // namespace
+
+int main() {
+    char templ[] = "/tmp/mfe_archive_XXXXXX";
+    if (!mkdtemp(templ)) return 1;
+    const fs::path root = templ;
+    const fs::path dest = root / "dest";
+    const fs::path outside = root / "outside";
+    fs::create_directories(dest);
+    fs::create_directories(outside);
+    writeFile(outside / "secret", "secret");
+    FileManager fm(root.string());
+
+    // 1. ".." 路径
+    {
+        std::string tar;
+        addMember(tar, "../escape.txt", '0', "", "escaped");
+        addMember(tar, "ok.txt", '0', "", "inside");
+        tar.append(1024, '\0');
+        writeFile(root / "dotdot.tar", tar);
+        ArchiveReport report;
+        Status status = fm.unpackArchive(root / "dotdot.tar", dest, report);
+        check(status.ok(), "unpack with a '..' member succeeds");
+        check(!fs::exists(root / "escape.txt"), "'..' member is not written outside the destination");
+        check(fs::exists(dest / "ok.txt"), "other members are still extracted");
+        check(report.errors.size() == 1, "'..' member is reported as skipped");
+    }
+
+    // 2. 先解出指向外部的符号链接，再经过它写文件或建立硬链接
+    {
+        std::string tar;
+        addMember(tar, "d", '2', outside.string());
+        addMember(tar, "d/planted", '0', "", "planted");
+        addMember(tar, "h", '1', "d/secret");
+        tar.append(1024, '\0');
+        writeFile(root / "link.tar", tar);
+        ArchiveReport report;
+        fm.unpackArchive(root / "link.tar", dest, report);
+        check(!fs::exists(outside / "planted"), "file is not written through an extracted symlink");
+        check(fs::hard_link_count(outside / "secret") == 1, "hard link is not resolved through a symlink");
+    }
+
+    // 3. 目标目录中已有指向外部的符号链接
+    {
+        fs::create_directory_symlink(outside, dest / "pre");
+        std::string tar;
+        addMember(tar, "pre/f", '0', "", "planted");
+        tar.append(1024, '\0');
+        writeFile(root / "pre.tar", tar);
+        ArchiveReport report;
+        fm.unpackArchive(root / "pre.tar", dest, report);
+        check(!fs::exists(outside / "f"), "file is not written through a pre-existing symlink");
+    }
+
+    // 4. 头部不完整
+    {
+        std::string tar;
+        addMember(tar, "a.txt", '0', "", "data");
+        addMember(tar, "b.txt", '0', "", "data");
+        tar.resize(512 + 512 + 200);
+        writeFile(root / "truncated.tar", tar);
+        ArchiveReport report;
+        Status status = fm.unpackArchive(root / "truncated.tar", root / "dest2", report);
+        check(!status.ok(), "truncated header is rejected");
+        check(!fs::exists(root / "dest2" / "a.txt"), "nothing is extracted from a truncated archive");
+    }
+
+    fs::remove_all(root);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+#include "NameMatcher.h"
+#include <cstdio>
+#include <regex>
+#include <string>
+#include <vector>
+
+// glob / 正则编译成 DFA 后的匹配结果：固定用例，以及与 std::regex 的对照
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::printf("FAIL: %s\n", what.c_str());
+        ++failures;
+    }
+}
+
+struct Case {
+    MatchMode mode;
+    const char* pattern;
+    const char* name;
+    bool expected;
+};
+
+} // namespace
+
+int main() {
+    const std::vector<Case> cases = {
+        {MatchMode::Glob, "*.log", "app.log", true},
+        {MatchMode::Glob, "*.log", "app.log.1", false},
+        {MatchMode::Glob, "*.log", ".log", true},
+        {MatchMode::Glob, "a?c", "abc", true},
+        {MatchMode::Glob, "a?c", "ac", false},
+        {MatchMode::Glob, "[!a]*", "abc", false},
+        {MatchMode::Glob, "[!a]*", "bcd", true},
+        {MatchMode::Glob, "file[0-9].txt", "file7.txt", true},
+        {MatchMode::Glob, "file[0-9].txt", "fileX.txt", false},
+        {MatchMode::Glob, "\\*", "*", true},
+        {MatchMode::Glob, "\\*", "a", false},
+        {MatchMode::Glob, "a**b", "ab", true},
+        {MatchMode::Regex, "core\\.[0-9]+", "core.123", true},
+        {MatchMode::Regex, "core\\.[0-9]+", "core.", false},
+        {MatchMode::Regex, "core\\.[0-9]+", "xcore.1y", true},
+        {MatchMode::Regex, "^core\\.[0-9]+$", "xcore.1", false},
+        {MatchMode::Regex, "^(foo|bar)baz$", "barbaz", true},
+        {MatchMode::Regex, "^(foo|bar)baz$", "foobazz", false},
+        {MatchMode::Regex, "colou?r", "color", true},
+        {MatchMode::Regex, "\\d\\d", "a1b2", false},
+        {MatchMode::Regex, "\\d\\d", "a12", true},
+        {MatchMode::Regex, "a$", "ba", true},
+        {MatchMode::Regex, "a\\$", "a$", true},
+        {MatchMode::Substring, "LOG", "app.log", true},
+        {MatchMode::Substring, "txt", "app.log", false},
+    };
+    for (const Case& c : cases) {
+        NameMatcher matcher;
+        Status status = NameMatcher::compile(c.mode, c.pattern, matcher);
+        check(status.ok(), std::string("compile ") + c.pattern);
+        if (status.ok()) {
+            check(matcher.matches(c.name) == c.expected, std::string(c.pattern) + " on " + c.name);
+        }
+    }
+
+    // 无效模式必须报错，不能构造出匹配器
+    for (const char* pattern : {"(ab", "ab)", "[ab", "*a"}) {
+        NameMatcher matcher;
+        check(!NameMatcher::compile(MatchMode::Regex, pattern, matcher).ok(), std::string("reject ") + pattern);
+    }
+    {
+        NameMatcher matcher;
+        check(!NameMatcher::compile(MatchMode::Glob, "", matcher).ok(), "reject empty glob");
+    }
+
+    // 与 std::regex 的部分匹配语义对照
+    const std::vector<std::string> patterns = {
+        "ab*c", "^a(b|c)*d$", "[a-c]+x", "x?y?z", "(ab|a)(bc|c)$", "^[^.]+\\.(log|txt)$", "a.c", "(a|b)*abb",
+    };
+    const std::vector<std::string> names = {
+        "a", "ac", "abc", "abbbc", "abd", "acbd", "ad", "bcx", "aax", "z", "xz", "abc.log", "a.b.log",
+        "readme.txt", "abbabb", "aabb", "aXc", "abcabc", "ab", "bc",
+    };
+    for (const auto& pattern : patterns) {
+        NameMatcher matcher;
+        if (!NameMatcher::compile(MatchMode::Regex, pattern, matcher).ok()) {
+            check(false, "compile " + pattern);
+            continue;
+        }
+        const std::regex reference(pattern);
+        for (const auto& name : names) {
+            check(matcher.matches(name) == std::regex_search(name, reference), pattern + " on " + name);
+        }
+    }
+
+    std::printf("%s\n", failures == 0 ? "all name matcher checks passed" : "name matcher checks failed");
+    return failures == 0 ? 0 : 1;
+}
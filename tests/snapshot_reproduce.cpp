@@ -0,0 +1,85 @@
+#include "Snapshot.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+// 快照加载器必须拒绝长度字段被篡改的文件，不能越界读取
+
+namespace fs = std::filesystem;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    std::printf("%s: %s\n", condition ? "ok  " : "FAIL", what);
+    if (!condition) ++failures;
+}
+
+std::string readAll(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+// 改写头部的一个 64 位字段后重新加载
+bool loadPatched(const std::string& good, const fs::path& path, size_t fieldOffset, uint64_t value) {
+    std::string data = good;
+    std::memcpy(data.data() + fieldOffset, &value, sizeof(value));
+    std::ofstream(path, std::ios::binary) << data;
+    SnapshotReader reader;
+    return reader.open(path.string()).ok();
+}
+
+} // namespace
+
+int main() {
+    char templ[] = "/tmp/mfe_snapshot_XXXXXX";
+    if (!mkdtemp(templ)) return 1;
+    const fs::path root = templ;
+    fs::create_directories(root / "tree" / "sub");
+    std::ofstream(root / "tree" / "sub" / "file") << "data";
+
+    const fs::path good = root / "good.snap";
+    check(writeSnapshot(root / "tree", good.string()).has_value(), "snapshot is written");
+    {
+        SnapshotReader reader;
+        check(reader.open(good.string()).ok() && reader.size() == 2, "valid snapshot loads with both entries");
+    }
+
+    const std::string data = readAll(good);
+    const fs::path bad = root / "bad.snap";
+    check(!loadPatched(data, bad, offsetof(SnapshotHeader, rootLen), UINT64_MAX - 3), "wrapping rootLen is rejected");
+    check(!loadPatched(data, bad, offsetof(SnapshotHeader, rootLen), uint64_t(1) << 30), "rootLen past the end is rejected");
+    check(!loadPatched(data, bad, offsetof(SnapshotHeader, entryCount), UINT64_MAX / sizeof(SnapshotRecord) + 2),
+          "wrapping entryCount is rejected");
+    check(!loadPatched(data, bad, offsetof(SnapshotHeader, stringBytes), UINT64_MAX), "wrapping stringBytes is rejected");
+
+    // 记录中的路径偏移越界
+    {
+        std::string patched = data;
+        SnapshotHeader header;
+        std::memcpy(&header, patched.data(), sizeof(header));
+        size_t recordsOffset = (sizeof(SnapshotHeader) + header.rootLen + 7) & ~size_t(7);
+        uint64_t offset = UINT64_MAX - 1;
+        std::memcpy(patched.data() + recordsOffset + offsetof(SnapshotRecord, pathOffset), &offset, sizeof(offset));
+        std::ofstream(bad, std::ios::binary) << patched;
+        SnapshotReader reader;
+        check(!reader.open(bad.string()).ok(), "wrapping record pathOffset is rejected");
+    }
+
+    // 文件被截断
+    {
+        std::ofstream(bad, std::ios::binary) << data.substr(0, data.size() - 3);
+        SnapshotReader reader;
+        check(!reader.open(bad.string()).ok(), "truncated snapshot is rejected");
+    }
+
+    fs::remove_all(root);
+    return failures == 0 ? 0 : 1;
+}